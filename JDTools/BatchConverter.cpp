@@ -0,0 +1,466 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "BatchConverter.hpp"
+#include "BatchFileIO.hpp"
+#include "BoundedQueue.hpp"
+#include "Codecs.hpp"
+#include "ConversionContext.hpp"
+#include "ConversionPlan.hpp"
+#include "JDTools.hpp"
+#include "PatchLibrary.hpp"
+#include "Utils.hpp"
+
+#include "JD-800.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	using PatchBank = std::vector<PatchVST>;
+
+	constexpr uint32_t BATCH_BANK_SIZE = 64;
+	// Number of files that are read or written with a single request to the file I/O backend
+	constexpr size_t BATCH_IO_SIZE = 32;
+
+	// One input file on its way through the pipeline
+	struct BatchJob
+	{
+		BatchFile *file = nullptr;
+		std::vector<LibraryPatch> patches;
+		std::vector<std::vector<PatchBank>> banks;  // Indexed by target format, then by bank
+		std::string warnings;
+		bool readFailed = false;
+	};
+
+	// Time that the threads of a pipeline stage spent working rather than waiting for their queues
+	struct StageStats
+	{
+		size_t numThreads = 1;
+		std::atomic<int64_t> busyTime = 0;  // In microseconds
+
+		void AddBusyTime(const Clock::time_point start)
+		{
+			busyTime += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+		}
+	};
+
+	// Converts all internal patches of a file into banks of VST patches. Empty slots are filled with the default patch.
+	class BatchJobConverter
+	{
+	public:
+		BatchJobConverter(std::span<const FileCodec *const> codecs)
+			: m_context{m_warnings}
+		{
+			// Like the convert verb, VST patches are fixed up once for all targets, and only fixed up again (silently) for targets that need fewer fixups
+			for (const FileCodec *codec : codecs)
+			{
+				const VSTFixups &fixups = m_fixups.emplace_back(VSTFixups{codec->type != InputFile::Type::SVZplugin, codec->type != InputFile::Type::SVZhardware});
+				m_allFixups.checkModel |= fixups.checkModel;
+				m_allFixups.fixMFX |= fixups.fixMFX;
+			}
+			ConvertPatch800ToVST(GetDefaultPatch800(), m_defaultPatch, m_context);
+		}
+
+		void Convert(BatchJob &job)
+		{
+			uint32_t numPatches = 0;
+			for (const LibraryPatch &patch : job.patches)
+			{
+				if (patch.format == PatchFormat::VST)
+					numPatches = std::max(numPatches, patch.slot + 1);
+				else if (patch.slot < LIBRARY_SLOT_CARD)
+					numPatches = BATCH_BANK_SIZE;
+			}
+			std::vector<PatchBank> banks((numPatches + BATCH_BANK_SIZE - 1) / BATCH_BANK_SIZE, PatchBank(BATCH_BANK_SIZE, m_defaultPatch));
+
+			bool hasVSTPatches = false;
+			for (const LibraryPatch &patch : job.patches)
+			{
+				if (patch.format != PatchFormat::VST && patch.slot >= LIBRARY_SLOT_CARD)
+					continue;
+				PatchVST &pVST = banks[patch.slot / BATCH_BANK_SIZE][patch.slot % BATCH_BANK_SIZE];
+				GetPlan(patch.format).Convert(patch.data.data(), &pVST, m_context);
+				if (patch.format == PatchFormat::VST)
+				{
+					FixVSTPatch(pVST, m_allFixups.checkModel, m_allFixups.fixMFX, GetPatchIndex(patch.slot, numPatches), true, m_context);
+					hasVSTPatches = true;
+				}
+			}
+
+			job.banks.assign(m_fixups.size(), {});
+			for (size_t target = 0; target < m_fixups.size(); target++)
+			{
+				if (!hasVSTPatches || m_fixups[target] == m_allFixups)
+				{
+					job.banks[target] = (target + 1 < m_fixups.size()) ? banks : std::move(banks);
+					continue;
+				}
+				job.banks[target] = banks;
+				for (const LibraryPatch &patch : job.patches)
+				{
+					if (patch.format != PatchFormat::VST)
+						continue;
+					PatchVST &pVST = job.banks[target][patch.slot / BATCH_BANK_SIZE][patch.slot % BATCH_BANK_SIZE];
+					pVST = patch.As<PatchVST>();
+					FixVSTPatch(pVST, m_fixups[target].checkModel, m_fixups[target].fixMFX, {}, false, m_context);
+				}
+			}
+			job.patches = {};
+
+			job.warnings = m_warnings.str();
+			m_warnings.str({});
+		}
+
+		ToneCacheStats GetToneCacheStats() const { return m_context.GetToneCacheStats(); }
+
+	private:
+		struct VSTFixups
+		{
+			bool checkModel = false, fixMFX = false;
+			bool operator==(const VSTFixups &) const = default;
+		};
+
+		ConversionPlan &GetPlan(const PatchFormat format)
+		{
+			auto &plan = m_plans[static_cast<size_t>(format)];
+			if (!plan)
+				plan = std::make_unique<ConversionPlan>(format, PatchFormat::VST);
+			return *plan;
+		}
+
+		std::ostringstream m_warnings;
+		ConversionContext m_context;
+		std::array<std::unique_ptr<ConversionPlan>, 3> m_plans;
+		PatchVST m_defaultPatch;
+		std::vector<VSTFixups> m_fixups;  // Indexed by target format
+		VSTFixups m_allFixups;
+	};
+
+	void PrintStageStats(const std::string_view name, const StageStats &stage, const double elapsedSeconds)
+	{
+		const double busySeconds = static_cast<double>(stage.busyTime) / 1e6;
+		const double utilization = elapsedSeconds > 0.0 ? busySeconds * 100.0 / (elapsedSeconds * static_cast<double>(stage.numThreads)) : 0.0;
+		std::cout << name << ": " << stage.numThreads << (stage.numThreads == 1 ? " thread, " : " threads, ") << std::fixed << std::setprecision(0) << utilization << "% busy" << std::endl;
+	}
+
+	void PrintQueueStats(const std::string_view name, const BoundedQueueStats &stats, const size_t capacity)
+	{
+		std::cout << name << ": " << std::fixed << std::setprecision(1) << stats.GetAverageDepth() << " average / " << stats.maxDepth << " maximum depth of " << capacity
+			<< ", full " << stats.numFullWaits << " times" << std::endl;
+	}
+}
+
+std::vector<BatchFile> FindBatchFiles(const std::vector<std::string> &inputs, const std::filesystem::path &outputDirectory)
+{
+	std::vector<BatchFile> files;
+	std::error_code ec;
+	for (const std::string &input : inputs)
+	{
+		const std::filesystem::path inputPath{input};
+		if (!std::filesystem::is_directory(inputPath, ec))
+		{
+			const std::u8string filename = inputPath.filename().u8string();
+			files.push_back({inputPath, std::string{filename.begin(), filename.end()}});
+			continue;
+		}
+
+		const size_t firstFile = files.size();
+		for (std::filesystem::recursive_directory_iterator it{inputPath, std::filesystem::directory_options::skip_permission_denied, ec}, end; it != end; it.increment(ec))
+		{
+			if (ec)
+				continue;
+			// Don't pick up the results of a previous run if the output directory is inside the input directory
+			if (it->is_directory(ec) && std::filesystem::equivalent(it->path(), outputDirectory, ec))
+			{
+				it.disable_recursion_pending();
+				continue;
+			}
+			if (!it->is_regular_file(ec) || !IsLibraryFile(it->path()))
+				continue;
+
+			const std::u8string relativePath = std::filesystem::relative(it->path(), inputPath, ec).generic_u8string();
+			files.push_back({it->path(), std::string{relativePath.begin(), relativePath.end()}});
+		}
+		std::sort(files.begin() + firstFile, files.end(), [](const BatchFile &l, const BatchFile &r) { return l.relativePath < r.relativePath; });
+	}
+
+	// Files that only differ in their extension (e.g. Bank.syx and Bank.mid) keep their original extension in the output filename
+	std::set<std::filesystem::path> outputBases;
+	for (BatchFile &file : files)
+	{
+		file.outputBase = outputDirectory / std::filesystem::path{std::u8string{file.relativePath.begin(), file.relativePath.end()}};
+		if (outputBases.insert(std::filesystem::path{file.outputBase}.replace_extension()).second)
+			file.outputBase.replace_extension();
+		else
+			outputBases.insert(file.outputBase);
+	}
+	return files;
+}
+
+std::filesystem::path GetBatchOutputPath(const BatchFile &file, const FileCodec &codec, const size_t bank, const size_t numBanks)
+{
+	std::filesystem::path path = file.outputBase;
+	if (numBanks > 1)
+	{
+		path += ".";
+		path += std::to_string(bank + 1);
+	}
+	path += ".";
+	path += codec.id;
+	return path.lexically_normal();
+}
+
+size_t ConvertBatch(std::span<BatchFile> files, std::span<const FileCodec *const> codecs, const bool printStats, std::set<std::filesystem::path> claimedOutputs)
+{
+	if (files.empty())
+		return 0;
+
+	// Reader -> read queue -> converters -> write queue -> writer.
+	// The queues are short, so that memory usage stays bounded no matter how many files are converted.
+	const size_t numConverters = std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), files.size());
+	BoundedQueue<BatchJob> readQueue{numConverters * 2}, writeQueue{numConverters * 2};
+	StageStats readerStats, converterStats, writerStats;
+	converterStats.numThreads = numConverters;
+	BatchFileIO readerIO, writerIO;
+	const auto startTime = Clock::now();
+
+	std::thread reader{[&]()
+	{
+		std::vector<FileReadRequest> requests;
+		for (size_t first = 0; first < files.size(); first += BATCH_IO_SIZE)
+		{
+			auto start = Clock::now();
+			requests.assign(std::min(BATCH_IO_SIZE, files.size() - first), {});
+			for (size_t i = 0; i < requests.size(); i++)
+			{
+				requests[i].path = files[first + i].path;
+			}
+			readerIO.Read(requests);
+			readerStats.AddBusyTime(start);
+
+			for (size_t i = 0; i < requests.size(); i++)
+			{
+				start = Clock::now();
+				BatchJob job;
+				job.file = &files[first + i];
+				job.readFailed = !requests[i].success;
+				if (requests[i].success)
+				{
+					job.file->contentHash = HashFNV1a(requests[i].data.data(), requests[i].data.size());
+					std::istringstream inFile{std::move(requests[i].data)};
+					job.patches = LoadLibraryFile(inFile, std::cerr);
+				}
+				readerStats.AddBusyTime(start);
+				readQueue.Push(std::move(job));
+			}
+		}
+		readQueue.Close();
+	}};
+
+	std::mutex toneCacheMutex;
+	ToneCacheStats toneCacheStats;
+	std::vector<std::thread> converters;
+	for (size_t i = 0; i < numConverters; i++)
+	{
+		converters.emplace_back([&]()
+		{
+			// Every converter keeps its context and plans for all files it converts
+			BatchJobConverter converter{codecs};
+			while (auto job = readQueue.Pop())
+			{
+				const auto start = Clock::now();
+				converter.Convert(*job);
+				converterStats.AddBusyTime(start);
+				writeQueue.Push(std::move(*job));
+			}
+			const ToneCacheStats stats = converter.GetToneCacheStats();
+			const std::lock_guard lock{toneCacheMutex};
+			toneCacheStats.hits += stats.hits;
+			toneCacheStats.misses += stats.misses;
+		});
+	}
+
+	// Files are written in the order in which they have been converted.
+	// Whatever has been converted in the meantime is written together, so that the file I/O backend can submit all of it at once.
+	size_t numConvertedFiles = 0, numFailedFiles = 0, numPatches = 0;
+	std::thread writer{[&]()
+	{
+		std::set<std::filesystem::path> createdDirectories;
+		std::vector<BatchJob> jobs;
+		std::vector<FileWriteRequest> requests;
+		std::vector<std::filesystem::path> jobOutputs, conflicts;  // For each job, the first output file that is already claimed by another file
+		while (auto firstJob = writeQueue.Pop())
+		{
+			jobs.clear();
+			jobs.push_back(std::move(*firstJob));
+			while (jobs.size() < BATCH_IO_SIZE)
+			{
+				auto job = writeQueue.TryPop();
+				if (!job)
+					break;
+				jobs.push_back(std::move(*job));
+			}
+
+			const auto start = Clock::now();
+			requests.clear();
+			conflicts.assign(jobs.size(), {});
+			for (size_t i = 0; i < jobs.size(); i++)
+			{
+				const BatchJob &job = jobs[i];
+				const BatchFile &file = *job.file;
+				jobOutputs.clear();
+				for (size_t target = 0; target < codecs.size(); target++)
+				{
+					const size_t numBanks = job.banks[target].size();
+					for (size_t bank = 0; bank < numBanks; bank++)
+						jobOutputs.push_back(GetBatchOutputPath(file, *codecs[target], bank, numBanks));
+				}
+				if (const auto conflict = std::find_if(jobOutputs.begin(), jobOutputs.end(), [&](const std::filesystem::path &path) { return claimedOutputs.count(path) != 0; }); conflict != jobOutputs.end())
+				{
+					conflicts[i] = *conflict;
+					continue;
+				}
+				claimedOutputs.insert(jobOutputs.begin(), jobOutputs.end());
+
+				if (!job.banks.front().empty() && createdDirectories.insert(file.outputBase.parent_path()).second)
+				{
+					std::error_code ec;
+					std::filesystem::create_directories(file.outputBase.parent_path(), ec);
+				}
+				for (size_t target = 0; target < codecs.size(); target++)
+				{
+					const std::vector<PatchBank> &banks = job.banks[target];
+					for (size_t bank = 0; bank < banks.size(); bank++)
+					{
+						FileWriteRequest &request = requests.emplace_back();
+						request.path = GetBatchOutputPath(file, *codecs[target], bank, banks.size());
+						std::ostringstream outFile;
+						codecs[target]->writeBank(outFile, banks[bank]);
+						request.data = std::move(outFile).str();
+					}
+				}
+			}
+			writerIO.Write(requests);
+
+			auto request = requests.begin();
+			for (size_t i = 0; i < jobs.size(); i++)
+			{
+				const BatchJob &job = jobs[i];
+				BatchFile &file = *job.file;
+				const size_t numBanks = job.banks.front().size();
+				if (numBanks == 0)
+				{
+					if (job.readFailed)
+						std::cout << "Could not read " << file.relativePath << "!" << std::endl;
+					else
+						std::cout << "No patches found in " << file.relativePath << "!" << std::endl;
+					file.noPatches = !job.readFailed;
+					numFailedFiles++;
+					continue;
+				}
+				if (!conflicts[i].empty())
+				{
+					std::cout << "Not writing " << file.relativePath << ", its output file " << conflicts[i].string() << " belongs to another file!" << std::endl;
+					numFailedFiles++;
+					continue;
+				}
+
+				file.converted = true;
+				for (size_t output = 0; output < numBanks * codecs.size(); output++, request++)
+				{
+					if (request->success)
+					{
+						file.outputs.push_back(request->path);
+					}
+					else
+					{
+						std::cout << "Could not write " << request->path.string() << "!" << std::endl;
+						file.converted = false;
+					}
+				}
+				if (file.converted)
+				{
+					std::cout << "Converted " << file.relativePath << " (" << numBanks * BATCH_BANK_SIZE << " patches)" << std::endl;
+					numConvertedFiles++;
+					numPatches += numBanks * BATCH_BANK_SIZE;
+				}
+				else
+				{
+					numFailedFiles++;
+				}
+				std::cerr << job.warnings;
+			}
+			writerStats.AddBusyTime(start);
+		}
+	}};
+
+	reader.join();
+	for (std::thread &converter : converters)
+	{
+		converter.join();
+	}
+	writeQueue.Close();
+	writer.join();
+
+	const double elapsedSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+	std::cout << "Converted " << numConvertedFiles << " files to ";
+	for (size_t target = 0; target < codecs.size(); target++)
+	{
+		std::cout << (target ? ", " : "") << codecs[target]->name;
+	}
+	std::cout << " format in " << std::fixed << std::setprecision(2) << elapsedSeconds << " seconds";
+	if (numFailedFiles)
+		std::cout << ", " << numFailedFiles << " files could not be converted";
+	std::cout << "." << std::endl;
+
+	if (printStats)
+	{
+		std::cout << "Patches: " << numPatches << " (" << std::setprecision(0) << (elapsedSeconds > 0.0 ? static_cast<double>(numPatches) / elapsedSeconds : 0.0) << " per second)" << std::endl;
+		std::cout << "File I/O: " << writerIO.GetBackendName() << std::endl;
+		PrintStageStats("Reader", readerStats, elapsedSeconds);
+		PrintQueueStats("Read queue", readQueue.GetStats(), readQueue.GetCapacity());
+		PrintStageStats("Converters", converterStats, elapsedSeconds);
+		PrintQueueStats("Write queue", writeQueue.GetStats(), writeQueue.GetCapacity());
+		PrintStageStats("Writer", writerStats, elapsedSeconds);
+		std::cout << "Tone cache: " << toneCacheStats.hits << " hits, " << toneCacheStats.misses << " misses";
+		if (toneCacheStats.hits + toneCacheStats.misses)
+			std::cout << " (" << (toneCacheStats.hits * 100 / (toneCacheStats.hits + toneCacheStats.misses)) << "% hit rate)";
+		std::cout << std::endl;
+	}
+
+	return numFailedFiles;
+}
+
+int RunBatch(std::span<const FileCodec *const> codecs, const std::filesystem::path &outputDirectory, const std::vector<std::string> &inputs, const bool printStats)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(outputDirectory, ec);
+	if (!std::filesystem::is_directory(outputDirectory, ec))
+	{
+		std::cout << "Could not create output directory " << outputDirectory.string() << "!" << std::endl;
+		return 2;
+	}
+
+	std::vector<BatchFile> files = FindBatchFiles(inputs, outputDirectory);
+	if (files.empty())
+	{
+		std::cout << "No patch files found!" << std::endl;
+		return 2;
+	}
+
+	return ConvertBatch(files, codecs, printStats, {}) ? 2 : 0;
+}
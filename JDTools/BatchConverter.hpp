@@ -0,0 +1,46 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+struct FileCodec;
+
+// A file that is converted by the batch pipeline
+struct BatchFile
+{
+	std::filesystem::path path;
+	std::string relativePath;  // Used in messages
+	// Each output filename consists of this, the bank number if there is more than one bank, and the target format's extension
+	std::filesystem::path outputBase;
+
+	// Results of the conversion
+	uint64_t contentHash = 0;  // Of the input file as it was read
+	std::vector<std::filesystem::path> outputs;  // All files that were written
+	bool converted = false;
+	bool noPatches = false;  // The file could be read, but it does not contain any patches that could be converted
+};
+
+// Collects all patch files from the given files and directories (including their subdirectories) and determines where their output is written.
+// The output directory itself is skipped, so that the results of a previous run are not picked up as input files.
+// Output filenames depend on the other files in the same directory: Files that only differ in their extension keep their extension in the output filename.
+std::vector<BatchFile> FindBatchFiles(const std::vector<std::string> &inputs, const std::filesystem::path &outputDirectory);
+
+// Path of the output file for one bank of a file
+std::filesystem::path GetBatchOutputPath(const BatchFile &file, const FileCodec &codec, const size_t bank, const size_t numBanks);
+
+// Converts every file into one bank per target format (or several banks if it contains more than 64 patches).
+// Reading, converting and writing run as separate pipeline stages, so that disk and CPU are kept busy at the same time.
+// A file is not written if any of its output files would overwrite one of the claimedOutputs or the output of another file (e.g. Bank.syx with two banks and Bank.1.syx).
+// Returns the number of files that could not be converted.
+size_t ConvertBatch(std::span<BatchFile> files, std::span<const FileCodec *const> codecs, const bool printStats, std::set<std::filesystem::path> claimedOutputs);
+
+// Converts each input file into its own bank in the output directory. Returns the process exit code.
+int RunBatch(std::span<const FileCodec *const> codecs, const std::filesystem::path &outputDirectory, const std::vector<std::string> &inputs, const bool printStats);
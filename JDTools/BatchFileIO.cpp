@@ -0,0 +1,388 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "BatchFileIO.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifdef JDTOOLS_IO_URING
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Blocking file operations mostly wait for the disk, so there can be more threads than CPU cores
+	size_t GetNumIOThreads(const size_t numRequests)
+	{
+		return std::min(std::max(size_t(8), size_t(std::thread::hardware_concurrency())), numRequests);
+	}
+
+	template<typename TRequest, typename TFunc>
+	void RunOnThreadPool(std::span<TRequest> requests, const TFunc &func)
+	{
+		std::atomic<size_t> nextRequest = 0;
+		const auto processRequests = [&]()
+		{
+			for (size_t i = nextRequest++; i < requests.size(); i = nextRequest++)
+			{
+				func(requests[i]);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < GetNumIOThreads(requests.size()); i++)
+		{
+			threads.emplace_back(processRequests);
+		}
+		processRequests();
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ReadWholeFile(FileReadRequest &request)
+	{
+		std::ifstream inFile{request.path, std::ios::binary | std::ios::ate};
+		const std::streamoff size = inFile ? std::streamoff{inFile.tellg()} : std::streamoff{-1};
+		if (size < 0)
+			return;
+		request.data.resize(static_cast<size_t>(size));
+		inFile.seekg(0);
+		request.success = static_cast<bool>(inFile.read(request.data.data(), size));
+	}
+
+	void WriteWholeFile(FileWriteRequest &request)
+	{
+		std::ofstream outFile{request.path, std::ios::trunc | std::ios::binary};
+		outFile.write(request.data.data(), static_cast<std::streamsize>(request.data.size()));
+		outFile.close();
+		request.success = static_cast<bool>(outFile);
+	}
+}
+
+#ifdef JDTOOLS_IO_URING
+
+// Minimal io_uring wrapper using the raw system calls, so that no additional library is needed.
+// All operations needed for reading and writing whole files (open, statx, read, write, close) are available since Linux 5.6.
+struct BatchFileIO::Ring
+{
+	static constexpr unsigned NUM_ENTRIES = 64;
+
+	int fd = -1;
+	unsigned numEntries = 0;
+	void *sqRing = MAP_FAILED, *cqRing = MAP_FAILED;
+	size_t sqRingSize = 0, cqRingSize = 0;
+	io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+	size_t sqesSize = 0;
+	unsigned *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+	unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+	io_uring_cqe *cqes = nullptr;
+	bool failed = false;  // The ring is in an unknown state and must not be used anymore
+
+	~Ring()
+	{
+		if (sqes != MAP_FAILED)
+			munmap(sqes, sqesSize);
+		if (cqRing != MAP_FAILED && cqRing != sqRing)
+			munmap(cqRing, cqRingSize);
+		if (sqRing != MAP_FAILED)
+			munmap(sqRing, sqRingSize);
+		if (fd >= 0)
+			close(fd);
+	}
+
+	// Returns false if io_uring is not available or does not support all required operations
+	bool Init()
+	{
+		io_uring_params params{};
+		fd = static_cast<int>(syscall(__NR_io_uring_setup, NUM_ENTRIES, &params));
+		if (fd < 0)
+			return false;
+
+		numEntries = params.sq_entries;
+		sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMapping)
+			sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+		sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (sqRing == MAP_FAILED)
+			return false;
+		cqRing = singleMapping ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED)
+			return false;
+		sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+		if (sqes == MAP_FAILED)
+			return false;
+
+		const auto sqField = [this](const uint32_t offset) { return reinterpret_cast<unsigned *>(static_cast<char *>(sqRing) + offset); };
+		const auto cqField = [this](const uint32_t offset) { return reinterpret_cast<unsigned *>(static_cast<char *>(cqRing) + offset); };
+		sqTail = sqField(params.sq_off.tail);
+		sqMask = sqField(params.sq_off.ring_mask);
+		sqArray = sqField(params.sq_off.array);
+		cqHead = cqField(params.cq_off.head);
+		cqTail = cqField(params.cq_off.tail);
+		cqMask = cqField(params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(cqRing) + params.cq_off.cqes);
+
+		constexpr unsigned MAX_PROBE_OPS = 256;
+		std::vector<uint8_t> probeBuffer(sizeof(io_uring_probe) + MAX_PROBE_OPS * sizeof(io_uring_probe_op));
+		auto &probe = *reinterpret_cast<io_uring_probe *>(probeBuffer.data());
+		if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, &probe, MAX_PROBE_OPS) < 0)
+			return false;
+		for (const uint8_t op : { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE })
+		{
+			if (op >= probe.ops_len || !(probe.ops[op].flags & IO_URING_OP_SUPPORTED))
+				return false;
+		}
+		return true;
+	}
+
+	// Submits one operation per index, and waits until all of them have completed.
+	// Returns the result of each operation, which is a negative error code if it failed, or -ECANCELED if it was never submitted.
+	// If the ring fails, no further operations are submitted, but the ones that the kernel has already accepted are still waited for,
+	// as they may write into the caller's buffers or open files that need to be closed.
+	template<typename TPrepare>
+	std::vector<int> Run(const size_t count, const TPrepare &prepare)
+	{
+		std::vector<int> results(count, -ECANCELED);
+		for (size_t first = 0; first < count && !failed; first += numEntries)
+		{
+			const unsigned num = static_cast<unsigned>(std::min(size_t(numEntries), count - first));
+			const unsigned tail = *sqTail;
+			for (unsigned i = 0; i < num; i++)
+			{
+				const unsigned index = (tail + i) & *sqMask;
+				io_uring_sqe &sqe = sqes[index];
+				std::memset(&sqe, 0, sizeof(sqe));
+				prepare(sqe, first + i);
+				sqe.user_data = first + i;
+				sqArray[index] = index;
+			}
+			std::atomic_ref<unsigned>{*sqTail}.store(tail + num, std::memory_order_release);
+
+			unsigned submitted = 0, completed = 0;
+			while (completed < (failed ? submitted : num))
+			{
+				const unsigned toSubmit = failed ? 0 : (num - submitted);
+				const long ret = syscall(__NR_io_uring_enter, fd, toSubmit, (failed ? submitted : num) - completed, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					// Completions are still posted to the completion queue even if the ring cannot be entered anymore
+					if (failed)
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					failed = true;
+				}
+				if (ret > 0)
+					submitted += static_cast<unsigned>(ret);
+
+				unsigned head = *cqHead;
+				const unsigned cqTailNow = std::atomic_ref<unsigned>{*cqTail}.load(std::memory_order_acquire);
+				for (; head != cqTailNow; head++, completed++)
+				{
+					const io_uring_cqe &cqe = cqes[head & *cqMask];
+					results[cqe.user_data] = cqe.res;
+				}
+				std::atomic_ref<unsigned>{*cqHead}.store(head, std::memory_order_release);
+			}
+		}
+		return results;
+	}
+
+	// Returns the file descriptors of all opened files, or a negative error code for files that could not be opened
+	template<typename TRequest>
+	std::vector<int> Open(std::span<TRequest> requests, const int flags, std::vector<std::string> &paths)
+	{
+		paths.clear();
+		for (const auto &request : requests)
+		{
+			paths.push_back(request.path.string());
+		}
+		return Run(requests.size(), [&](io_uring_sqe &sqe, const size_t i)
+		{
+			sqe.opcode = IORING_OP_OPENAT;
+			sqe.fd = AT_FDCWD;
+			sqe.addr = reinterpret_cast<uint64_t>(paths[i].c_str());
+			sqe.len = 0666;
+			sqe.open_flags = static_cast<uint32_t>(flags | O_CLOEXEC);
+		});
+	}
+
+	// Closing a file that has been written to can fail if the data could not be stored after all.
+	// Files that could not be closed through the ring because it failed are closed directly.
+	std::vector<int> Close(const std::vector<int> &fds)
+	{
+		std::vector<int> results = Run(fds.size(), [&](io_uring_sqe &sqe, const size_t i)
+		{
+			sqe.opcode = (fds[i] >= 0) ? IORING_OP_CLOSE : IORING_OP_NOP;
+			sqe.fd = fds[i];
+		});
+		for (size_t i = 0; i < fds.size() && failed; i++)
+		{
+			if (fds[i] >= 0 && results[i] == -ECANCELED)
+				results[i] = (close(fds[i]) == 0) ? 0 : -errno;
+		}
+		return results;
+	}
+
+	void Read(std::span<FileReadRequest> requests)
+	{
+		std::vector<std::string> paths;
+		const std::vector<int> fds = Open(requests, O_RDONLY, paths);
+
+		std::vector<struct statx> stats(requests.size());
+		const std::vector<int> statResults = Run(requests.size(), [&](io_uring_sqe &sqe, const size_t i)
+		{
+			sqe.opcode = (fds[i] >= 0) ? IORING_OP_STATX : IORING_OP_NOP;
+			sqe.fd = fds[i];
+			sqe.addr = reinterpret_cast<uint64_t>("");
+			sqe.len = STATX_SIZE;
+			sqe.addr2 = reinterpret_cast<uint64_t>(&stats[i]);
+			sqe.statx_flags = AT_EMPTY_PATH;
+		});
+		const auto canRead = [&](const size_t i) { return fds[i] >= 0 && statResults[i] >= 0 && stats[i].stx_size < (1u << 30); };
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (canRead(i))
+				requests[i].data.resize(static_cast<size_t>(stats[i].stx_size));
+		}
+
+		const std::vector<int> readResults = Run(requests.size(), [&](io_uring_sqe &sqe, const size_t i)
+		{
+			// Empty files are read successfully without reading anything, like with the fallback reader
+			sqe.opcode = (canRead(i) && !requests[i].data.empty()) ? IORING_OP_READ : IORING_OP_NOP;
+			sqe.fd = fds[i];
+			sqe.addr = reinterpret_cast<uint64_t>(requests[i].data.data());
+			sqe.len = static_cast<uint32_t>(requests[i].data.size());
+		});
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (!canRead(i) || readResults[i] < 0)
+				continue;
+			// Short reads are unlikely for regular files, but possible
+			size_t offset = static_cast<size_t>(readResults[i]);
+			while (offset < requests[i].data.size())
+			{
+				const ssize_t bytesRead = pread(fds[i], requests[i].data.data() + offset, requests[i].data.size() - offset, static_cast<off_t>(offset));
+				if (bytesRead <= 0)
+					break;
+				offset += static_cast<size_t>(bytesRead);
+			}
+			requests[i].success = (offset == requests[i].data.size());
+		}
+
+		Close(fds);
+	}
+
+	void Write(std::span<FileWriteRequest> requests)
+	{
+		std::vector<std::string> paths;
+		const std::vector<int> fds = Open(requests, O_WRONLY | O_CREAT | O_TRUNC, paths);
+
+		const std::vector<int> writeResults = Run(requests.size(), [&](io_uring_sqe &sqe, const size_t i)
+		{
+			sqe.opcode = (fds[i] >= 0 && !requests[i].data.empty()) ? IORING_OP_WRITE : IORING_OP_NOP;
+			sqe.fd = fds[i];
+			sqe.addr = reinterpret_cast<uint64_t>(requests[i].data.data());
+			sqe.len = static_cast<uint32_t>(requests[i].data.size());
+		});
+		std::vector<bool> written(requests.size());
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (fds[i] < 0 || writeResults[i] < 0)
+				continue;
+			size_t offset = static_cast<size_t>(writeResults[i]);
+			while (offset < requests[i].data.size())
+			{
+				const ssize_t bytesWritten = pwrite(fds[i], requests[i].data.data() + offset, requests[i].data.size() - offset, static_cast<off_t>(offset));
+				if (bytesWritten <= 0)
+					break;
+				offset += static_cast<size_t>(bytesWritten);
+			}
+			written[i] = (offset == requests[i].data.size());
+		}
+
+		const std::vector<int> closeResults = Close(fds);
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			requests[i].success = written[i] && closeResults[i] >= 0;
+		}
+	}
+};
+
+BatchFileIO::BatchFileIO()
+{
+	m_ring = std::make_unique<Ring>();
+	if (!m_ring->Init())
+		m_ring.reset();
+}
+
+#else
+
+struct BatchFileIO::Ring
+{
+	static constexpr bool failed = true;
+	void Read(std::span<FileReadRequest>) {}
+	void Write(std::span<FileWriteRequest>) {}
+};
+
+BatchFileIO::BatchFileIO() = default;
+
+#endif
+
+BatchFileIO::~BatchFileIO() = default;
+
+std::string_view BatchFileIO::GetBackendName() const
+{
+	return m_ring ? "io_uring" : "thread pool";
+}
+
+// If the ring stops working in the middle of a batch, the failed requests are retried on the thread pool, which is then used from now on
+void BatchFileIO::Read(std::span<FileReadRequest> requests)
+{
+	if (m_ring)
+	{
+		m_ring->Read(requests);
+		if (!m_ring->failed)
+			return;
+		m_ring.reset();
+	}
+	RunOnThreadPool(requests, [](FileReadRequest &request)
+	{
+		if (!request.success)
+			ReadWholeFile(request);
+	});
+}
+
+void BatchFileIO::Write(std::span<FileWriteRequest> requests)
+{
+	if (m_ring)
+	{
+		m_ring->Write(requests);
+		if (!m_ring->failed)
+			return;
+		m_ring.reset();
+	}
+	RunOnThreadPool(requests, [](FileWriteRequest &request)
+	{
+		if (!request.success)
+			WriteWholeFile(request);
+	});
+}
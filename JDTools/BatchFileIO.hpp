@@ -0,0 +1,49 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+struct FileReadRequest
+{
+	std::filesystem::path path;
+	std::string data;  // Complete file contents after reading
+	bool success = false;
+};
+
+struct FileWriteRequest
+{
+	std::filesystem::path path;
+	std::string data;  // Complete file contents to write
+	bool success = false;
+};
+
+// Reads or writes many small files at once.
+// On Linux, the opening, reading or writing and closing of all files in a batch is submitted to the kernel through io_uring,
+// so a batch only takes a handful of system calls instead of several per file. Where io_uring is not available (other systems,
+// older kernels, or sandboxes that forbid it), the files are read and written by several threads instead.
+// An object must only be used by one thread at a time.
+class BatchFileIO
+{
+public:
+	BatchFileIO();
+	~BatchFileIO();
+
+	BatchFileIO(const BatchFileIO &) = delete;
+	BatchFileIO &operator=(const BatchFileIO &) = delete;
+
+	std::string_view GetBackendName() const;
+
+	void Read(std::span<FileReadRequest> requests);
+	void Write(std::span<FileWriteRequest> requests);
+
+private:
+	struct Ring;
+	std::unique_ptr<Ring> m_ring;
+};
@@ -0,0 +1,108 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+struct BoundedQueueStats
+{
+	uint64_t numItems = 0;
+	uint64_t depthSum = 0;  // Sum of the queue depth right after each item was added
+	uint64_t numFullWaits = 0;  // How often a producer had to wait because the queue was full
+	size_t maxDepth = 0;
+
+	double GetAverageDepth() const { return numItems ? static_cast<double>(depthSum) / static_cast<double>(numItems) : 0.0; }
+};
+
+// Connects two stages of a pipeline. Producers are blocked while the queue is full, so that a fast stage cannot run
+// arbitrarily far ahead of a slow one, and consumers are blocked while it is empty until the queue is closed.
+template<typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(const size_t capacity)
+		: m_capacity{std::max(capacity, size_t(1))}
+	{
+	}
+
+	size_t GetCapacity() const { return m_capacity; }
+
+	// Returns false if the queue has been closed in the meantime, in which case the item is discarded
+	bool Push(T &&item)
+	{
+		std::unique_lock lock{m_mutex};
+		if (m_items.size() >= m_capacity && !m_closed)
+		{
+			m_stats.numFullWaits++;
+			m_notFull.wait(lock, [this] { return m_items.size() < m_capacity || m_closed; });
+		}
+		if (m_closed)
+			return false;
+		m_items.push_back(std::move(item));
+		m_stats.numItems++;
+		m_stats.depthSum += m_items.size();
+		m_stats.maxDepth = std::max(m_stats.maxDepth, m_items.size());
+		lock.unlock();
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	// Returns std::nullopt once the queue has been closed and all remaining items have been taken
+	std::optional<T> Pop()
+	{
+		std::unique_lock lock{m_mutex};
+		m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_closed; });
+		if (m_items.empty())
+			return std::nullopt;
+		std::optional<T> item{std::move(m_items.front())};
+		m_items.pop_front();
+		lock.unlock();
+		m_notFull.notify_one();
+		return item;
+	}
+
+	// Returns std::nullopt if the queue is currently empty
+	std::optional<T> TryPop()
+	{
+		std::unique_lock lock{m_mutex};
+		if (m_items.empty())
+			return std::nullopt;
+		std::optional<T> item{std::move(m_items.front())};
+		m_items.pop_front();
+		lock.unlock();
+		m_notFull.notify_one();
+		return item;
+	}
+
+	// No more items will be added. Items that are already in the queue can still be taken.
+	void Close()
+	{
+		{
+			const std::lock_guard lock{m_mutex};
+			m_closed = true;
+		}
+		m_notEmpty.notify_all();
+		m_notFull.notify_all();
+	}
+
+	BoundedQueueStats GetStats() const
+	{
+		const std::lock_guard lock{m_mutex};
+		return m_stats;
+	}
+
+private:
+	const size_t m_capacity;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_notFull, m_notEmpty;
+	std::deque<T> m_items;
+	BoundedQueueStats m_stats;
+	bool m_closed = false;
+};
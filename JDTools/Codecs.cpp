@@ -0,0 +1,55 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "Codecs.hpp"
+#include "SVZ.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace
+{
+	constexpr FileCodec Codecs[] =
+	{
+		{ InputFile::Type::SYX, "syx", {}, true, nullptr, nullptr },
+		{ InputFile::Type::MID, "mid", {}, true, nullptr, nullptr },
+		{ InputFile::Type::SVZplugin, "bin", "JD-800 VST", false, ReadSVZ, WriteSVZforPlugin },
+		{ InputFile::Type::SVZhardware, "svz", "ZC1", false, ReadSVZ, WriteSVZforHardware },
+		{ InputFile::Type::SVD, "svd", "JD-08", false, ReadSVD, nullptr },
+	};
+}
+
+const FileCodec *FindFileCodec(const std::string_view id)
+{
+	const auto codec = std::find_if(std::begin(Codecs), std::end(Codecs), [id](const FileCodec &c)
+	{
+		return std::equal(id.begin(), id.end(), c.id.begin(), c.id.end(), [](const char l, const char r) { return std::tolower(static_cast<unsigned char>(l)) == r; });
+	});
+	return (codec != std::end(Codecs)) ? codec : nullptr;
+}
+
+std::vector<const FileCodec *> FindFileCodecs(const std::string_view ids)
+{
+	std::vector<const FileCodec *> codecs;
+	for (size_t start = 0; start <= ids.size(); )
+	{
+		const size_t end = std::min(ids.find(',', start), ids.size());
+		const FileCodec *codec = FindFileCodec(ids.substr(start, end - start));
+		start = end + 1;
+
+		if (!codec || std::find(codecs.begin(), codecs.end(), codec) != codecs.end())
+			return {};
+		codecs.push_back(codec);
+	}
+	return codecs;
+}
+
+const FileCodec &GetFileCodec(const InputFile::Type type)
+{
+	const auto codec = std::find_if(std::begin(Codecs), std::end(Codecs), [type](const FileCodec &c) { return c.type == type; });
+	if (codec == std::end(Codecs))
+		throw std::invalid_argument("Unknown file type");
+	return *codec;
+}
@@ -0,0 +1,138 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionPlan.hpp"
+#include "InputFile.hpp"
+#include "JDTools.hpp"
+#include "SysExAddresses.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// A patch file format that can be read and written by the convert verb
+struct FileCodec
+{
+	InputFile::Type type;
+	std::string_view id;    // As specified on the command line, also used as file extension
+	std::string_view name;  // Empty for SysEx files, which are named after the target device instead
+	bool isSysEx;           // SysEx files are parsed message by message into a memory image
+
+	// Patch bank readers and writers of VST patch files. SVD files can only be written into an existing JD-08 backup, so they have no writer.
+	std::vector<PatchVST> (*readBank)(std::istream &inFile, std::ostream &warnings);
+	void (*writeBank)(std::ostream &outFile, const std::vector<PatchVST> &patches);
+};
+
+// Returns nullptr if the id does not belong to any file format (case-insensitive)
+const FileCodec *FindFileCodec(const std::string_view id);
+const FileCodec &GetFileCodec(const InputFile::Type type);
+// Parses a comma-separated list of ids, e.g. "bin,svz,syx". Returns an empty list if any id is unknown or appears more than once.
+std::vector<const FileCodec *> FindFileCodecs(const std::string_view ids);
+
+
+// Compile-time description of each patch format, so that the per-patch loops of the conversion can be instantiated
+// for a specific source and target format instead of checking the format for every single patch.
+template<typename TPatch>
+struct PatchCodec;
+
+template<>
+struct PatchCodec<Patch800>
+{
+	using Patch = Patch800;
+	static constexpr PatchFormat format = PatchFormat::JD800;
+	static constexpr bool isJD990 = false;
+	static constexpr uint32_t temporaryAddress = BASE_ADDR_800_PATCH_TEMPORARY;
+
+	static constexpr uint32_t GetInternalAddress(const uint32_t patch) { return BASE_ADDR_800_PATCH_INTERNAL + ((patch * 0x03) << 7); }
+	static const std::array<char, 16> &GetName(const Patch800 &patch) { return patch.common.name; }
+};
+
+template<>
+struct PatchCodec<Patch990>
+{
+	using Patch = Patch990;
+	static constexpr PatchFormat format = PatchFormat::JD990;
+	static constexpr bool isJD990 = true;
+	static constexpr uint32_t temporaryAddress = BASE_ADDR_990_PATCH_TEMPORARY;
+
+	static constexpr uint32_t GetInternalAddress(const uint32_t patch) { return BASE_ADDR_990_PATCH_INTERNAL + (patch << 14); }
+	static const std::array<char, 16> &GetName(const Patch990 &patch) { return patch.common.name; }
+};
+
+template<>
+struct PatchCodec<PatchVST>
+{
+	using Patch = PatchVST;
+	static constexpr PatchFormat format = PatchFormat::VST;
+
+	static const std::array<char, 16> &GetName(const PatchVST &patch) { return patch.name; }
+};
+
+// Calls func with a default-constructed PatchCodec for the given format
+template<typename TFunc>
+decltype(auto) DispatchPatchCodec(const PatchFormat format, TFunc &&func)
+{
+	if (format == PatchFormat::JD800)
+		return func(PatchCodec<Patch800>{});
+	else if (format == PatchFormat::JD990)
+		return func(PatchCodec<Patch990>{});
+	else
+		return func(PatchCodec<PatchVST>{});
+}
+
+
+// The patch converters, i.e. the edges of the conversion graph that ConversionPlan searches at runtime
+inline void ConvertPatchDirect(const Patch800 &source, Patch990 &target, ConversionContext &context) { ConvertPatch800To990(source, target, context); }
+inline void ConvertPatchDirect(const Patch990 &source, Patch800 &target, ConversionContext &context) { ConvertPatch990To800(source, target, context); }
+inline void ConvertPatchDirect(const Patch800 &source, PatchVST &target, ConversionContext &context) { ConvertPatch800ToVST(source, target, context); }
+inline void ConvertPatchDirect(const PatchVST &source, Patch800 &target, ConversionContext &context) { ConvertPatchVSTTo800(source, target, context); }
+
+template<typename TSource, typename TTarget>
+constexpr bool HasDirectConversion = std::is_same_v<TSource, TTarget> || requires(const TSource &source, TTarget &target, ConversionContext &context) { ConvertPatchDirect(source, target, context); };
+
+// Format that a patch passes through on its way from TSource to TTarget, or void if there is none.
+// There is no direct conversion between JD-990 and VST patches, so they are converted via JD-800, like on the shortest path that ConversionPlan finds.
+template<typename TSource, typename TTarget>
+using IntermediatePatch = std::conditional_t<HasDirectConversion<TSource, TTarget>, void, Patch800>;
+
+// Compile-time counterpart of ConversionPlan for loops that are instantiated for a specific source and target format
+template<typename TSource, typename TTarget>
+void ConvertPath(const TSource &source, TTarget &target, ConversionContext &context)
+{
+	using TIntermediate = IntermediatePatch<TSource, TTarget>;
+	if constexpr (std::is_same_v<TSource, TTarget>)
+	{
+		target = source;
+	}
+	else if constexpr (std::is_void_v<TIntermediate>)
+	{
+		ConvertPatchDirect(source, target, context);
+	}
+	else
+	{
+		TIntermediate intermediate{};
+		ConvertPath(source, intermediate, context);
+		ConvertPath(intermediate, target, context);
+	}
+}
+
+// Converts a patch into two formats. If the second target format is reached via the first one, the first result is reused instead of being converted again.
+template<typename TSource, typename TFirst, typename TSecond>
+void ConvertPath(const TSource &source, TFirst &first, TSecond &second, ConversionContext &context)
+{
+	ConvertPath(source, first, context);
+	if constexpr (std::is_same_v<IntermediatePatch<TSource, TSecond>, TFirst>)
+		ConvertPath(first, second, context);
+	else
+		ConvertPath(source, second, context);
+}
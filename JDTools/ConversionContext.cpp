@@ -0,0 +1,50 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "ConversionContext.hpp"
+#include "ToneCache.hpp"
+
+#include <ostream>
+
+ConversionContext::ConversionContext(const ConversionOptions &options)
+	: m_discardedWarnings{std::make_unique<std::ostream>(nullptr)}
+	, m_warnings{*m_discardedWarnings}
+	, m_options{options}
+{
+}
+
+ConversionContext::ConversionContext(std::ostream &warnings, const ConversionOptions &options)
+	: m_warnings{warnings}
+	, m_options{options}
+{
+}
+
+ConversionContext::~ConversionContext() = default;
+
+std::ostream &ConversionContext::Warning()
+{
+	m_numWarnings++;
+	return m_warnings;
+}
+
+void ConversionContext::AddWarnings(const std::string_view text, const uint64_t count)
+{
+	if (!text.empty())
+		m_warnings << text << std::flush;
+	m_numWarnings += count;
+}
+
+ConversionContext::ToneCache &ConversionContext::GetToneCache()
+{
+	if (!m_toneCache)
+		m_toneCache = std::make_unique<ToneCache>();
+	return *m_toneCache;
+}
+
+ToneCacheStats ConversionContext::GetToneCacheStats() const
+{
+	if (!m_toneCache)
+		return {};
+	return m_toneCache->stats;
+}
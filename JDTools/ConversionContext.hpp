@@ -0,0 +1,59 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+struct ConversionOptions
+{
+	double tempo = 120.0;  // Tempo-synced LFO rates and delay taps of VST patches are approximated at this tempo (in BPM)
+	bool strict = false;   // Any loss of information is treated as an error by the caller
+};
+
+// Identical tones are only converted to VST once, e.g. when they are used in several layers of a patch or in several keys of a special setup.
+// Counts how often the cache was used.
+struct ToneCacheStats
+{
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
+// Everything the patch converters need apart from the patches themselves: Options, a sink for warnings about lost information,
+// and scratch memory that is reused between conversions. The converters do not touch any global state,
+// so patches can be converted concurrently without locking, as long as every thread uses its own context.
+class ConversionContext
+{
+public:
+	// Warnings are counted but not printed
+	explicit ConversionContext(const ConversionOptions &options = {});
+	explicit ConversionContext(std::ostream &warnings, const ConversionOptions &options = {});
+	~ConversionContext();
+
+	ConversionContext(const ConversionContext &) = delete;
+	ConversionContext &operator=(const ConversionContext &) = delete;
+
+	const ConversionOptions &GetOptions() const { return m_options; }
+
+	// Returns the stream that a single warning should be written to, terminated by std::endl
+	std::ostream &Warning();
+	// Passes on warnings that have been collected by another context
+	void AddWarnings(const std::string_view text, const uint64_t count);
+	uint64_t GetNumWarnings() const { return m_numWarnings; }
+
+	// Scratch memory of the JD-800 to VST converter, created on first use
+	struct ToneCache;
+	ToneCache &GetToneCache();
+	ToneCacheStats GetToneCacheStats() const;
+
+private:
+	std::unique_ptr<std::ostream> m_discardedWarnings;
+	std::ostream &m_warnings;
+	const ConversionOptions m_options;
+	uint64_t m_numWarnings = 0;
+	std::unique_ptr<ToneCache> m_toneCache;
+};
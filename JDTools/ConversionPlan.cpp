@@ -0,0 +1,149 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "ConversionPlan.hpp"
+#include "ConversionContext.hpp"
+#include "JDTools.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	struct ConversionEdge
+	{
+		PatchFormat from, to;
+		void (*convert)(const void *source, void *target, ConversionContext &context);
+	};
+
+	template<typename TSource, typename TTarget, void (*ConvertFunc)(const TSource &, TTarget &, ConversionContext &)>
+	void ConvertEdge(const void *source, void *target, ConversionContext &context)
+	{
+		ConvertFunc(*static_cast<const TSource *>(source), *static_cast<TTarget *>(target), context);
+	}
+
+	constexpr ConversionEdge Edges[] =
+	{
+		{ PatchFormat::JD800, PatchFormat::JD990, ConvertEdge<Patch800, Patch990, ConvertPatch800To990> },
+		{ PatchFormat::JD990, PatchFormat::JD800, ConvertEdge<Patch990, Patch800, ConvertPatch990To800> },
+		{ PatchFormat::JD800, PatchFormat::VST, ConvertEdge<Patch800, PatchVST, ConvertPatch800ToVST> },
+		{ PatchFormat::VST, PatchFormat::JD800, ConvertEdge<PatchVST, Patch800, ConvertPatchVSTTo800> },
+	};
+
+	constexpr size_t NUM_FORMATS = 3;
+
+	// Breadth-first search over the converter graph, so that every patch goes through as few conversions as possible
+	struct ShortestPaths
+	{
+		std::array<bool, NUM_FORMATS> reachable{};
+		std::array<PatchFormat, NUM_FORMATS> previous{};
+		std::vector<PatchFormat> order;  // All reachable formats, in order of increasing distance from the source
+	};
+
+	ShortestPaths FindShortestPaths(const PatchFormat source)
+	{
+		ShortestPaths paths;
+		paths.order.push_back(source);
+		paths.reachable[static_cast<size_t>(source)] = true;
+		for (size_t i = 0; i < paths.order.size(); i++)
+		{
+			for (const auto &edge : Edges)
+			{
+				if (edge.from != paths.order[i] || paths.reachable[static_cast<size_t>(edge.to)])
+					continue;
+				paths.reachable[static_cast<size_t>(edge.to)] = true;
+				paths.previous[static_cast<size_t>(edge.to)] = edge.from;
+				paths.order.push_back(edge.to);
+			}
+		}
+		return paths;
+	}
+
+	const ConversionEdge &FindEdge(const PatchFormat from, const PatchFormat to)
+	{
+		return *std::find_if(std::begin(Edges), std::end(Edges), [&](const ConversionEdge &e) { return e.from == from && e.to == to; });
+	}
+}
+
+size_t GetPatchSize(const PatchFormat format)
+{
+	switch (format)
+	{
+	case PatchFormat::JD800: return sizeof(Patch800);
+	case PatchFormat::JD990: return sizeof(Patch990);
+	case PatchFormat::VST: return sizeof(PatchVST);
+	}
+	return 0;
+}
+
+std::string_view GetFormatName(const PatchFormat format)
+{
+	switch (format)
+	{
+	case PatchFormat::JD800: return "JD-800";
+	case PatchFormat::JD990: return "JD-990";
+	case PatchFormat::VST: return "JD-800 VST / JD-08 / ZC1";
+	}
+	return {};
+}
+
+struct ConversionPlan::Intermediates
+{
+	Patch800 p800{};
+	Patch990 p990{};
+	PatchVST pVST{};
+
+	void *Get(const PatchFormat format)
+	{
+		switch (format)
+		{
+		case PatchFormat::JD800: return &p800;
+		case PatchFormat::JD990: return &p990;
+		case PatchFormat::VST: return &pVST;
+		}
+		return nullptr;
+	}
+};
+
+ConversionPlan::ConversionPlan(const PatchFormat source, const PatchFormat target)
+{
+	const ShortestPaths paths = FindShortestPaths(source);
+	if (!paths.reachable[static_cast<size_t>(target)])
+		throw std::invalid_argument("No conversion path between patch formats");
+
+	for (PatchFormat format = target; format != source; format = paths.previous[static_cast<size_t>(format)])
+	{
+		m_path.push_back(format);
+	}
+	m_path.push_back(source);
+	std::reverse(m_path.begin(), m_path.end());
+
+	if (m_path.size() > 2)
+		m_intermediates = std::make_unique<Intermediates>();
+}
+
+ConversionPlan::~ConversionPlan() = default;
+
+void ConversionPlan::Convert(const void *source, void *target, ConversionContext &context)
+{
+	if (m_path.size() == 1)
+	{
+		std::memcpy(target, source, GetPatchSize(m_path.front()));
+		return;
+	}
+
+	const void *stepSource = source;
+	for (size_t step = 1; step < m_path.size(); step++)
+	{
+		void *stepTarget = (step == m_path.size() - 1) ? target : m_intermediates->Get(m_path[step]);
+		FindEdge(m_path[step - 1], m_path[step]).convert(stepSource, stepTarget, context);
+		stepSource = stepTarget;
+	}
+}
@@ -0,0 +1,47 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+class ConversionContext;
+
+// Patch representations that the converters operate on.
+// BIN, SVZ and SVD files all store VST patches, so they share the same node in the conversion graph.
+enum class PatchFormat
+{
+	JD800,
+	JD990,
+	VST,
+};
+
+std::string_view GetFormatName(const PatchFormat format);
+// Size of a Patch800, Patch990 or PatchVST
+size_t GetPatchSize(const PatchFormat format);
+
+// Finds the shortest chain of patch converters between two formats and runs it in memory, one patch at a time.
+// The plan keeps the intermediate results, so every thread needs its own plan.
+class ConversionPlan
+{
+public:
+	ConversionPlan(const PatchFormat source, const PatchFormat target);
+	~ConversionPlan();
+
+	PatchFormat GetSource() const { return m_path.front(); }
+	PatchFormat GetTarget() const { return m_path.back(); }
+	// All formats visited by the plan, including source and target format
+	const std::vector<PatchFormat> &GetPath() const { return m_path; }
+
+	// Source and target must point to a Patch800, Patch990 or PatchVST according to the plan's source and target format.
+	void Convert(const void *source, void *target, ConversionContext &context);
+
+private:
+	struct Intermediates;
+
+	std::vector<PatchFormat> m_path;
+	std::unique_ptr<Intermediates> m_intermediates;
+};
@@ -2,6 +2,7 @@
 // 2022 - 2024 by Johannes Schultz
 // License: BSD 3-clause
 
+#include "ConversionContext.hpp"
 #include "JD-800.hpp"
 #include "JD-990.hpp"
 #include "Utils.hpp"
@@ -131,7 +132,8 @@ static void ConvertTone800To990(const uint8_t aTouchBend800, const Tone800 &t800
 	t990.cs2.depth4 = t800.tva.aTouchSens;
 }
 
-void ConvertPatch800To990(const Patch800 &p800, Patch990 &p990)
+// Every JD-800 parameter can be represented on the JD-990, so there is nothing to report to the context
+void ConvertPatch800To990(const Patch800 &p800, Patch990 &p990, ConversionContext &)
 {
 	p990.common.name = p800.common.name;
 	p990.common.patchLevel = p800.common.patchLevel;
@@ -259,7 +261,7 @@ void ConvertPatch800To990(const Patch800 &p800, Patch990 &p990)
 	ConvertTone800To990(p800.common.aTouchBend, p800.toneD, p990.toneD);
 }
 
-void ConvertSetup800To990(const SpecialSetup800 &s800, SpecialSetup990 &s990)
+void ConvertSetup800To990(const SpecialSetup800 &s800, SpecialSetup990 &s990, ConversionContext &)
 {
 	std::memcpy(s990.common.name.data(), "JD-800 Drum Set ", s990.common.name.size());
 	s990.common.level = 80;
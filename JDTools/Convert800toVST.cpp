@@ -2,12 +2,18 @@
 // 2022 - 2024 by Johannes Schultz
 // License: BSD 3-clause
 
+#include "JDTools.hpp"
 #include "JD-800.hpp"
 #include "JD-08.hpp"
 #include "PrecomputedTablesVST.hpp"
+#include "ToneCache.hpp"
 #include "Utils.hpp"
 
-#include <iostream>
+#include <array>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
 
 template<typename T, size_t N>
 static T SignedTable(const T (&table)[N], int8_t offset)
@@ -35,7 +41,7 @@ static uint8_t ConvertPitchEnvLevel(uint8_t value)
 	return static_cast<uint8_t>(converted);
 }
 
-static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const bool selected, ToneVST &tVST)
+static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const bool selected, ToneVST &tVST, ConversionContext &context)
 {
 	tVST.common.layerEnabled = enabled;
 	tVST.common.layerSelected = selected;
@@ -62,7 +68,7 @@ static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const b
 
 	if (t800.wg.waveSource != 0 && tVST.common.layerEnabled)
 	{
-		std::cerr << "LOSSY CONVERSION! Waveforms from ROM cards are not supported!" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Waveforms from ROM cards are not supported!" << std::endl;
 	}
 	tVST.wg.waveformLSB = (t800.wg.waveformLSB + 1) & 0x7F;
 	tVST.wg.unknown1637_00 = 0;
@@ -74,7 +80,7 @@ static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const b
 	if (tVST.wg.pitchRandom > 0 && tVST.wg.pitchRandom < 20)
 	{
 		tVST.wg.pitchRandom = 20;
-		std::cerr << "LOSSY CONVERSION! Pitch Random values 1-19 do nothing, setting to 20 instead" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Pitch Random values 1-19 do nothing, setting to 20 instead" << std::endl;
 	}
 	tVST.wg.keyFollow = t800.wg.keyFollow;
 	tVST.wg.benderSwitch = t800.wg.benderSwitch;
@@ -107,13 +113,13 @@ static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const b
 	{
 		tVST.wg.pitchCoarse = -48;
 		if (tVST.common.layerEnabled)
-			std::cerr << "LOSSY CONVERSION! Tone coarse pitch too low (maybe due to waveform transposition)" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Tone coarse pitch too low (maybe due to waveform transposition)" << std::endl;
 	}
 	else if (tVST.wg.pitchCoarse > 48)
 	{
 		tVST.wg.pitchCoarse = 48;
 		if (tVST.common.layerEnabled)
-			std::cerr << "LOSSY CONVERSION! Tone coarse pitch too high (maybe due to waveform transposition)" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Tone coarse pitch too high (maybe due to waveform transposition)" << std::endl;
 	}
 
 	tVST.pitchEnv.velo = t800.pitchEnv.velo - 50;
@@ -127,7 +133,7 @@ static void ConvertTone800ToVST(const Tone800 &t800, const bool enabled, const b
 	tVST.pitchEnv.time3 = t800.pitchEnv.time3;
 	if (t800.pitchEnv.level0 < 4 || t800.pitchEnv.level1 < 4 || t800.pitchEnv.level2 < 4)
 	{
-		std::cerr << "LOSSY CONVERSION! Pitch envelope cannot go lower than one octave" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Pitch envelope cannot go lower than one octave" << std::endl;
 	}
 
 	tVST.tvf.filterMode = 2 - t800.tvf.filterMode;
@@ -323,7 +329,10 @@ static void FillPrecomputedToneVST(const ToneVST &tVST, const PatchVST &pVST, To
 
 	FillPrecomputedLFO(tVST.lfo1, 0, tVST, tpVST.lfo[tone].lfo1);
 	FillPrecomputedLFO(tVST.lfo2, 1, tVST, tpVST.lfo[tone].lfo2);
+}
 
+static void FillPrecomputedEQ(const PatchVST &pVST, ToneVSTPrecomputed &tpVST, const uint8_t tone)
+{
 	ToneVSTPrecomputed::EQ &eq = tpVST.eq[tone];
 	eq.lowGain = pVST.eq.lowGain;
 	eq.midGain = pVST.eq.midGain;
@@ -335,7 +344,59 @@ static void FillPrecomputedToneVST(const ToneVST &tVST, const PatchVST &pVST, To
 	eq.eqEnabled = pVST.eq.eqEnabled;
 }
 
-void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST)
+// Converts the tone into slot "tone" of the patch and fills its precomputed values, except for the EQ.
+// The patch's key ranges and aftertouch bend setting must have been set already, and the precomputed values of the slot must be cleared.
+static void ConvertToneCached(const Tone800 &t800, const bool enabled, const bool selected, PatchVST &pVST, const uint8_t tone, ConversionContext &context)
+{
+	const uint8_t LowKeys[] = { pVST.common.keyRangeLowA, pVST.common.keyRangeLowB, pVST.common.keyRangeLowC, pVST.common.keyRangeLowD };
+	const uint8_t HighKeys[] = { pVST.common.keyRangeHighA, pVST.common.keyRangeHighB, pVST.common.keyRangeHighC, pVST.common.keyRangeHighD };
+	ToneCacheKey key;
+	std::memcpy(key.data(), &t800, sizeof(Tone800));
+	key[sizeof(Tone800) + 0] = enabled ? 1 : 0;
+	key[sizeof(Tone800) + 1] = selected ? 1 : 0;
+	key[sizeof(Tone800) + 2] = LowKeys[tone];
+	key[sizeof(Tone800) + 3] = HighKeys[tone];
+	key[sizeof(Tone800) + 4] = pVST.common.aTouchBend;
+
+	ConversionContext::ToneCache &cache = context.GetToneCache();
+	ToneVSTPrecomputed &tpVST = pVST.tonesPrecomputed;
+	ToneCacheEntry &entry = cache.entries[HashFNV1a(key.data(), key.size()) % TONE_CACHE_SIZE];
+	if (entry.valid && entry.key == key)
+	{
+		pVST.tone[tone] = entry.tone;
+		tpVST.layer[tone] = entry.layer;
+		tpVST.common[tone] = entry.common;
+		tpVST.pitchEnv[tone] = entry.pitchEnv;
+		tpVST.tvfEnv[tone] = entry.tvfEnv;
+		tpVST.tvaEnv[tone] = entry.tvaEnv;
+		tpVST.lfo[tone] = entry.lfo;
+		context.AddWarnings(entry.warnings, entry.numWarnings);
+		cache.stats.hits++;
+		return;
+	}
+
+	// The tone's warnings are collected separately so that they can be reported again when the entry is reused
+	cache.warnings.str({});
+	ConversionContext toneContext{cache.warnings, context.GetOptions()};
+	ConvertTone800ToVST(t800, enabled, selected, pVST.tone[tone], toneContext);
+	FillPrecomputedToneVST(pVST.tone[tone], pVST, tpVST, tone);
+	cache.stats.misses++;
+
+	entry.valid = true;
+	entry.key = key;
+	entry.tone = pVST.tone[tone];
+	entry.layer = tpVST.layer[tone];
+	entry.common = tpVST.common[tone];
+	entry.pitchEnv = tpVST.pitchEnv[tone];
+	entry.tvfEnv = tpVST.tvfEnv[tone];
+	entry.tvaEnv = tpVST.tvaEnv[tone];
+	entry.lfo = tpVST.lfo[tone];
+	entry.warnings = cache.warnings.str();
+	entry.numWarnings = toneContext.GetNumWarnings();
+	context.AddWarnings(entry.warnings, entry.numWarnings);
+}
+
+void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST, ConversionContext &context)
 {
 	pVST.zenHeader = PatchVST::DEFAULT_ZEN_HEADER;
 	pVST.name = p800.common.name;
@@ -348,7 +409,7 @@ void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST)
 
 	static constexpr uint8_t DistortionPos[] = { 0, 0, 0, 0, 0, 0, 1, 1, 3, 2, 2, 3, 2, 3, 1, 1, 3, 2, 3, 2, 2, 3, 1, 1 };
 	static constexpr uint8_t PhaserPos[] = { 1, 1, 3, 2, 2, 3, 0, 0, 0, 0, 0, 0, 1, 1, 3, 2, 2, 3, 1, 1, 3, 2, 2, 3 };
-	static constexpr uint8_t SpectrumPos[] = { 2, 3, 1, 1, 3, 2, 2, 3, 21, 1, 3, 2, 0, 0, 0, 0, 0, 0, 2, 3, 1, 1, 3, 2 };
+	static constexpr uint8_t SpectrumPos[] = { 2, 3, 1, 1, 3, 2, 2, 3, 1, 1, 3, 2, 0, 0, 0, 0, 0, 0, 2, 3, 1, 1, 3, 2 };
 	static constexpr uint8_t EnhancerPos[] = { 3, 2, 2, 3, 1, 1, 3, 2, 2, 3, 1, 1, 3, 2, 2, 3, 1, 1, 0, 0, 0, 0, 0, 0 };
 	const uint8_t BlockEnabledA[] = { p800.effect.groupAblockSwitch1, p800.effect.groupAblockSwitch2, p800.effect.groupAblockSwitch3, p800.effect.groupAblockSwitch4 };
 
@@ -377,11 +438,6 @@ void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST)
 	pVST.effectsGroupA.panningGroupA = 64;
 	pVST.effectsGroupA.effectsLevelGroupA = 127;  // Extended feature
 
-	ConvertTone800ToVST(p800.toneA, p800.common.layerTone & 1, p800.common.activeTone & 1, pVST.tone[0]);
-	ConvertTone800ToVST(p800.toneB, p800.common.layerTone & 2, p800.common.activeTone & 2, pVST.tone[1]);
-	ConvertTone800ToVST(p800.toneC, p800.common.layerTone & 4, p800.common.activeTone & 4, pVST.tone[2]);
-	ConvertTone800ToVST(p800.toneD, p800.common.layerTone & 8, p800.common.activeTone & 8, pVST.tone[3]);
-
 	static constexpr uint8_t ChorusPos[] = { 0, 0, 1, 2, 1, 2 };
 	static constexpr uint8_t DelayPos[] = { 1, 2, 0, 0, 2, 1 };
 	static constexpr uint8_t ReverbPos[] = { 2, 1, 2, 1, 0, 0 };
@@ -468,9 +524,11 @@ void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST)
 
 	pVST.tonesPrecomputed = {};
 	pVST.tonesPrecomputed.unknown112[20] = 1;
+	const Tone800 *Tones[] = { &p800.toneA, &p800.toneB, &p800.toneC, &p800.toneD };
 	for (uint8_t i = 0; i < 4; i++)
 	{
-		FillPrecomputedToneVST(pVST.tone[i], pVST, pVST.tonesPrecomputed, i);
+		ConvertToneCached(*Tones[i], p800.common.layerTone & (1 << i), p800.common.activeTone & (1 << i), pVST, i, context);
+		FillPrecomputedEQ(pVST, pVST.tonesPrecomputed, i);
 	}
 
 	pVST.tonesPrecomputed.unison = pVST.unison;
@@ -486,10 +544,8 @@ void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST)
 	};
 }
 
-std::vector<PatchVST> ConvertSetup800ToVST(const SpecialSetup800 &s800)
+std::vector<PatchVST> ConvertSetup800ToVST(const SpecialSetup800 &s800, ConversionContext &context)
 {
-	std::vector<PatchVST> patches(64);
-
 	Patch800 p800{};
 	p800.common.patchLevel = 100;
 	p800.common.keyRangeLowA = 0;
@@ -528,23 +584,33 @@ std::vector<PatchVST> ConvertSetup800ToVST(const SpecialSetup800 &s800)
 	p800.midiTx.holdMode = 2;
 	p800.midiTx.dummy = 0;
 
+	// All keys share the same common, EQ and effect settings, so convert them only once
+	// and only convert the key's tone into a copy of the resulting patch.
+	p800.common.name.fill(' ');
+	PatchVST templateVST;
+	ConvertPatch800ToVST(p800, templateVST, context);
+
 	static constexpr std::array<const char *, 12> KeyNames = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
 
+	std::vector<PatchVST> patches(64, templateVST);
 	for (uint8_t key = 0; key < 61; key++)
 	{
+		PatchVST &pVST = patches[key];
 		std::string name = "Drum Key " + (KeyNames[key % 12u] + std::string(1, '2' + key / 12));
-		name.resize(p800.common.name.size(), ' ');
-		std::copy(name.begin(), name.end(), p800.common.name.begin());
-
-		p800.toneA = s800.keys[key].tone;
-
-		ConvertPatch800ToVST(p800, patches[key]);
-	}
-	p800.common.name.fill(' ');
-	p800.toneA = {};
-	for (uint8_t key = 61; key < 64; key++)
-	{
-		ConvertPatch800ToVST(p800, patches[key]);
+		name.resize(pVST.name.size(), ' ');
+		std::copy(name.begin(), name.end(), pVST.name.begin());
+
+		// Some precomputed values are only written conditionally, so clear the template's values first
+		ToneVSTPrecomputed &tpVST = pVST.tonesPrecomputed;
+		tpVST.layer[0] = {};
+		tpVST.common[0] = {};
+		tpVST.pitchEnv[0] = {};
+		tpVST.tvfEnv[0] = {};
+		tpVST.tvaEnv[0] = {};
+		tpVST.lfo[0] = {};
+		tpVST.eq[0] = {};
+		ConvertToneCached(s800.keys[key].tone, p800.common.layerTone & 1, p800.common.activeTone & 1, pVST, 0, context);
+		FillPrecomputedEQ(pVST, tpVST, 0);
 	}
 	return patches;
 }
@@ -2,21 +2,22 @@
 // 2022 - 2024 by Johannes Schultz
 // License: BSD 3-clause
 
+#include "ConversionContext.hpp"
 #include "JD-800.hpp"
 #include "JD-990.hpp"
 #include "Utils.hpp"
 
 #include <algorithm>
-#include <iostream>
+#include <ostream>
 
-static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t depth, uint8_t &aTouchBend800, Tone800 &t800)
+static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t depth, uint8_t &aTouchBend800, Tone800 &t800, ConversionContext &context)
 {
 	if (source == 0 && dest == 4)
 	{
 		// Mod Wheel to Pitch via LFO 1
 		if (depth < 50)
 		{
-			std::cerr << "LOSSY CONVERSION! Mod Wheel to LFO1 mod matrix routing with negative modulation!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Mod Wheel to LFO1 mod matrix routing with negative modulation!" << std::endl;
 			depth = 100 - depth;
 		}
 		t800.wg.leverSens = 50 + (depth - 50);
@@ -26,7 +27,7 @@ static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t
 		// Mod wheel to Pitch via LFO 2
 		if (depth < 50)
 		{
-			std::cerr << "LOSSY CONVERSION! Mod Wheel to LFO2 mod matrix routing with negative modulation!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Mod Wheel to LFO2 mod matrix routing with negative modulation!" << std::endl;
 			depth = 100 - depth;
 		}
 		t800.wg.leverSens = 50 - (depth - 50);
@@ -36,7 +37,7 @@ static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t
 		// Aftertouch to Pitch via LFO 1
 		if (depth < 50)
 		{
-			std::cerr << "LOSSY CONVERSION! Aftertouch to LFO1 mod matrix routing with negative modulation!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Aftertouch to LFO1 mod matrix routing with negative modulation!" << std::endl;
 			depth = 100 - depth;
 		}
 		t800.wg.aTouchModSens = 50 + (depth - 50);
@@ -46,7 +47,7 @@ static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t
 		// Aftertouch to Pitch via LFO 2
 		if (depth < 50)
 		{
-			std::cerr << "LOSSY CONVERSION! Aftertouch to LFO2 mod matrix routing with negative modulation!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Aftertouch to LFO2 mod matrix routing with negative modulation!" << std::endl;
 			depth = 100 - depth;
 		}
 		t800.wg.aTouchModSens = 50 - (depth - 50);
@@ -62,7 +63,7 @@ static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t
 		else if (depth >= -12 + 50 && depth <= 12 + 50)
 			aTouchBend800 = depth - (-12 + 50) + 2;
 		else
-			std::cerr << "LOSSY CONVERSION! Aftertouch to pitch bend modulation has incompatible value: " << int(depth) << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Aftertouch to pitch bend modulation has incompatible value: " << int(depth) << std::endl;
 	}
 	else if (source == 1 && dest == 1)
 	{
@@ -76,11 +77,11 @@ static void ConvertToneControl(const uint8_t source, const uint8_t dest, uint8_t
 	}
 	else if (depth != 50)
 	{
-		std::cerr << "LOSSY CONVERSION! Unknown mod matrix routing: source = " << int(source) << ", dest = " << int(dest) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Unknown mod matrix routing: source = " << int(source) << ", dest = " << int(dest) << std::endl;
 	}
 }
 
-static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t toneControlSource2, const Tone990 &t990, uint8_t &aTouchBend800, Tone800 &t800, const bool isSetupConversion)
+static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t toneControlSource2, const Tone990 &t990, uint8_t &aTouchBend800, Tone800 &t800, const bool isSetupConversion, ConversionContext &context)
 {
 	t800.common.velocityCurve = t990.common.velocityCurve;
 	t800.common.holdControl = t990.common.holdControl;
@@ -96,7 +97,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 	if (t800.lfo1.waveform & 0x80)
 	{
 		t800.lfo1.waveform &= 0x7F;
-		std::cerr << "LOSSY CONVERSION! JD-990 tone LFO1 has unsupported LFO waveform: " << int(t990.lfo1.waveform) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone LFO1 has unsupported LFO waveform: " << int(t990.lfo1.waveform) << std::endl;
 	}
 
 	t800.lfo2.rate = t990.lfo2.rate;
@@ -108,7 +109,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 	if (t800.lfo2.waveform & 0x80)
 	{
 		t800.lfo2.waveform &= 0x7F;
-		std::cerr << "LOSSY CONVERSION! JD-990 tone LFO2 has unsupported LFO waveform: " << int(t990.lfo2.waveform) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone LFO2 has unsupported LFO waveform: " << int(t990.lfo2.waveform) << std::endl;
 	}
 
 	t800.wg.waveSource = t990.wg.waveSource;
@@ -129,7 +130,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 	if (t990.wg.waveSource == 0 && (t800.wg.waveformMSB > 0 || t800.wg.waveformLSB > 107))
 	{
 		const int waveform = (t990.wg.waveformMSB << 7) | t990.wg.waveformLSB;
-		std::cerr << "LOSSY CONVERSION! JD-990 tone uses unsupported internal waveform: " << waveform << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone uses unsupported internal waveform: " << waveform << std::endl;
 		if (waveform >= 108 && waveform <= 194)
 		{
 			// Most of these will of course not be close to the original.
@@ -150,13 +151,13 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 		}
 	}
 	if (t990.wg.fxmColor != 0 || t990.wg.fxmDepth != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has FXM enabled!" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has FXM enabled!" << std::endl;
 	if (t990.wg.syncSlaveSwitch != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has sync slave switch enabled!" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has sync slave switch enabled!" << std::endl;
 	if (t990.wg.toneDelayTime != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has tone delay enabled!" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has tone delay enabled!" << std::endl;
 	if (t990.wg.envDepth != 24 && (t990.pitchEnv.level0 != 50 || t990.pitchEnv.level1 != 50 || t990.pitchEnv.sustainLevel != 50 || t990.pitchEnv.level3 != 50))
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has pitch envelope depth level != 24: " << int(t990.wg.envDepth) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has pitch envelope depth level != 24: " << int(t990.wg.envDepth) << std::endl;
 
 	t800.pitchEnv.velo = t990.pitchEnv.velo;
 	t800.pitchEnv.timeVelo = t990.pitchEnv.timeVelo;
@@ -168,7 +169,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 	t800.pitchEnv.time3 = t990.pitchEnv.time3;
 	t800.pitchEnv.level2 = t990.pitchEnv.level3;
 	if (t990.pitchEnv.sustainLevel != 50)
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has pitch envelope sustain level != 50: " << int(t990.pitchEnv.sustainLevel) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has pitch envelope sustain level != 50: " << int(t990.pitchEnv.sustainLevel) << std::endl;
 
 	t800.tvf.filterMode = t990.tvf.filterMode;
 	t800.tvf.cutoffFreq = t990.tvf.cutoffFreq;
@@ -180,7 +181,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 		t800.tvf.lfoSelect = 1;
 		t800.tvf.lfoDepth = t990.lfo2.depthTVF;
 		if (t990.lfo1.depthTVF != 50)
-			std::cerr << "LOSSY CONVERSION! JD-990 tone has both LFOs controlling TVF!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! JD-990 tone has both LFOs controlling TVF!" << std::endl;
 	}
 	else
 	{
@@ -211,7 +212,7 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 		t800.tva.lfoSelect = 1;
 		t800.tva.lfoDepth = t990.lfo2.depthTVA;
 		if (t990.lfo1.depthTVA != 50)
-			std::cerr << "LOSSY CONVERSION! JD-990 tone has both LFOs controlling TVA!" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! JD-990 tone has both LFOs controlling TVA!" << std::endl;
 	}
 	else
 	{
@@ -220,11 +221,11 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 	}
 	if (t990.tva.pan != 50 && !isSetupConversion)
 	{
-		std::cerr << "LOSSY CONVERSION! JD-990 tone has pan position != 50: " << int(t990.tva.pan) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone has pan position != 50: " << int(t990.tva.pan) << std::endl;
 	}
 	if (t990.tva.panKeyFollow != 7)
 	{
-		std::cerr << "LOSSY CONVERSION! JD-990 tone uses pan key follow: " << int(t990.tva.panKeyFollow) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 tone uses pan key follow: " << int(t990.tva.panKeyFollow) << std::endl;
 	}
 
 	t800.tvaEnv.velo = t990.tvaEnv.velo;
@@ -240,21 +241,21 @@ static void ConvertTone990To800(const uint8_t toneControlSource1, const uint8_t
 
 	if (toneControlSource1 > 1)
 	{
-		std::cerr << "LOSSY CONVERSION! JD-990 patch uses tone control source 1 other than mod wheel or aftertouch: " << int(toneControlSource1) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch uses tone control source 1 other than mod wheel or aftertouch: " << int(toneControlSource1) << std::endl;
 	}
 	if (toneControlSource2 > 1)
 	{
-		std::cerr << "LOSSY CONVERSION! JD-990 patch uses tone control source 2 other than mod wheel or aftertouch: " << int(toneControlSource1) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch uses tone control source 2 other than mod wheel or aftertouch: " << int(toneControlSource1) << std::endl;
 	}
 
-	ConvertToneControl(toneControlSource1, t990.cs1.destination1, t990.cs1.depth1, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource1, t990.cs1.destination2, t990.cs1.depth2, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource1, t990.cs1.destination3, t990.cs1.depth3, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource1, t990.cs1.destination4, t990.cs1.depth4, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource2, t990.cs2.destination1, t990.cs2.depth1, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource2, t990.cs2.destination2, t990.cs2.depth2, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource2, t990.cs2.destination3, t990.cs2.depth3, aTouchBend800, t800);
-	ConvertToneControl(toneControlSource2, t990.cs2.destination4, t990.cs2.depth4, aTouchBend800, t800);
+	ConvertToneControl(toneControlSource1, t990.cs1.destination1, t990.cs1.depth1, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource1, t990.cs1.destination2, t990.cs1.depth2, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource1, t990.cs1.destination3, t990.cs1.depth3, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource1, t990.cs1.destination4, t990.cs1.depth4, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource2, t990.cs2.destination1, t990.cs2.depth1, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource2, t990.cs2.destination2, t990.cs2.depth2, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource2, t990.cs2.destination3, t990.cs2.depth3, aTouchBend800, t800, context);
+	ConvertToneControl(toneControlSource2, t990.cs2.destination4, t990.cs2.depth4, aTouchBend800, t800, context);
 }
 
 static void FixupStructure990To800(const uint8_t structureType, Tone800 &tone1, Tone800 &tone2)
@@ -275,21 +276,21 @@ static void FixupStructure990To800(const uint8_t structureType, Tone800 &tone1,
 	}
 }
 
-void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800)
+void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800, ConversionContext &context)
 {
 	if (p990.structureType.structureAB != 0 && (p990.common.activeTone & (1 | 2)) != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch tones AB have unsupported structure type: " << int(p990.structureType.structureAB) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch tones AB have unsupported structure type: " << int(p990.structureType.structureAB) << std::endl;
 	if (p990.structureType.structureCD != 0 && (p990.common.activeTone & (4 | 8)) != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch tones CD have unsupported structure type: " << int(p990.structureType.structureCD) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch tones CD have unsupported structure type: " << int(p990.structureType.structureCD) << std::endl;
 
 	if (p990.velocity.velocityRange1 != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch velocity range 1 is enabled: " << int(p990.velocity.velocityRange1) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch velocity range 1 is enabled: " << int(p990.velocity.velocityRange1) << std::endl;
 	if (p990.velocity.velocityRange2 != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch velocity range 2 is enabled: " << int(p990.velocity.velocityRange2) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch velocity range 2 is enabled: " << int(p990.velocity.velocityRange2) << std::endl;
 	if (p990.velocity.velocityRange3 != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch velocity range 3 is enabled: " << int(p990.velocity.velocityRange3) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch velocity range 3 is enabled: " << int(p990.velocity.velocityRange3) << std::endl;
 	if (p990.velocity.velocityRange4 != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch velocity range 4 is enabled: " << int(p990.velocity.velocityRange4) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch velocity range 4 is enabled: " << int(p990.velocity.velocityRange4) << std::endl;
 
 	p800.common.name = p990.common.name;
 	p800.common.patchLevel = p990.common.patchLevel;
@@ -313,17 +314,17 @@ void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800)
 	p800.common.activeTone = p990.common.activeTone;
 
 	if (p990.common.patchPan != 50)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has pan != 50: " << int(p990.common.patchPan) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has pan != 50: " << int(p990.common.patchPan) << std::endl;
 	if (p990.common.analogFeel != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has analog feel != 0: " << int(p990.common.analogFeel) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has analog feel != 0: " << int(p990.common.analogFeel) << std::endl;
 	if (p990.common.voicePriority != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has voice priority != 0: " << int(p990.common.voicePriority) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has voice priority != 0: " << int(p990.common.voicePriority) << std::endl;
 	if (p990.keyEffects.portamentoType != 1 && p990.keyEffects.portamentoSW != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has portamento type != 1: " << int(p990.keyEffects.portamentoType) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has portamento type != 1: " << int(p990.keyEffects.portamentoType) << std::endl;
 	if (p990.keyEffects.soloSyncMaster != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has solo sync master != 0: " << int(p990.keyEffects.soloSyncMaster) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has solo sync master != 0: " << int(p990.keyEffects.soloSyncMaster) << std::endl;
 	if (p990.octaveSwitch != 1)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has octave switch != 1: " << int(p990.octaveSwitch) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has octave switch != 1: " << int(p990.octaveSwitch) << std::endl;
 
 	p800.eq.lowFreq = p990.eq.lowFreq;
 	p800.eq.lowGain = p990.eq.lowGain;
@@ -382,13 +383,13 @@ void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800)
 	p800.effect.delayRightLevel = p990.effect.delayRightLevel;
 	p800.effect.delayFeedback = p990.effect.delayFeedback;
 	if (p990.effect.delayCenterTapMSB != 0 || p990.effect.delayCenterTapLSB > 0x7D)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has unsupported delay center tap: " << int(p990.effect.delayCenterTapMSB) << "/" << int(p990.effect.delayCenterTapLSB) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has unsupported delay center tap: " << int(p990.effect.delayCenterTapMSB) << "/" << int(p990.effect.delayCenterTapLSB) << std::endl;
 	if (p990.effect.delayLeftTapMSB != 0 || p990.effect.delayLeftTapLSB > 0x7D)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has unsupported delay left tap: " << int(p990.effect.delayLeftTapMSB) << "/" << int(p990.effect.delayLeftTapLSB) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has unsupported delay left tap: " << int(p990.effect.delayLeftTapMSB) << "/" << int(p990.effect.delayLeftTapLSB) << std::endl;
 	if (p990.effect.delayRightTapMSB != 0 || p990.effect.delayRightTapLSB > 0x7D)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has unsupported delay right tap: " << int(p990.effect.delayRightTapMSB) << "/" << int(p990.effect.delayRightTapLSB) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has unsupported delay right tap: " << int(p990.effect.delayRightTapMSB) << "/" << int(p990.effect.delayRightTapLSB) << std::endl;
 	if (p990.effect.delayMode != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 patch has delay effect mode != 0: " << int(p990.effect.delayMode) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 patch has delay effect mode != 0: " << int(p990.effect.delayMode) << std::endl;
 
 	p800.effect.chorusRate = p990.effect.chorusRate;
 	p800.effect.chorusDepth = p990.effect.chorusDepth;
@@ -404,18 +405,18 @@ void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800)
 	p800.effect.reverbLevel = p990.effect.reverbLevel;
 	p800.effect.dummy = 0;
 
-	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneA, p800.common.aTouchBend, p800.toneA, false);
-	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneB, p800.common.aTouchBend, p800.toneB, false);
-	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneC, p800.common.aTouchBend, p800.toneC, false);
-	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneD, p800.common.aTouchBend, p800.toneD, false);
+	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneA, p800.common.aTouchBend, p800.toneA, false, context);
+	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneB, p800.common.aTouchBend, p800.toneB, false, context);
+	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneC, p800.common.aTouchBend, p800.toneC, false, context);
+	ConvertTone990To800(p990.common.toneControlSource1, p990.common.toneControlSource2, p990.toneD, p800.common.aTouchBend, p800.toneD, false, context);
 
 	FixupStructure990To800(p990.structureType.structureAB, p800.toneA, p800.toneB);
 	FixupStructure990To800(p990.structureType.structureCD, p800.toneC, p800.toneD);
 }
 
-void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800)
+void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800, ConversionContext &context)
 {
-	std::cerr << "(Setup name and effect settings cannot be converted)" << std::endl;
+	context.Warning() << "(Setup name and effect settings cannot be converted)" << std::endl;
 
 	s800.eq.lowFreq = s990.eq.lowFreq;
 	s800.eq.lowGain = s990.eq.lowGain;
@@ -430,11 +431,11 @@ void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800)
 	s800.common.aTouchBendSens = 14;  // Will be populated by tone conversion
 
 	if (s990.common.level != 80)
-		std::cerr << "LOSSY CONVERSION! JD-990 setup has level != 80: " << int(s990.common.level) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 setup has level != 80: " << int(s990.common.level) << std::endl;
 	if (s990.common.pan != 50)
-		std::cerr << "LOSSY CONVERSION! JD-990 setup has pan != 50: " << int(s990.common.pan) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 setup has pan != 50: " << int(s990.common.pan) << std::endl;
 	if (s990.common.analogFeel != 0)
-		std::cerr << "LOSSY CONVERSION! JD-990 setup has analog feel != 0: " << int(s990.common.analogFeel) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! JD-990 setup has analog feel != 0: " << int(s990.common.analogFeel) << std::endl;
 
 	for (size_t i = 0; i < s990.keys.size(); i++)
 	{
@@ -444,7 +445,7 @@ void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800)
 		k800.muteGroup = k990.muteGroup;
 		if (k990.muteGroup > 8)
 		{
-			std::cerr << "LOSSY CONVERSION! JD-990 setup key " << i << " has unsupported mute group: " << int(k990.muteGroup) << std::endl;
+			context.Warning() << "LOSSY CONVERSION! JD-990 setup key " << i << " has unsupported mute group: " << int(k990.muteGroup) << std::endl;
 			k800.muteGroup = 0;
 		}
 		k800.envMode = k990.envMode;
@@ -452,12 +453,12 @@ void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800)
 		k800.effectMode = k990.effectMode;
 		if (k990.effectMode > 3)
 		{
-			std::cerr << "LOSSY CONVERSION! JD-990 setup key " << i << " has unsupported effect mode: " << int(k990.effectMode) << std::endl;
+			context.Warning() << "LOSSY CONVERSION! JD-990 setup key " << i << " has unsupported effect mode: " << int(k990.effectMode) << std::endl;
 			k800.effectMode = 0;
 		}
 		k800.effectLevel = k990.effectLevel;
 		k800.dummy = 0;
 		
-		ConvertTone990To800(s990.common.toneControlSource1, s990.common.toneControlSource2, k990.tone, s800.common.aTouchBendSens, k800.tone, true);
+		ConvertTone990To800(s990.common.toneControlSource1, s990.common.toneControlSource2, k990.tone, s800.common.aTouchBendSens, k800.tone, true, context);
 	}
 }
@@ -2,13 +2,14 @@
 // 2022 - 2024 by Johannes Schultz
 // License: BSD 3-clause
 
+#include "ConversionContext.hpp"
 #include "JD-800.hpp"
 #include "JD-08.hpp"
 #include "PrecomputedTablesVST.hpp"
 
 #include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <ostream>
 #include <string_view>
 
 template<typename T, size_t N>
@@ -30,7 +31,7 @@ static bool MapToArrayIndex(const T value, const T (&values)[N], uint8_t &target
 	return false;
 }
 
-static double IndexToNoteDuration(const uint8_t index)
+static double IndexToNoteDuration(const uint8_t index, const double tempo)
 {
 	static constexpr uint8_t Divisor[] = { 64, 64, 32, 32, 16, 32, 16, 8, 16, 8, 4, 8, 4, 2, 4, 2, 1, 2, 1, 1, 1, 1, 1 };
 	static constexpr uint8_t NoteType[] = { 3, 1,   3,  1,  3,  2,  1, 3,  2, 1, 3, 2, 1, 3, 2, 1, 3, 2, 1, 3, 2, 1, 1 };
@@ -45,13 +46,13 @@ static double IndexToNoteDuration(const uint8_t index)
 	else if (type == 3)
 		length *= 2.0 / 3.0;
 
-	length *= 2000.0;  // Assuming a tempo of 120 BPM, we now have the delay in milliseconds
+	length *= 240000.0 / tempo;  // A whole note lasts four beats, we now have the delay in milliseconds
 	return length;
 }
 
-static uint8_t ApproximateDelayWithTempoSync(const uint8_t index)
+static uint8_t ApproximateDelayWithTempoSync(const uint8_t index, const double tempo)
 {
-	const double tapDuration = IndexToNoteDuration(index);
+	const double tapDuration = IndexToNoteDuration(index, tempo);
 	int intOffset;
 	double offset, factor;
 	if (tapDuration < 5.5)
@@ -87,9 +88,9 @@ static uint8_t ApproximateDelayWithTempoSync(const uint8_t index)
 	return static_cast<uint8_t>(std::clamp(intOffset + std::round((tapDuration - offset) / factor), 0.0, 125.0));
 }
 
-static uint8_t ApproximateLFORateWithTempoSync(const uint8_t index)
+static uint8_t ApproximateLFORateWithTempoSync(const uint8_t index, const double tempo)
 {
-	const double noteDuration = IndexToNoteDuration(index);
+	const double noteDuration = IndexToNoteDuration(index, tempo);
 	double bestDiff = 1'000'000.0;
 	uint8_t bestIndex = 0;
 	for (uint8_t i = 0; i < std::size(LFORates); i++)
@@ -106,17 +107,17 @@ static uint8_t ApproximateLFORateWithTempoSync(const uint8_t index)
 }
 
 template<typename T, size_t N>
-static void ConvertEQBand(const T(&freqTable)[N], uint8_t &freq, uint8_t &gain, uint16_t srcFreq, int16_t srcGain, const bool enabled, const std::string_view name)
+static void ConvertEQBand(const T(&freqTable)[N], uint8_t &freq, uint8_t &gain, uint16_t srcFreq, int16_t srcGain, const bool enabled, const std::string_view name, ConversionContext &context)
 {
 	if (!MapToArrayIndex(srcFreq, freqTable, freq) && srcFreq != 0 && enabled)
-		std::cerr << "LOSSY CONVERSION! Unsupported EQ " << name << " frequency value: " << srcFreq << " Hz, changing to " << freqTable[freq] << " Hz" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Unsupported EQ " << name << " frequency value: " << srcFreq << " Hz, changing to " << freqTable[freq] << " Hz" << std::endl;
 
 	gain = static_cast<uint8_t>(enabled ? std::clamp(srcGain / 10, -15, 15) + 15 : 0);
 
 	if ((srcGain < -150 || srcGain > 150) && enabled)
-		std::cerr << "LOSSY CONVERSION! Out-of-range EQ " << name << " gain value: " << srcGain * 0.1f << " dB" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Out-of-range EQ " << name << " gain value: " << srcGain * 0.1f << " dB" << std::endl;
 	else if ((srcGain % 10) && enabled)
-		std::cerr << "LOSSY CONVERSION! Truncating EQ " << name << " gain fractional precision: " << srcGain * 0.1f << " dB" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Truncating EQ " << name << " gain fractional precision: " << srcGain * 0.1f << " dB" << std::endl;
 }
 
 static uint8_t ConvertPitchEnvLevel(uint8_t value)
@@ -131,17 +132,17 @@ static uint8_t ConvertPitchEnvLevel(uint8_t value)
 	return static_cast<uint8_t>(converted + 50);
 }
 
-static void ConvertToneVSTTo800(const ToneVST &tVST, Tone800 &t800)
+static void ConvertToneVSTTo800(const ToneVST &tVST, Tone800 &t800, ConversionContext &context)
 {
 	if (tVST.wg.gain != 3 && tVST.common.layerEnabled)
-		std::cerr << "LOSSY CONVERSION! Tone uses gain != 0 dB: " << ((static_cast<int>(tVST.wg.gain) - 3) * 6) << " dB" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Tone uses gain != 0 dB: " << ((static_cast<int>(tVST.wg.gain) - 3) * 6) << " dB" << std::endl;
 
 	t800.common.velocityCurve = tVST.common.velocityCurve;
 	t800.common.holdControl = tVST.common.holdControl;
 
 	if (tVST.lfo1.tempoSync && tVST.common.layerEnabled)
-		std::cerr << "LOSSY CONVERSION! Tone LFO1 uses tempo sync, approximating LFO rate @ 120 BPM" << std::endl;
-	t800.lfo1.rate = tVST.lfo1.tempoSync ? ApproximateLFORateWithTempoSync(tVST.lfo1.rateWithTempoSync) : tVST.lfo1.rate;
+		context.Warning() << "LOSSY CONVERSION! Tone LFO1 uses tempo sync, approximating LFO rate @ " << context.GetOptions().tempo << " BPM" << std::endl;
+	t800.lfo1.rate = tVST.lfo1.tempoSync ? ApproximateLFORateWithTempoSync(tVST.lfo1.rateWithTempoSync, context.GetOptions().tempo) : tVST.lfo1.rate;
 	t800.lfo1.delay = tVST.lfo1.delay;
 	t800.lfo1.fade = tVST.lfo1.fade + 50;
 	t800.lfo1.waveform = tVST.lfo1.waveform;
@@ -149,8 +150,8 @@ static void ConvertToneVSTTo800(const ToneVST &tVST, Tone800 &t800)
 	t800.lfo1.keyTrigger = tVST.lfo1.keyTrigger;
 
 	if (tVST.lfo2.tempoSync && tVST.common.layerEnabled)
-		std::cerr << "LOSSY CONVERSION! Tone LFO2 uses tempo sync, approximating LFO rate @ 120 BPM" << std::endl;
-	t800.lfo2.rate = tVST.lfo2.tempoSync ? ApproximateLFORateWithTempoSync(tVST.lfo2.rateWithTempoSync) : tVST.lfo2.rate;
+		context.Warning() << "LOSSY CONVERSION! Tone LFO2 uses tempo sync, approximating LFO rate @ " << context.GetOptions().tempo << " BPM" << std::endl;
+	t800.lfo2.rate = tVST.lfo2.tempoSync ? ApproximateLFORateWithTempoSync(tVST.lfo2.rateWithTempoSync, context.GetOptions().tempo) : tVST.lfo2.rate;
 	t800.lfo2.delay = tVST.lfo2.delay;
 	t800.lfo2.fade = tVST.lfo2.fade + 50;
 	t800.lfo2.waveform = tVST.lfo2.waveform;
@@ -194,13 +195,13 @@ static void ConvertToneVSTTo800(const ToneVST &tVST, Tone800 &t800)
 	{
 		t800.wg.pitchCoarse = 0;
 		if (tVST.common.layerEnabled)
-			std::cerr << "LOSSY CONVERSION! Tone coarse pitch too low (maybe due to waveform transposition)" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Tone coarse pitch too low (maybe due to waveform transposition)" << std::endl;
 	}
 	else if (t800.wg.pitchCoarse > 96)
 	{
 		t800.wg.pitchCoarse = 96;
 		if (tVST.common.layerEnabled)
-			std::cerr << "LOSSY CONVERSION! Tone coarse pitch too high (maybe due to waveform transposition)" << std::endl;
+			context.Warning() << "LOSSY CONVERSION! Tone coarse pitch too high (maybe due to waveform transposition)" << std::endl;
 	}
 
 	t800.pitchEnv.velo = tVST.pitchEnv.velo + 50;
@@ -254,11 +255,11 @@ static void ConvertToneVSTTo800(const ToneVST &tVST, Tone800 &t800)
 	t800.tvaEnv.time4 = tVST.tvaEnv.time4;
 }
 
-void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800)
+void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800, ConversionContext &context)
 {
 	if (pVST.zenHeader.modelID1 != 3 || pVST.zenHeader.modelID2 != 5)
 	{
-		std::cerr << "Skipping patch, appears to be for another synth model!" << std::endl;
+		context.Warning() << "Skipping patch, appears to be for another synth model!" << std::endl;
 		p800 = {};
 		p800.common.name.fill(' ');
 		return;
@@ -295,11 +296,11 @@ void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800)
 			p800.common.activeTone |= (1 << i);
 	}
 
-	ConvertEQBand(EQLowFreq, p800.eq.lowFreq, p800.eq.lowGain, pVST.eq.lowFreq, pVST.eq.lowGain, pVST.eq.eqEnabled, "low");
-	ConvertEQBand(EQMidFreq, p800.eq.midFreq, p800.eq.midGain, pVST.eq.midFreq, pVST.eq.midGain, pVST.eq.eqEnabled, "mid");
-	ConvertEQBand(EQHighFreq, p800.eq.highFreq, p800.eq.highGain, pVST.eq.highFreq, pVST.eq.highGain, pVST.eq.eqEnabled, "high");
+	ConvertEQBand(EQLowFreq, p800.eq.lowFreq, p800.eq.lowGain, pVST.eq.lowFreq, pVST.eq.lowGain, pVST.eq.eqEnabled, "low", context);
+	ConvertEQBand(EQMidFreq, p800.eq.midFreq, p800.eq.midGain, pVST.eq.midFreq, pVST.eq.midGain, pVST.eq.eqEnabled, "mid", context);
+	ConvertEQBand(EQHighFreq, p800.eq.highFreq, p800.eq.highGain, pVST.eq.highFreq, pVST.eq.highGain, pVST.eq.eqEnabled, "high", context);
 	if (!MapToArrayIndex(pVST.eq.midQ, EQMidQ, p800.eq.midQ) && pVST.eq.midGain != 0 && pVST.eq.eqEnabled)
-		std::cerr << "LOSSY CONVERSION! Unsupported EQ mid Q value: " << int(pVST.eq.midQ) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Unsupported EQ mid Q value: " << int(pVST.eq.midQ) << std::endl;
 
 	p800.midiTx.keyMode = 0;
 	p800.midiTx.splitPoint = 36;
@@ -311,9 +312,9 @@ void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800)
 	p800.midiTx.dummy = 0;
 
 	if (pVST.effectsGroupA.effectsLevelGroupA != 127 && pVST.effectsGroupA.groupAenabled)
-		std::cerr << "LOSSY CONVERSION! Effect Group A Level != 127: " << int(pVST.effectsGroupA.effectsLevelGroupA) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Effect Group A Level != 127: " << int(pVST.effectsGroupA.effectsLevelGroupA) << std::endl;
 	if (pVST.effectsGroupA.panningGroupA != 64 && pVST.effectsGroupA.groupAenabled)
-		std::cerr << "LOSSY CONVERSION! Effect Group A Pan != 64: " << int(pVST.effectsGroupA.panningGroupA) << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Effect Group A Pan != 64: " << int(pVST.effectsGroupA.panningGroupA) << std::endl;
 	p800.effect.groupAsequence = pVST.effectsGroupA.groupAsequence.lsb;
 	p800.effect.groupBsequence = pVST.effectsGroupB.groupBsequence;
 	
@@ -363,16 +364,16 @@ void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800)
 	p800.effect.enhancerMix = pVST.effectsGroupA.enhancerMix.lsb;
 
 	if (pVST.effectsGroupB.delayCenterTempoSync)
-		std::cerr << "LOSSY CONVERSION! Delay Effect Center Tap uses tempo sync, approximating delay @ 120 BPM" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Delay Effect Center Tap uses tempo sync, approximating delay @ " << context.GetOptions().tempo << " BPM" << std::endl;
 	if (pVST.effectsGroupB.delayLeftTempoSync)
-		std::cerr << "LOSSY CONVERSION! Delay Effect Left Tap uses tempo sync, approximating delay @ 120 BPM" << std::endl;
+		context.Warning() << "LOSSY CONVERSION! Delay Effect Left Tap uses tempo sync, approximating delay @ " << context.GetOptions().tempo << " BPM" << std::endl;
 	if (pVST.effectsGroupB.delayRightTempoSync)
-		std::cerr << "LOSSY CONVERSION! Delay Effect Right Tap uses tempo sync, approximating delay @ 120 BPM" << std::endl;
-	p800.effect.delayCenterTap = pVST.effectsGroupB.delayCenterTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayCenterTapWithSync) : pVST.effectsGroupB.delayCenterTap;
+		context.Warning() << "LOSSY CONVERSION! Delay Effect Right Tap uses tempo sync, approximating delay @ " << context.GetOptions().tempo << " BPM" << std::endl;
+	p800.effect.delayCenterTap = pVST.effectsGroupB.delayCenterTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayCenterTapWithSync, context.GetOptions().tempo) : pVST.effectsGroupB.delayCenterTap;
 	p800.effect.delayCenterLevel = pVST.effectsGroupB.delayCenterLevel;
-	p800.effect.delayLeftTap = pVST.effectsGroupB.delayLeftTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayLeftTapWithSync) : pVST.effectsGroupB.delayLeftTap;
+	p800.effect.delayLeftTap = pVST.effectsGroupB.delayLeftTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayLeftTapWithSync, context.GetOptions().tempo) : pVST.effectsGroupB.delayLeftTap;
 	p800.effect.delayLeftLevel = pVST.effectsGroupB.delayLeftLevel;
-	p800.effect.delayRightTap = pVST.effectsGroupB.delayRightTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayRightTapWithSync) : pVST.effectsGroupB.delayRightTap;
+	p800.effect.delayRightTap = pVST.effectsGroupB.delayRightTempoSync ? ApproximateDelayWithTempoSync(pVST.effectsGroupB.delayRightTapWithSync, context.GetOptions().tempo) : pVST.effectsGroupB.delayRightTap;
 	p800.effect.delayRightLevel = pVST.effectsGroupB.delayRightLevel;
 	p800.effect.delayFeedback = pVST.effectsGroupB.delayFeedback;
 
@@ -390,8 +391,8 @@ void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800)
 	p800.effect.reverbLevel = pVST.effectsGroupB.reverbLevel;
 	p800.effect.dummy = 0;
 
-	ConvertToneVSTTo800(pVST.tone[0], p800.toneA);
-	ConvertToneVSTTo800(pVST.tone[1], p800.toneB);
-	ConvertToneVSTTo800(pVST.tone[2], p800.toneC);
-	ConvertToneVSTTo800(pVST.tone[3], p800.toneD);
+	ConvertToneVSTTo800(pVST.tone[0], p800.toneA, context);
+	ConvertToneVSTTo800(pVST.tone[1], p800.toneB, context);
+	ConvertToneVSTTo800(pVST.tone[2], p800.toneC, context);
+	ConvertToneVSTTo800(pVST.tone[3], p800.toneD, context);
 }
@@ -0,0 +1,248 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "DirectoryWatcher.hpp"
+#include "PatchLibrary.hpp"
+#include "SyncManifest.hpp"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Changes are only converted once no further events have arrived for a moment, so that a file that is written in several steps
+	// is only converted once, and many files that are dropped into the directory at once are converted together by one batch.
+	constexpr auto DEBOUNCE_TIME = std::chrono::milliseconds{300};
+	// A continuous stream of events must not hold back the conversion forever, though.
+	constexpr auto MAX_DEBOUNCE_TIME = std::chrono::seconds{3};
+
+	// Key for changes that cannot be attributed to a single file, e.g. because the kernel's event queue overflowed
+	constexpr std::string_view UNKNOWN_CHANGE = "";
+
+	class InotifyWatcher
+	{
+	public:
+		InotifyWatcher(const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory)
+			: m_fd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+			, m_sourceDirectory{sourceDirectory}
+			, m_outputDirectory{outputDirectory}
+		{
+		}
+
+		~InotifyWatcher()
+		{
+			if (m_fd >= 0)
+				close(m_fd);
+		}
+
+		InotifyWatcher(const InotifyWatcher &) = delete;
+		InotifyWatcher &operator=(const InotifyWatcher &) = delete;
+
+		bool IsValid() const noexcept { return m_fd >= 0; }
+
+		// Watches the directory and all its subdirectories, except for the output directory so that the results of a conversion do not trigger another conversion.
+		// All patch files that are found are reported as changed, since they may have been moved into the source directory along with a new subdirectory.
+		bool AddDirectory(const std::string &relativePath, std::map<std::string, Clock::time_point, std::less<>> &changedFiles)
+		{
+			const std::filesystem::path directory = m_sourceDirectory / ToPath(relativePath);
+			std::error_code ec;
+			if (std::filesystem::equivalent(directory, m_outputDirectory, ec))
+				return true;
+			if (!AddWatch(directory, relativePath))
+				return false;
+
+			const auto now = Clock::now();
+			for (std::filesystem::recursive_directory_iterator it{directory, std::filesystem::directory_options::skip_permission_denied, ec}, end; it != end; it.increment(ec))
+			{
+				if (ec)
+					continue;
+				const std::u8string path = it->path().lexically_relative(m_sourceDirectory).generic_u8string();
+				if (it->is_directory(ec))
+				{
+					if (std::filesystem::equivalent(it->path(), m_outputDirectory, ec))
+						it.disable_recursion_pending();
+					else
+						AddWatch(it->path(), std::string{path.begin(), path.end()});
+				}
+				else if (!relativePath.empty() && IsLibraryFile(it->path()))
+				{
+					changedFiles[std::string{path.begin(), path.end()}] = now;
+				}
+			}
+			return true;
+		}
+
+		// Waits for events for at most the given time (or forever if the timeout is negative), and adds all patch files that were written, moved or deleted to the list.
+		// Returns false if the events could not be read.
+		bool ReadEvents(const int timeoutMilliseconds, std::map<std::string, Clock::time_point, std::less<>> &changedFiles)
+		{
+			pollfd pfd{m_fd, POLLIN, 0};
+			const int result = poll(&pfd, 1, timeoutMilliseconds);
+			if (result < 0)
+				return errno == EINTR;
+			if (result == 0)
+				return true;
+
+			alignas(inotify_event) std::array<char, 16384> buffer;
+			while (true)
+			{
+				const ssize_t size = read(m_fd, buffer.data(), buffer.size());
+				if (size < 0)
+					return errno == EAGAIN || errno == EINTR;
+				if (size == 0)
+					return true;
+
+				const auto now = Clock::now();
+				for (const char *ptr = buffer.data(); ptr < buffer.data() + size; )
+				{
+					const inotify_event &event = *reinterpret_cast<const inotify_event *>(ptr);
+					ptr += sizeof(inotify_event) + event.len;
+
+					if (event.mask & IN_Q_OVERFLOW)
+					{
+						// Some events were lost, so new subdirectories may have to be watched as well
+						AddDirectory({}, changedFiles);
+						changedFiles[std::string{UNKNOWN_CHANGE}] = now;
+						continue;
+					}
+					const auto directory = m_directories.find(event.wd);
+					if (directory == m_directories.end())
+						continue;
+					if (event.mask & IN_IGNORED)
+					{
+						m_directories.erase(directory);
+						continue;
+					}
+					if (!event.len)
+						continue;
+
+					std::string relativePath = directory->second;
+					if (!relativePath.empty())
+						relativePath += '/';
+					relativePath += event.name;
+					if (event.mask & IN_ISDIR)
+					{
+						if (event.mask & (IN_CREATE | IN_MOVED_TO))
+							AddDirectory(relativePath, changedFiles);
+						else
+							changedFiles[relativePath] = now;  // The outputs of all files in the removed directory have to be deleted
+					}
+					else if (!(event.mask & IN_CREATE) && IsLibraryFile(ToPath(event.name)))
+					{
+						// Newly created files are only converted once they have been written completely
+						changedFiles[relativePath] = now;
+					}
+				}
+			}
+		}
+
+	private:
+		static std::filesystem::path ToPath(const std::string_view str)
+		{
+			return std::filesystem::path{std::u8string{str.begin(), str.end()}};
+		}
+
+		bool AddWatch(const std::filesystem::path &directory, const std::string &relativePath)
+		{
+			// Files are only reported once they have been closed after writing, so that partially written files are not converted
+			const int wd = inotify_add_watch(m_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_ONLYDIR);
+			if (wd < 0)
+				return false;
+			m_directories[wd] = relativePath;
+			return true;
+		}
+
+		const int m_fd;
+		const std::filesystem::path m_sourceDirectory, m_outputDirectory;
+		std::unordered_map<int, std::string> m_directories;  // Watch descriptor -> path relative to the source directory
+	};
+}
+
+int RunWatch(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats)
+{
+	// Start watching before the initial synchronization, so that no changes are missed in the meantime
+	std::map<std::string, Clock::time_point, std::less<>> changedFiles;
+	InotifyWatcher watcher{sourceDirectory, outputDirectory};
+	if (!watcher.IsValid() || !watcher.AddDirectory({}, changedFiles))
+	{
+		std::cout << "Could not watch directory " << sourceDirectory.string() << "!" << std::endl;
+		return 2;
+	}
+
+	SyncResult result;
+	if (!SyncDirectory(codecs, sourceDirectory, outputDirectory, printStats, result))
+		return 2;
+	std::cout << "Watching " << sourceDirectory.string() << " for changes..." << std::endl;
+
+	Clock::time_point firstChange;
+	while (true)
+	{
+		int timeout = -1;
+		if (!changedFiles.empty())
+		{
+			const auto lastChange = std::max_element(changedFiles.begin(), changedFiles.end(), [](const auto &l, const auto &r) { return l.second < r.second; })->second;
+			const auto deadline = std::min(lastChange + DEBOUNCE_TIME, firstChange + MAX_DEBOUNCE_TIME);
+			const auto now = Clock::now();
+			if (now >= deadline)
+			{
+				result = {};
+				SyncDirectory(codecs, sourceDirectory, outputDirectory, printStats, result);
+				// Time from noticing the last change of a file until all of its output files have been written
+				const auto finished = Clock::now();
+				std::chrono::milliseconds minLatency = std::chrono::milliseconds::max(), maxLatency{0};
+				size_t numFiles = 0;
+				for (const std::string &file : result.convertedFiles)
+				{
+					if (const auto change = changedFiles.find(file); change != changedFiles.end())
+					{
+						const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(finished - change->second);
+						minLatency = std::min(minLatency, latency);
+						maxLatency = std::max(maxLatency, latency);
+						numFiles++;
+					}
+				}
+				if (numFiles == 1)
+					std::cout << "Latency: " << maxLatency.count() << " ms" << std::endl;
+				else if (numFiles > 1)
+					std::cout << "Latency: " << minLatency.count() << " - " << maxLatency.count() << " ms for " << numFiles << " files" << std::endl;
+				changedFiles.clear();
+				continue;
+			}
+			timeout = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count());
+		}
+
+		const bool hadChanges = !changedFiles.empty();
+		if (!watcher.ReadEvents(timeout, changedFiles))
+		{
+			std::cout << "Could not watch directory " << sourceDirectory.string() << "!" << std::endl;
+			return 2;
+		}
+		if (!hadChanges && !changedFiles.empty())
+			firstChange = Clock::now();
+	}
+}
+
+#else
+
+int RunWatch(std::span<const FileCodec *const>, const std::filesystem::path &, const std::filesystem::path &, const bool)
+{
+	std::cout << "Watching directories is only supported on Linux!" << std::endl;
+	return 2;
+}
+
+#endif
@@ -0,0 +1,14 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+struct FileCodec;
+
+// Synchronizes the output directory with the source directory like the sync verb, and then keeps doing so whenever files in the source directory are added, modified or removed.
+// Only returns (with the process exit code) if the source directory cannot be watched.
+int RunWatch(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats);
@@ -0,0 +1,169 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "InputArchive.hpp"
+#include "PatchLibrary.hpp"
+#include "StandardStreams.hpp"
+#include "Utils.hpp"
+
+#include "miniz.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+	// Returns the position of the ':' separating archive and member name, or the size of the filename if no member is specified.
+	// Returns std::string::npos if the filename does not refer to a ZIP archive.
+	size_t FindArchiveSeparator(const std::string &filename)
+	{
+		std::string lowerName = filename;
+		std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+		if (const auto pos = lowerName.find(".zip:"); pos != std::string::npos)
+			return pos + 4;
+		if (lowerName.ends_with(".zip"))
+			return lowerName.size();
+		return std::string::npos;
+	}
+
+	class ZipReader
+	{
+	public:
+		ZipReader(const std::vector<char> &data)
+		{
+			m_valid = mz_zip_reader_init_mem(&m_zip, data.data(), data.size(), 0);
+		}
+
+		~ZipReader()
+		{
+			if (m_valid)
+				mz_zip_reader_end(&m_zip);
+		}
+
+		ZipReader(const ZipReader &) = delete;
+		ZipReader &operator=(const ZipReader &) = delete;
+
+		bool IsValid() const { return m_valid; }
+		mz_zip_archive &operator*() { return m_zip; }
+
+	private:
+		mz_zip_archive m_zip{};
+		bool m_valid = false;
+	};
+
+	struct ArchiveMember
+	{
+		mz_uint fileIndex;
+		std::string name;
+		std::string data;
+		bool extracted = false;
+	};
+}
+
+std::vector<InputSource> OpenInputSources(const std::string &filename)
+{
+	std::vector<InputSource> sources;
+	if (IsStandardStream(filename))
+	{
+		sources.push_back({ "<stdin>", OpenStandardInput() });
+		return sources;
+	}
+
+	const size_t separator = FindArchiveSeparator(filename);
+	if (separator == std::string::npos)
+	{
+		auto inFile = std::make_unique<std::ifstream>(filename, std::ios::binary);
+		if (!*inFile)
+		{
+			std::cout << "Could not open " << filename << " for reading!" << std::endl;
+			return {};
+		}
+		sources.push_back({ filename, std::move(inFile) });
+		return sources;
+	}
+
+	const std::string archiveName = filename.substr(0, separator);
+	const std::string memberName = (separator < filename.size()) ? filename.substr(separator + 1) : std::string{};
+	std::vector<char> archiveData;
+	if (std::ifstream inFile{archiveName, std::ios::binary | std::ios::ate}; inFile)
+	{
+		const auto size = inFile.tellg();
+		inFile.seekg(0);
+		ReadVector(inFile, archiveData, static_cast<size_t>(size));
+	}
+
+	ZipReader zip{archiveData};
+	if (archiveData.empty() || !zip.IsValid())
+	{
+		std::cout << "Could not open " << archiveName << " as a ZIP archive!" << std::endl;
+		return {};
+	}
+
+	std::vector<ArchiveMember> members;
+	const mz_uint numFiles = mz_zip_reader_get_num_files(&*zip);
+	for (mz_uint i = 0; i < numFiles; i++)
+	{
+		mz_zip_archive_file_stat stat{};
+		if (!mz_zip_reader_file_stat(&*zip, i, &stat) || stat.m_is_directory)
+			continue;
+		if (memberName.empty() ? IsLibraryFile(std::filesystem::path{stat.m_filename}) : (memberName == stat.m_filename))
+			members.push_back({ i, stat.m_filename, {} });
+	}
+	if (members.empty())
+	{
+		if (memberName.empty())
+			std::cout << "No patch files found in " << archiveName << "!" << std::endl;
+		else
+			std::cout << "Could not find " << memberName << " in " << archiveName << "!" << std::endl;
+		return {};
+	}
+
+	// Each thread needs its own reader state, but they all share the archive in memory
+	std::atomic<size_t> nextMember = 0;
+	const auto extractMembers = [&]()
+	{
+		ZipReader threadZip{archiveData};
+		if (!threadZip.IsValid())
+			return;
+		for (size_t i = nextMember++; i < members.size(); i = nextMember++)
+		{
+			ArchiveMember &member = members[i];
+			size_t size = 0;
+			if (void *data = mz_zip_reader_extract_to_heap(&*threadZip, member.fileIndex, &size, 0))
+			{
+				member.data.assign(static_cast<const char *>(data), size);
+				member.extracted = true;
+				mz_free(data);
+			}
+		}
+	};
+	const size_t numThreads = std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), members.size());
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < numThreads; i++)
+	{
+		threads.emplace_back(extractMembers);
+	}
+	extractMembers();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	for (auto &member : members)
+	{
+		if (!member.extracted)
+		{
+			std::cout << "Could not extract " << member.name << " from " << archiveName << "!" << std::endl;
+			return {};
+		}
+		sources.push_back({ archiveName + ":" + member.name, std::make_unique<std::istringstream>(std::move(member.data)) });
+	}
+	return sources;
+}
@@ -0,0 +1,23 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A file on disk, or a member of a ZIP archive that has been inflated into memory
+struct InputSource
+{
+	std::string name;  // Filename, or "archive.zip:path/inside.syx" for archive members
+	std::unique_ptr<std::istream> stream;
+};
+
+// Opens an input file for reading. Besides regular files, the filename can refer to a ZIP archive ("archive.zip"),
+// in which case all members with a supported file extension are returned, or to a single archive member ("archive.zip:path/inside.syx").
+// "-" reads from standard input.
+// Archive members are inflated in parallel. Prints an error message and returns an empty list if the file cannot be read.
+std::vector<InputSource> OpenInputSources(const std::string &filename);
@@ -5,8 +5,9 @@
 #include "InputFile.hpp"
 #include "Utils.hpp"
 
-InputFile::InputFile(std::istream &file)
+InputFile::InputFile(std::istream &file, std::ostream &warnings)
 	: m_file{file}
+	, m_warnings{warnings}
 {
 	std::array<char, 4> magic{};
 	Read(m_file, magic);
@@ -60,17 +61,17 @@ std::vector<uint8_t> InputFile::NextSysExMessage()
 {
 	if (m_type == Type::MID)
 	{
-		while (!m_file.eof())
+		while (m_file)
 		{
 			if (!m_trackBytesRemain)
 			{
 				std::array<char, 4> magic{};
 				Read(m_file, magic);
-				if (m_file.eof())
+				if (!m_file)
 					return {};
 				if (!CompareMagic(magic, "MTrk"))
 				{
-					std::cerr << "Malformed MIDI file? Unexpected track header value" << std::endl;
+					m_warnings << "Malformed MIDI file? Unexpected track header value" << std::endl;
 					return {};
 				}
 				m_trackBytesRemain = ReadUint32BE();
@@ -122,7 +123,7 @@ std::vector<uint8_t> InputFile::NextSysExMessage()
 					m_trackBytesRemain -= sysExLength;
 					if (!message.empty() && message.back() != 0xF7)
 					{
-						std::cerr << "NOT IMPLEMENTED: Continued SysEx message" << std::endl;
+						m_warnings << "NOT IMPLEMENTED: Continued SysEx message" << std::endl;
 					}
 					return message;
 				}
@@ -140,17 +141,17 @@ std::vector<uint8_t> InputFile::NextSysExMessage()
 	}
 	else if (m_type == Type::SYX)
 	{
-		if (m_file.eof())
+		if (!m_file)
 			return {};
 
 		uint8_t ch = 0;
-		while (!m_file.eof() && ch != 0xF0)
+		while (m_file && ch != 0xF0)
 		{
 			ch = ReadUint8();
 		}
 		
 		std::vector<uint8_t> message;
-		while (!m_file.eof() && ch != 0xF7)
+		while (m_file && ch != 0xF7)
 		{
 			ch = ReadUint8();
 			message.push_back(ch);
@@ -165,7 +166,7 @@ uint32_t InputFile::ReadVarInt()
 	uint8_t b = ReadUint8();
 	uint32_t value = (b & 0x7F);
 
-	while (!m_file.eof() && (b & 0x80) != 0)
+	while (m_file && (b & 0x80) != 0)
 	{
 		b = ReadUint8();
 		value <<= 7;
@@ -20,7 +20,8 @@ public:
 		SVD,
 	};
 
-	InputFile(std::istream &file);
+	// Malformed MIDI files are reported on the warnings stream
+	InputFile(std::istream &file, std::ostream &warnings);
 
 	std::vector<uint8_t> NextSysExMessage();
 
@@ -34,6 +35,7 @@ private:
 	void Skip(uint32_t bytes);
 
 	std::istream &m_file;
+	std::ostream &m_warnings;
 	Type m_type = Type::SYX;
 	uint32_t m_trackBytesRemain = 0;
 	uint8_t m_lastCommand = 0;
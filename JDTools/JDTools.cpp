@@ -3,8 +3,28 @@
 // License: BSD 3-clause
 
 #include "JDTools.hpp"
+#include "BatchConverter.hpp"
+#include "Codecs.hpp"
+#include "ConversionContext.hpp"
+#include "ConversionPlan.hpp"
+#include "DirectoryWatcher.hpp"
+#include "InputArchive.hpp"
 #include "InputFile.hpp"
+#include "MidiFileWriter.hpp"
+#include "OutputArchive.hpp"
+#include "PatchDiff.hpp"
+#include "PatchFeatures.hpp"
+#include "PatchFingerprint.hpp"
+#include "PatchIndex.hpp"
+#include "PatchQuery.hpp"
+#include "SelfTest.hpp"
+#include "StandardStreams.hpp"
 #include "SVZ.hpp"
+#include "SyncManifest.hpp"
+#include "SysExImage.hpp"
+#include "SysExReceiver.hpp"
+#include "SysExTransfer.hpp"
+#include "SysExAddresses.hpp"
 #include "Utils.hpp"
 
 #include "JD-800.hpp"
@@ -12,39 +32,24 @@
 #include "JD-08.hpp"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace
 {
-	constexpr uint8_t SYSEX_DEVICE_ID = 0x10;
-	constexpr uint8_t UNDEFINED_MEMORY = 0xFE;
-
-	constexpr uint32_t BASE_ADDR_800_PATCH_TEMPORARY = (0x00 << 14);
-	constexpr uint32_t BASE_ADDR_800_SETUP_TEMPORARY = (0x01 << 14);
-	constexpr uint32_t BASE_ADDR_800_SYSTEM = (0x02 << 14);
-	constexpr uint32_t BASE_ADDR_800_PART = (0x03 << 14);
-	constexpr uint32_t BASE_ADDR_800_SETUP_INTERNAL = (0x04 << 14);
-	constexpr uint32_t BASE_ADDR_800_PATCH_INTERNAL = (0x05 << 14);
-	constexpr uint32_t BASE_ADDR_800_DISPLAY = (0x07 << 14);
-	
-	constexpr uint32_t BASE_ADDR_990_SYSTEM = (0x00 << 21);
-	constexpr uint32_t BASE_ADDR_990_PERFORMANCE_TEMPORARY = (0x01 << 21);
-	constexpr uint32_t BASE_ADDR_990_PERFORMANCE_PATCHES_TEMPORARY = (0x02 << 21);
-	constexpr uint32_t BASE_ADDR_990_PATCH_TEMPORARY = (0x03 << 21);
-	constexpr uint32_t BASE_ADDR_990_SETUP_TEMPORARY = (0x04 << 21);
-	constexpr uint32_t BASE_ADDR_990_PERFORMANCE_INTERNAL = (0x05 << 21);
-	constexpr uint32_t BASE_ADDR_990_PATCH_INTERNAL = (0x06 << 21);
-	constexpr uint32_t BASE_ADDR_990_SETUP_INTERNAL = (0x07 << 21);
-	constexpr uint32_t BASE_ADDR_990_SYSTEM_CARD = (0x08 << 21);
-	constexpr uint32_t BASE_ADDR_990_PERFORMANCE_CARD = (0x09 << 21);
-	constexpr uint32_t BASE_ADDR_990_PATCH_CARD = (0x0A << 21);
-	constexpr uint32_t BASE_ADDR_990_SETUP_CARD = (0x0B << 21);
-
 	constexpr std::array<uint8_t, sizeof(Patch800)> DEFAULT_PATCH_800 =
 	{
 		0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
@@ -72,6 +77,30 @@ namespace
 		0x32, 0x00, 0x32, 0x32, 0x32, 0x32, 0x0A, 0x00, 0x64, 0x32, 0x64, 0x32, 0x64, 0x32, 0x00, 0x00,
 		0x3C, 0x0A, 0x50, 0x32, 0x01, 0x32, 0x32, 0x32, 0x0A, 0x00, 0x64, 0x32, 0x64, 0x32, 0x64, 0x32,
 	};
+
+	// Results of the conversion, one list per patch format
+	struct ConvertedPatches
+	{
+		std::vector<Patch800> p800;
+		std::vector<Patch990> p990;
+		std::vector<PatchVST> pVST;
+
+		template<typename TPatch>
+		std::vector<TPatch> &Get()
+		{
+			if constexpr (std::is_same_v<TPatch, Patch800>)
+				return p800;
+			else if constexpr (std::is_same_v<TPatch, Patch990>)
+				return p990;
+			else
+				return pVST;
+		}
+	};
+}
+
+const Patch800 &GetDefaultPatch800()
+{
+	return reinterpret_cast<const Patch800 &>(DEFAULT_PATCH_800);
 }
 
 static void PrintUsage()
@@ -81,12 +110,21 @@ R"(JDTools - Patch conversion utility for Roland JD-800 / JD-990
 
 Usage:
 
-JDTools convert syx <input> <output>
+JDTools convert syx <input> <output> --to <jd800|jd990>
   Converts from JD-800 SysEx dump (SYX / MID), JD-990 SysEx dump (SYX / MID),
   JD-800 VST BIN, JD-08 SVD or ZC1 SVZ file
   to JD-800 or JD-990 SysEx dump (SYX).
-  Output is a JD-990 SysEx dump if the source file was a JD-800 SysEx dump,
-  otherwise it is always a JD-800 SysEx dump.
+  The --to parameter is optional and selects the target device. By default,
+  output is a JD-990 SysEx dump if the source file was a JD-800 SysEx dump,
+  otherwise it is a JD-800 SysEx dump.
+
+JDTools convert mid <input> <output> --to <jd800|jd990> --timing <t,b,s>
+  Same as above, but writes a Standard MIDI File (MID) that can be played back
+  to the device with a sequencer. The SysEx messages are spaced as closely as
+  the MIDI transfer rate and the device's processing time allow.
+  The --timing parameter is optional and overrides the device's processing
+  time model: t = milliseconds per message, b = additional milliseconds per
+  byte, s = size of the receive buffer in bytes (e.g. 50,0,300).
 
 JDTools convert bin <input> <output>
   Converts from JD-800 SysEx dump (SYX / MID), JD-990 SysEx dump (SYX / MID),
@@ -104,9 +142,26 @@ JDTools convert svz <input> <output>
   Converts from JD-800 SysEx dump (SYX / MID), JD-990 SysEx dump (SYX / MID),
   JD-800 VST BIN or JD-08 SVD file to ZC1 SVZ file.
 
+  Several output formats can be combined, e.g. convert bin,svz,syx <input>
+  <output>. Each patch is converted only once, and all output files are written
+  in parallel. The output name is extended by each format's extension, e.g.
+  output.bin, output.svz and output.syx.
+
+  Add --stats to print statistics about the conversion, e.g. how many tones
+  could be taken from the tone cache instead of being converted again.
+
+  Add --tempo <bpm> to set the tempo at which tempo-synced LFO rates and delay
+  taps of JD-800 VST patches are approximated in SysEx output (default: 120).
+  Add --strict to stop without writing any output if any information would be
+  lost in the conversion.
+
+  All conversions can be combined with --zip <output.zip> to write all output
+  files (including additional banks and special setups) and a diagnostics
+  report into a single ZIP archive instead.
+
 JDTools merge <input1.syx> <input2.syx> <input3.syx> ... <output.syx>
   Merges SYX or MID files containing temporary patches for either JD-800 or
-  JD-990 into banks
+  JD-990 into banks. Can be combined with --zip <output.zip> as well.
 
 JDTools list <input.syx>
   Lists all SysEx / BIN / SVD / SVZ contents
@@ -116,78 +171,164 @@ JDTools list-verbose <input.syx>
 
 JDTools verify <input1.syx> <input2.syx> <input3.syx> ...
   Verifies checksum of SySex dumps without doing any conversion
+
+JDTools diff <input1> <input2>
+  Compares the patches of two SysEx / BIN / SVD / SVZ files slot by slot and
+  lists all parameters that differ
+
+JDTools receive <bin|svz> <input> <output>
+  Reads JD-800 or JD-990 SysEx data while it is being received, e.g. from a
+  FIFO that a MIDI interface is recorded into, or from standard input (-).
+  Each time a patch has been received completely, it is converted and the
+  JD-800 VST BIN or ZC1 SVZ output file is updated.
+
+JDTools delta <current.syx> <desired.syx> <output.syx> --timing <t,b,s>
+  Writes only the SysEx messages that are needed to turn the state of a
+  device that was dumped to current.syx into the state in desired.syx, e.g.
+  to send a few edited patches without transferring the whole bank again.
+  Both files can be SYX or MID files. If the output filename ends in .mid, a
+  Standard MIDI File is written. The --timing parameter is optional, see
+  convert mid.
+
+JDTools compact <input.syx> <output.syx> --timing <t,b,s>
+  Rewrites a SysEx dump that consists of many small messages (e.g. one per
+  parameter) with as few messages as possible, which can be sent to the
+  device much faster. Input and output can be SYX or MID files, like with
+  the delta verb. Data that is sent several times is only kept with its last
+  value, so of several temporary patches in the input, only the last one
+  remains. Use merge to keep all of them.
+
+JDTools batch <bin|svz> <output directory> <input1> <input2> ...
+  Converts each input file into its own JD-800 VST BIN or ZC1 SVZ file in the
+  output directory. Inputs can also be directories, in which case all SysEx /
+  BIN / SVD / SVZ files in them and their subdirectories are converted, and
+  the directory structure is recreated in the output directory. Both formats
+  can be written at once with bin,svz. Files are read, converted and written
+  in parallel. Add --stats to print how busy each stage of the conversion was.
+
+JDTools sync <bin|svz> <source directory> <output directory>
+  Like batch, but only converts files that were added or modified since the
+  last run, and deletes the output files of input files that were removed.
+  Which outputs belong to which input is recorded in JDTools.sync in the
+  output directory.
+
+JDTools watch <bin|svz> <source directory> <output directory>
+  Like sync, but keeps running and converts files as soon as they are added
+  to or modified in the source directory (Linux only). Changes that happen
+  within a short time are converted together.
+
+JDTools index <directory> <index file>
+  Scans the directory and all its subdirectories for SysEx / BIN / SVD / SVZ
+  files and stores a list of all patches found in an index file.
+  Only files that changed since the index was last updated are read again.
+  The index file is optional and defaults to JDTools.idx in the directory.
+
+JDTools query <index file> <term1> <term2> ...
+  Lists all patches in an index file that match all of the given terms:
+  name=<text>      Patch name starts with the text (case-insensitive)
+  contains=<text>  Patch name contains the text (case-insensitive)
+  waveform=<n>     Patch uses internal waveform number n
+  card             Patch uses waveforms from a waveform card
+  lossy=<target>   Patch cannot be converted to jd800, jd990 or vst without
+                   losing information
+
+JDTools similar <index file> <input> <patch> <count>
+  Lists the patches in an index file that sound most similar to the given
+  patch (e.g. I11 or A11) from the input file.
+  The number of listed patches is optional and defaults to 10.
+
+JDTools dedupe <directory>
+  Scans the directory and all its subdirectories for SysEx / BIN / SVD / SVZ
+  files and lists all groups of patches that sound identical, regardless of
+  their name, position and format.
+
+JDTools selftest <number of patches> <seed>
+  Converts a generated set of JD-800 patches through all supported formats and
+  back, checks if the results match and reports the conversion speed.
+  Both parameters are optional.
+
+Wherever an input file is expected, a ZIP archive can be specified instead.
+All SysEx / BIN / SVD / SVZ files in the archive are read as if they had been
+specified individually. A single file inside the archive can be selected with
+<archive.zip>:<path/inside/archive.syx>.
+
+Specify - instead of a filename to read from standard input or write to
+standard output. Messages are then printed to standard error. For SVD output,
+the original JD-08 backup file is read from standard input.
 )" << std::endl;
 }
 
-static void WriteSysEx(std::ostream &f, uint32_t outAddress, const bool isJD990, const uint8_t *data, size_t size)
+template<typename T>
+static bool ParseNumber(const std::string_view str, T &value)
 {
-	// debug stuff
-	for (size_t i = 0; i < size; i++)
-	{
-		if (data[i] >= 0x80)
-		{
-			std::cerr << "invalid byte in SysEx data block at " << i << " - either broken parameter conversion or broken SysEx source!" << std::endl;
-		}
-	}
+	const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+	return ec == std::errc{} && ptr == str.data() + str.size();
+}
 
-	std::vector<uint8_t> outMessage;
-	size_t offset = 0;
-	while (size)
-	{
-		const size_t amountToCopy = std::min(size, size_t(256));
-		if (isJD990)
-			outMessage.assign({ 0xF0, 0x41, SYSEX_DEVICE_ID, 0x57, 0x12, static_cast<uint8_t>((outAddress >> 21) & 0x7F), static_cast<uint8_t>((outAddress >> 14) & 0x7F), static_cast<uint8_t>((outAddress >> 7) & 0x7F), static_cast<uint8_t>(outAddress & 0x7F) });
-		else
-			outMessage.assign({ 0xF0, 0x41, SYSEX_DEVICE_ID, 0x3D, 0x12, static_cast<uint8_t>((outAddress >> 14) & 0x7F), static_cast<uint8_t>((outAddress >> 7) & 0x7F), static_cast<uint8_t>(outAddress & 0x7F) });
-		outMessage.insert(outMessage.end(), data + offset, data + offset + amountToCopy);
-		uint8_t checksum = 0;
-		for (size_t i = 5; i < outMessage.size(); i++)
-		{
-			checksum += outMessage[i];
-		}
-		checksum = (~checksum + 1) & 0x7F;
-		outMessage.push_back(checksum);
-		outMessage.push_back(0xF7);
-		WriteVector(f, outMessage);
+template<typename T>
+static void WriteSysEx(std::ostream &f, uint32_t outAddress, const bool isJD990, const T &object)
+{
+	WriteSysEx(f, outAddress, isJD990, reinterpret_cast<const uint8_t *>(&object), sizeof(object));
+}
 
-		outAddress += static_cast<uint32_t>(amountToCopy);
-		size -= amountToCopy;
-		offset += amountToCopy;
+// Writes the converted patches that belong to one bank as SysEx messages
+template<typename TPatch>
+static void WriteSysExBank(std::ostream &f, const std::vector<TPatch> &patches, const std::vector<bool> &patchPresent, const uint32_t firstPatch, const uint32_t bankSize)
+{
+	using Codec = PatchCodec<TPatch>;
+	const uint32_t endPatch = std::min(firstPatch + bankSize, static_cast<uint32_t>(patches.size()));
+	for (uint32_t sourcePatch = firstPatch; sourcePatch < endPatch; sourcePatch++)
+	{
+		if (patchPresent[sourcePatch])
+			WriteSysEx(f, Codec::GetInternalAddress(sourcePatch - firstPatch), Codec::isJD990, patches[sourcePatch]);
 	}
 }
 
-template<typename T>
-static void WriteSysEx(std::ofstream &f, uint32_t outAddress, const bool isJD990, const T &object)
+// Returns the list of patch records to write to the SVD file, referencing either the newly converted patches or the original file's patch records
+static std::vector<const SVDPatchRecord *> MergePatchesIntoSVD(const std::vector<SVDPatchRecord> &patches, const std::vector<const SVDPatchRecord *> &sourceFile, const size_t offset)
 {
-	WriteSysEx(f, outAddress, isJD990, reinterpret_cast<const uint8_t *>(&object), sizeof(object));
+	std::vector<const SVDPatchRecord *> merged{sourceFile.begin(), sourceFile.begin() + std::min(sourceFile.size(), offset)};
+	for (const auto &patch : patches)
+		merged.push_back(&patch);
+	if (merged.size() < sourceFile.size())
+		merged.insert(merged.end(), sourceFile.begin() + merged.size(), sourceFile.end());
+	else if (merged.size() > 256)
+		merged.resize(256);
+	return merged;
 }
 
-static std::vector<PatchVST> MergePatchesIntoSVD(std::vector<PatchVST> patches, const std::vector<PatchVST> &sourceFile, const size_t offset)
+static std::vector<SVDPatchRecord> MakeSVDPatchRecords(const std::vector<PatchVST> &patches)
 {
-	patches.insert(patches.begin(), sourceFile.begin(), sourceFile.begin() + std::min(sourceFile.size(), offset));
-	if (patches.size() < sourceFile.size())
-		patches.insert(patches.end(), sourceFile.begin() + patches.size(), sourceFile.end());
-	else if (patches.size() > 256)
-		patches.resize(256);
-	return patches;
+	std::vector<SVDPatchRecord> records;
+	records.reserve(patches.size());
+	for (const auto &patch : patches)
+		records.push_back(MakeSVDPatchRecord(patch));
+	return records;
 }
 
-static std::string GetPatchIndex(const uint32_t patch, const uint32_t numPatches, const bool isCard = false)
+
+// Replaces patches for other synth models by the default patch, and disables effect group A if it uses an MFX other than JD Multi
+void FixVSTPatch(PatchVST &pVST, const bool checkModel, const bool fixMFX, const std::string_view patchIndex, const bool printWarnings, ConversionContext &context)
 {
-	std::string patchIndex;
-	if (isCard)
-		patchIndex = 'C';
-	else if (numPatches <= 64)
-		patchIndex = 'I';
-	else
-		patchIndex = 'A' + static_cast<char>(patch / 64u);
-	patchIndex += '1' + ((patch / 8u) % 8u);
-	patchIndex += '1' + (patch % 8u);
-	return patchIndex;
+	if (checkModel && (pVST.zenHeader.modelID1 != 3 || pVST.zenHeader.modelID2 != 5))
+	{
+		if (printWarnings)
+			context.Warning() << "Ignoring patch " << patchIndex << ", appears to be for another synth model!" << std::endl;
+		Reconstruct(pVST);
+		ConvertPatch800ToVST(reinterpret_cast<const Patch800 &>(DEFAULT_PATCH_800), pVST, context);
+	}
+	if (fixMFX && pVST.effectsGroupA.mfxType != 93)
+	{
+		// Patch didn't use JD Multi effect - disable effect group A.
+		if (pVST.effectsGroupA.mfxType != 0 && printWarnings)
+			context.Warning() << "Warning, patch " << patchIndex << " uses an MFX other than JD Multi - disabling effect group A" << std::endl;
+		pVST.effectsGroupA.mfxType = 93;
+		pVST.effectsGroupA.groupAenabled = 0;
+	}
 }
 
 
-int main(const int argc, char *argv[])
+int main(int argc, char *argv[])
 {
 	static_assert(sizeof(Patch800) == 384);
 	static_assert(sizeof(Patch990) == 486);
@@ -195,6 +336,140 @@ int main(const int argc, char *argv[])
 	static_assert(sizeof(SpecialSetup800) == 5378);
 	static_assert(sizeof(SpecialSetup990) == 6524);
 
+	if (argc >= 2 && argc <= 4 && std::string_view{argv[1]} == "selftest")
+	{
+		uint32_t numPatches = 10000, seed = 1;
+		if ((argc >= 3 && !ParseNumber(argv[2], numPatches)) || (argc >= 4 && !ParseNumber(argv[3], seed)))
+		{
+			PrintUsage();
+			return 2;
+		}
+		return RunSelfTest(numPatches, seed);
+	}
+	if ((argc == 3 || argc == 4) && std::string_view{argv[1]} == "index")
+	{
+		const std::string indexFilename = (argc == 4) ? std::string{argv[3]} : (std::filesystem::path{argv[2]} / "JDTools.idx").string();
+		return RunIndex(argv[2], indexFilename);
+	}
+	if (argc >= 4 && std::string_view{argv[1]} == "query")
+	{
+		return RunQuery(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+	}
+	if ((argc == 5 || argc == 6) && std::string_view{argv[1]} == "similar")
+	{
+		size_t count = 10;
+		if (argc == 6 && !ParseNumber(argv[5], count))
+		{
+			PrintUsage();
+			return 2;
+		}
+		return RunSimilar(argv[2], argv[3], argv[4], count);
+	}
+	if (argc == 4 && std::string_view{argv[1]} == "diff")
+	{
+		return RunDiff(argv[2], argv[3]);
+	}
+	if (argc == 3 && std::string_view{argv[1]} == "dedupe")
+	{
+		return RunDedupe(argv[2]);
+	}
+	if (argc == 5 && std::string_view{argv[1]} == "receive")
+	{
+		const FileCodec *codec = FindFileCodec(argv[2]);
+		if (codec && codec->writeBank)
+			return RunReceive(*codec, argv[3], argv[4]);
+		PrintUsage();
+		return 1;
+	}
+
+	// Optional parameters, may appear anywhere after the verb
+	const auto takeOption = [&argc, argv](const std::string_view name)
+	{
+		for (int i = 2; i < argc - 1; i++)
+		{
+			if (std::string_view{argv[i]} == name)
+			{
+				const std::string_view value = argv[i + 1];
+				std::copy(argv + i + 2, argv + argc, argv + i);
+				argc -= 2;
+				return value;
+			}
+		}
+		return std::string_view{};
+	};
+	const auto takeFlag = [&argc, argv](const std::string_view name)
+	{
+		for (int i = 2; i < argc; i++)
+		{
+			if (std::string_view{argv[i]} == name)
+			{
+				std::copy(argv + i + 1, argv + argc, argv + i);
+				argc--;
+				return true;
+			}
+		}
+		return false;
+	};
+	// Target device for SysEx output
+	const std::string_view sysExTarget = takeOption("--to");
+	// Write all output files into this ZIP archive instead
+	const std::string_view outArchiveFilename = takeOption("--zip");
+	// Processing time model of the target device for MIDI file output
+	const std::string_view sysExTimingStr = takeOption("--timing");
+	// Print statistics about the conversion process
+	const bool printStats = takeFlag("--stats");
+	// Tempo at which tempo-synced VST parameters are approximated
+	const std::string_view tempoStr = takeOption("--tempo");
+	// Do not write any output if information would be lost
+	const bool strict = takeFlag("--strict");
+
+	if (argc >= 2 && std::string_view{argv[1]} == "batch")
+	{
+		const std::vector<const FileCodec *> codecs = (argc >= 5) ? FindFileCodecs(argv[2]) : std::vector<const FileCodec *>{};
+		const bool canWrite = !codecs.empty() && std::all_of(codecs.begin(), codecs.end(), [](const FileCodec *codec) { return codec->writeBank != nullptr; });
+		if (!canWrite || !sysExTarget.empty() || !outArchiveFilename.empty() || !sysExTimingStr.empty() || !tempoStr.empty() || strict)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunBatch(codecs, argv[3], std::vector<std::string>(argv + 4, argv + argc), printStats);
+	}
+	if (argc >= 2 && (std::string_view{argv[1]} == "sync" || std::string_view{argv[1]} == "watch"))
+	{
+		const std::vector<const FileCodec *> codecs = (argc == 5) ? FindFileCodecs(argv[2]) : std::vector<const FileCodec *>{};
+		const bool canWrite = !codecs.empty() && std::all_of(codecs.begin(), codecs.end(), [](const FileCodec *codec) { return codec->writeBank != nullptr; });
+		if (!canWrite || !sysExTarget.empty() || !outArchiveFilename.empty() || !sysExTimingStr.empty() || !tempoStr.empty() || strict)
+		{
+			PrintUsage();
+			return 1;
+		}
+		if (std::string_view{argv[1]} == "watch")
+			return RunWatch(codecs, argv[3], argv[4], printStats);
+		return RunSync(codecs, argv[3], argv[4], printStats);
+	}
+	if (argc >= 2 && std::string_view{argv[1]} == "delta")
+	{
+		std::optional<SysExTiming> sysExTiming;
+		if (argc != 5 || (!sysExTimingStr.empty() && !SysExTiming::Parse(sysExTimingStr, sysExTiming.emplace()))
+			|| !sysExTarget.empty() || !outArchiveFilename.empty() || !tempoStr.empty() || printStats || strict)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunDelta(argv[2], argv[3], argv[4], sysExTiming);
+	}
+	if (argc >= 2 && std::string_view{argv[1]} == "compact")
+	{
+		std::optional<SysExTiming> sysExTiming;
+		if (argc != 4 || (!sysExTimingStr.empty() && !SysExTiming::Parse(sysExTimingStr, sysExTiming.emplace()))
+			|| !sysExTarget.empty() || !outArchiveFilename.empty() || !tempoStr.empty() || printStats || strict)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunCompact(argv[2], argv[3], sysExTiming);
+	}
+
 	if (argc < 3)
 	{
 		PrintUsage();
@@ -224,32 +499,52 @@ int main(const int argc, char *argv[])
 		numInputFiles = argc - 3;
 	}
 
-	InputFile::Type targetType = InputFile::Type::SYX;
+	// Several output formats can be written in one go, e.g. "bin,svz,syx"
+	std::vector<InputFile::Type> targetTypes;
+	const auto hasTarget = [&targetTypes](const InputFile::Type type)
+	{
+		return std::find(targetTypes.begin(), targetTypes.end(), type) != targetTypes.end();
+	};
 	if (verb == "convert")
 	{
-		const std::string_view targetStr = argv[2];
-		if ((targetStr == "syx" || targetStr == "SYX") && argc == 5)
+		for (const FileCodec *codec : FindFileCodecs(argv[2]))
 		{
-			targetType = InputFile::Type::SYX;
+			targetTypes.push_back(codec->type);
 		}
-		else if((targetStr == "bin" || targetStr == "BIN") && argc == 5)
+		if (targetTypes.empty() || (argc != 5 && !(argc == 6 && hasTarget(InputFile::Type::SVD))))
 		{
-			targetType = InputFile::Type::SVZplugin;
-		}
-		else if ((targetStr == "svz" || targetStr == "SVZ") && argc == 5)
-		{
-			targetType = InputFile::Type::SVZhardware;
-		}
-		else if ((targetStr == "svd" || targetStr == "SVD") && (argc == 5 || argc == 6))
-		{
-			targetType = InputFile::Type::SVD;
+			PrintUsage();
+			return 1;
 		}
-		else
+		firstFileParam = 3;
+	}
+	if ((!outArchiveFilename.empty() && verb != "convert" && verb != "merge") || ((printStats || strict || !tempoStr.empty()) && verb != "convert"))
+	{
+		PrintUsage();
+		return 1;
+	}
+	ConversionOptions conversionOptions;
+	conversionOptions.strict = strict;
+	if (!tempoStr.empty())
+	{
+		const auto [ptr, ec] = std::from_chars(tempoStr.data(), tempoStr.data() + tempoStr.size(), conversionOptions.tempo);
+		if (ec != std::errc{} || ptr != tempoStr.data() + tempoStr.size() || !(conversionOptions.tempo > 0.0 && conversionOptions.tempo < 1000.0))
 		{
 			PrintUsage();
 			return 1;
 		}
-		firstFileParam = 3;
+	}
+	std::optional<SysExTiming> sysExTiming;
+	if (!sysExTimingStr.empty() && (!hasTarget(InputFile::Type::MID) || !SysExTiming::Parse(sysExTimingStr, sysExTiming.emplace())))
+	{
+		PrintUsage();
+		return 1;
+	}
+	const bool hasSysExTarget = hasTarget(InputFile::Type::SYX) || hasTarget(InputFile::Type::MID);
+	if (!sysExTarget.empty() && (!hasSysExTarget || (sysExTarget != "jd800" && sysExTarget != "JD800" && sysExTarget != "jd990" && sysExTarget != "JD990")))
+	{
+		PrintUsage();
+		return 1;
 	}
 
 	enum class DeviceType
@@ -267,34 +562,56 @@ int main(const int argc, char *argv[])
 	std::vector<PatchVST> vstPatches;
 	std::vector<uint8_t> message;
 
+	// Messages must not end up in the output data if it is written to standard output
+	const std::string_view outFilenameParam = (verb == "convert") ? argv[4] : ((verb == "merge") ? argv[argc - 1] : "");
+	if (IsStandardStream(outArchiveFilename) || IsStandardStream(outFilenameParam))
+		OpenStandardOutput();
+
+	// When writing to a ZIP archive, all console output is also stored in the archive as a diagnostics report
+	std::unique_ptr<OutputArchive> outArchive;
+	std::ostringstream diagnostics;
+	std::optional<StreamTee> teeOut, teeErr;
+	if (!outArchiveFilename.empty())
+	{
+		outArchive = std::make_unique<OutputArchive>();
+		teeOut.emplace(std::cout, diagnostics);
+		teeErr.emplace(std::cerr, diagnostics);
+	}
+
+	// Opens an output file on disk, or adds it to the output archive
+	const auto openOutputFile = [&outArchive](std::ofstream &file, const std::string &filename) -> std::ostream &
+	{
+		if (outArchive)
+			return outArchive->AddMember(std::filesystem::path{filename}.filename().string());
+		if (IsStandardStream(filename))
+			return OpenStandardOutput();
+		file.open(filename, std::ios::trunc | std::ios::binary);
+		return file;
+	};
+
+	std::vector<InputSource> inputSources;
 	for (int i = 0; i < numInputFiles; i++)
 	{
-		const std::string inFilename = argv[firstFileParam + i];
-		std::ifstream inFile{inFilename, std::ios::binary};
-		if (!inFile)
-		{
-			std::cout << "Could not open " << inFilename << " for reading!" << std::endl;
+		std::vector<InputSource> sources = OpenInputSources(argv[firstFileParam + i]);
+		if (sources.empty())
 			return 2;
-		}
+		std::move(sources.begin(), sources.end(), std::back_inserter(inputSources));
+	}
+	if (outArchive)
+	{
+		for (const InputSource &source : inputSources)
+			diagnostics << "Input file: " << source.name << "\n";
+	}
 
-		InputFile inputFile{inFile};
-		if (inputFile.GetType() == InputFile::Type::SVZplugin)
-		{
-			vstPatches = ReadSVZ(inFile);
-			if (vstPatches.empty())
-				return 2;
-			sourceDeviceType = DeviceType::JD800VST;
-		}
-		else if (inputFile.GetType() == InputFile::Type::SVZhardware)
-		{
-			vstPatches = ReadSVZ(inFile);
-			if (vstPatches.empty())
-				return 2;
-			sourceDeviceType = DeviceType::JD800VST;
-		}
-		else if (inputFile.GetType() == InputFile::Type::SVD)
+	for (const InputSource &source : inputSources)
+	{
+		const std::string &inFilename = source.name;
+		std::istream &inFile = *source.stream;
+
+		InputFile inputFile{inFile, std::cerr};
+		if (const FileCodec &codec = GetFileCodec(inputFile.GetType()); codec.readBank)
 		{
-			vstPatches = ReadSVD(inFile);
+			vstPatches = codec.readBank(inFile, std::cerr);
 			if (vstPatches.empty())
 				return 2;
 			sourceDeviceType = DeviceType::JD800VST;
@@ -434,293 +751,464 @@ int main(const int argc, char *argv[])
 	if (verb == "convert")
 	{
 		const std::string_view outFilenameBase = argv[4];
-		std::string_view sourceName, targetName, targetExt;
+		std::unique_ptr<std::iostream> svdFile;
+		SVDPatchChunk svdPatchChunk;
 		std::vector<char> originalSVDfile;
-		std::vector<PatchVST> svdOutputPatches;
+		std::vector<const SVDPatchRecord *> svdOutputPatches;
 		uint32_t patchOffsetSVD = 0;
+		PatchFormat sourceFormat = PatchFormat::VST, sysExFormat = PatchFormat::JD800;
 		if (sourceDeviceType == DeviceType::JD800)
-			sourceName = "JD-800";
+			sourceFormat = PatchFormat::JD800;
 		else if (sourceDeviceType == DeviceType::JD990)
-			sourceName = "JD-990";
-		else if (sourceDeviceType == DeviceType::JD800VST)
-			sourceName = "JD-800 VST / JD-08 / ZC1";
+			sourceFormat = PatchFormat::JD990;
+
+		// All SysEx targets (SYX and MID) are written for the same device
+		if (sysExTarget == "jd800" || sysExTarget == "JD800")
+			sysExFormat = PatchFormat::JD800;
+		else if (sysExTarget == "jd990" || sysExTarget == "JD990")
+			sysExFormat = PatchFormat::JD990;
+		else if (sourceFormat == PatchFormat::JD800)
+			sysExFormat = PatchFormat::JD990;
+		else
+			sysExFormat = PatchFormat::JD800;
 
-		if (targetType == InputFile::Type::SYX)
-		{
-			targetExt = "syx";
-			if (sourceDeviceType == DeviceType::JD800)
-				targetName = "JD-990";
-			else
-				targetName = "JD-800";
-		}
-		else if (targetType == InputFile::Type::SVZplugin)
+		if (targetTypes.size() > 1 && IsStandardStream(outFilenameBase) && !outArchive)
 		{
-			targetExt = "bin";
-			targetName = "JD-800 VST";
+			std::cout << "Several output formats cannot be written to standard output. Use --zip - to write all of them to standard output as a ZIP archive." << std::endl;
+			return 2;
 		}
-		else if (targetType == InputFile::Type::SVZhardware)
+
+		const uint32_t numPatches = (sourceDeviceType == DeviceType::JD800VST) ? static_cast<uint32_t>(vstPatches.size()) : 64u;
+
+		// Every target is written by its own thread, its messages are printed once all targets have been written
+		struct ConvertTarget
 		{
-			targetExt = "svz";
-			targetName = "ZC1";
-		}
-		else if (targetType == InputFile::Type::SVD)
+			const FileCodec *codec = nullptr;
+			InputFile::Type type = InputFile::Type::SYX;
+			PatchFormat format = PatchFormat::VST;
+			std::string_view name, ext;
+			std::string outFilenameBase;
+			uint32_t bankSize = 64, numBanks = 1;
+			std::ostringstream messages;
+		};
+		std::vector<ConvertTarget> targets(targetTypes.size());
+		bool hasVSTTarget = false;
+		for (size_t i = 0; i < targets.size(); i++)
 		{
-			targetExt = "svd";
-			targetName = "JD-08";
+			ConvertTarget &target = targets[i];
+			target.type = targetTypes[i];
+			target.codec = &GetFileCodec(target.type);
+			target.ext = target.codec->id;
+			target.name = target.codec->name;
+			if (target.codec->isSysEx)
+			{
+				target.format = sysExFormat;
+				target.name = GetFormatName(sysExFormat);
+			}
+			if (target.format == PatchFormat::VST)
+				hasVSTTarget = true;
+
+			// With several targets, the output filename is extended by each target's file extension
+			target.outFilenameBase = outFilenameBase;
+			if (targets.size() > 1)
+				target.outFilenameBase += "." + std::string{target.ext};
 
-			if (argc == 6)
+			if (target.type == InputFile::Type::SVD)
 			{
-				// Determine write offset
-				const std::string_view svdOffset = argv[5];
-				if (svdOffset.size() == 1 && svdOffset[0] >= 'A' && svdOffset[0] <= 'D')
-					patchOffsetSVD = (svdOffset[0] - 'A') * 64;
-				else if (svdOffset.size() == 1 && svdOffset[0] >= 'a' && svdOffset[0] <= 'd')
-					patchOffsetSVD = (svdOffset[0] - 'a') * 64;
-				else if (svdOffset.size() == 3 && svdOffset[0] >= 'A' && svdOffset[0] <= 'D' && svdOffset[1] >= '1' && svdOffset[1] <= '8' && svdOffset[2] >= '1' && svdOffset[2] <= '8')
-					patchOffsetSVD = (svdOffset[0] - 'A') * 64 + (svdOffset[1] - '1') * 8 + (svdOffset[2] - '1');
-				else if (svdOffset.size() == 3 && svdOffset[0] >= 'a' && svdOffset[0] <= 'd' && svdOffset[1] >= '1' && svdOffset[1] <= '8' && svdOffset[2] >= '1' && svdOffset[2] <= '8')
-					patchOffsetSVD = (svdOffset[0] - 'a') * 64 + (svdOffset[1] - '1') * 8 + (svdOffset[2] - '1');
+				if (argc == 6)
+				{
+					// Determine write offset
+					const std::string_view svdOffset = argv[5];
+					if (svdOffset.size() == 1 && svdOffset[0] >= 'A' && svdOffset[0] <= 'D')
+						patchOffsetSVD = (svdOffset[0] - 'A') * 64;
+					else if (svdOffset.size() == 1 && svdOffset[0] >= 'a' && svdOffset[0] <= 'd')
+						patchOffsetSVD = (svdOffset[0] - 'a') * 64;
+					else if (svdOffset.size() == 3 && svdOffset[0] >= 'A' && svdOffset[0] <= 'D' && svdOffset[1] >= '1' && svdOffset[1] <= '8' && svdOffset[2] >= '1' && svdOffset[2] <= '8')
+						patchOffsetSVD = (svdOffset[0] - 'A') * 64 + (svdOffset[1] - '1') * 8 + (svdOffset[2] - '1');
+					else if (svdOffset.size() == 3 && svdOffset[0] >= 'a' && svdOffset[0] <= 'd' && svdOffset[1] >= '1' && svdOffset[1] <= '8' && svdOffset[2] >= '1' && svdOffset[2] <= '8')
+						patchOffsetSVD = (svdOffset[0] - 'a') * 64 + (svdOffset[1] - '1') * 8 + (svdOffset[2] - '1');
+					else
+					{
+						std::cout << "Position parameter needs to be a bank (A/B/C/D) or patch number (e.g. B42)!" << std::endl;
+						return 2;
+					}
+				}
+
+				if (IsStandardStream(target.outFilenameBase))
+				{
+					// The original backup file is piped in, and the modified file is written to standard output
+					const auto standardInput = OpenStandardInput();
+					svdFile = std::make_unique<std::stringstream>(std::string{std::istreambuf_iterator<char>{*standardInput}, std::istreambuf_iterator<char>{}}, std::ios::in | std::ios::out | std::ios::binary);
+				}
 				else
 				{
-					std::cout << "Position parameter needs to be a bank (A/B/C/D) or patch number (e.g. B42)!" << std::endl;
+					svdFile = std::make_unique<std::fstream>(target.outFilenameBase, std::ios::in | std::ios::out | std::ios::binary);
+				}
+				if (!*svdFile)
+				{
+					std::cout << "Could not open " << target.outFilenameBase << " for reading! An original JD-08 backup file is required to write the patch data into." << std::endl;
 					return 2;
 				}
+
+				svdPatchChunk = FindSVDPatchChunk(*svdFile, std::cerr);
+				if (svdPatchChunk.numPatches == 0)
+				{
+					std::cout << target.outFilenameBase << " does not appear to be a valid SVD file! An original JD-08 backup file is required to write the patch data into." << std::endl;
+					return 2;
+				}
+
+				target.bankSize = 256 - patchOffsetSVD;
+				if (numPatches < target.bankSize)
+					target.bankSize = numPatches;
 			}
 
-			std::ifstream inFile{ std::string{outFilenameBase}, std::ios::binary };
-			if (!inFile)
+			target.numBanks = (numPatches + target.bankSize - 1) / target.bankSize;
+			if (target.numBanks > 1 && IsStandardStream(target.outFilenameBase) && !outArchive)
 			{
-				std::cout << "Could not open " << outFilenameBase << " for reading! An original JD-08 backup file is required to write the patch data into." << std::endl;
+				std::cout << "The output consists of " << target.numBanks << " banks, which cannot be written to standard output. Use --zip - to write all banks to standard output as a ZIP archive." << std::endl;
 				return 2;
 			}
+		}
 
-			svdOutputPatches = ReadSVD(inFile);
-			if (svdOutputPatches.empty())
+		// Only needed if the SVD file has to be rewritten completely.
+		// The file is read once, and its patch records are referenced directly from the file buffer.
+		const auto loadOriginalSVD = [&]()
+		{
+			if (!originalSVDfile.empty())
+				return;
+			svdFile->clear();
+			svdFile->seekg(0, std::ios::end);
+			const auto size = static_cast<size_t>(svdFile->tellg());
+			svdFile->seekg(0);
+			ReadVector(*svdFile, originalSVDfile, size);
+			svdFile.reset();
+
+			for (size_t offset = svdPatchChunk.offset; svdOutputPatches.size() < svdPatchChunk.numPatches && offset + sizeof(SVDPatchRecord) <= originalSVDfile.size(); offset += sizeof(SVDPatchRecord))
 			{
-				std::cout << outFilenameBase << " does not appear to be a valid SVD file! An original JD-08 backup file is required to write the patch data into." << std::endl;
-				return 2;
+				svdOutputPatches.push_back(reinterpret_cast<const SVDPatchRecord *>(originalSVDfile.data() + offset));
 			}
+		};
 
-			inFile.seekg(0, std::ios::end);
-			const auto size = static_cast<size_t>(inFile.tellg());
-			inFile.seekg(0);
-			ReadVector(inFile, originalSVDfile, size);
+		for (const ConvertTarget &target : targets)
+		{
+			const std::vector<PatchFormat> path = ConversionPlan{sourceFormat, target.format}.GetPath();
+			std::cout << "Converting " << GetFormatName(sourceFormat) << " patch format to " << target.name;
+			if (path.size() > 2)
+			{
+				std::cout << " via";
+				for (size_t step = 1; step < path.size() - 1; step++)
+					std::cout << " " << GetFormatName(path[step]);
+			}
+			std::cout << "..." << std::endl;
 		}
 
-		std::cout << "Converting " << sourceName << " patch format to " << targetName << "..." << std::endl;
-
-		if (sourceDeviceType != DeviceType::JD800VST)
-			vstPatches.resize(64);
+		// Fixups of VST source patches that are shared by most targets. Targets that need different fixups apply them on their own.
+		const auto checksModel = [](const InputFile::Type type) { return type != InputFile::Type::SVZplugin; };
+		const auto fixesMFX = [](const InputFile::Type type) { return type != InputFile::Type::SVZhardware; };
+		const bool checkModel = std::any_of(targetTypes.begin(), targetTypes.end(), checksModel);
+		const bool fixMFX = std::any_of(targetTypes.begin(), targetTypes.end(), fixesMFX);
+
+		// Convert patches, all targets are written from these results
+		ConversionContext context{std::cerr, conversionOptions};
+		std::vector<bool> patchPresent(numPatches, false);
+		ConvertedPatches converted;
+		if (hasSysExTarget && sysExFormat == PatchFormat::JD800)
+			converted.p800.resize(numPatches);
+		else if (hasSysExTarget && sysExFormat == PatchFormat::JD990)
+			converted.p990.resize(numPatches);
+		if (hasVSTTarget || sourceFormat == PatchFormat::VST)
+			converted.pVST.resize(numPatches);
+		// Instantiated for each combination of source format and target formats, so that no format needs to be checked for every patch.
+		// VST patches are converted only once for all VST targets, and once for all SysEx targets. TSysExPatch is void if there is no SysEx target.
+		const auto convertPatches = [&](const auto codec, const auto sysExTarget, const auto vstTarget)
+		{
+			using Codec = decltype(codec);
+			using TPatch = typename Codec::Patch;
+			using TSysExPatch = typename decltype(sysExTarget)::type;
+			constexpr bool convertToVST = decltype(vstTarget)::value;
+			for (uint32_t sourcePatch = 0; sourcePatch < numPatches; sourcePatch++)
+			{
+				const TPatch *source = nullptr;
+				if constexpr (Codec::format == PatchFormat::VST)
+				{
+					PatchVST &pVST = converted.pVST[sourcePatch];
+					pVST = vstPatches[sourcePatch];
+					FixVSTPatch(pVST, checkModel, fixMFX, GetPatchIndex(sourcePatch, numPatches), true, context);
+					source = &pVST;
+				}
+				else
+				{
+					const uint32_t address = Codec::GetInternalAddress(sourcePatch);
+					if (memory[address] == UNDEFINED_MEMORY)
+						continue;
+					source = reinterpret_cast<const TPatch *>(memory.data() + address);
+				}
+				std::cout << "Converting " << GetPatchIndex(sourcePatch, numPatches) << ": " << ToString(Codec::GetName(*source)) << std::endl;
+				patchPresent[sourcePatch] = true;
+
+				if constexpr (!std::is_void_v<TSysExPatch> && convertToVST)
+					ConvertPath(*source, converted.Get<TSysExPatch>()[sourcePatch], converted.pVST[sourcePatch], context);
+				else if constexpr (!std::is_void_v<TSysExPatch>)
+					ConvertPath(*source, converted.Get<TSysExPatch>()[sourcePatch], context);
+				else if constexpr (convertToVST)
+					ConvertPath(*source, converted.pVST[sourcePatch], context);
+			}
+		};
+		// VST source patches are not converted to VST, they are fixed up in place
+		const auto dispatchVSTTarget = [&](const auto codec, const auto sysExTarget)
+		{
+			if constexpr (decltype(codec)::format == PatchFormat::VST)
+				convertPatches(codec, sysExTarget, std::false_type{});
+			else if (hasVSTTarget)
+				convertPatches(codec, sysExTarget, std::true_type{});
+			else
+				convertPatches(codec, sysExTarget, std::false_type{});
+		};
+		DispatchPatchCodec(sourceFormat, [&](const auto codec)
+		{
+			if (!hasSysExTarget)
+				dispatchVSTTarget(codec, std::type_identity<void>{});
+			else if (sysExFormat == PatchFormat::JD800)
+				dispatchVSTTarget(codec, std::type_identity<Patch800>{});
+			else
+				dispatchVSTTarget(codec, std::type_identity<Patch990>{});
+		});
+
+		// Unused slots at the end of VST banks are filled with the default patch
+		PatchVST defaultPatchVST;
+		if (hasVSTTarget)
+			ConvertPatch800ToVST(reinterpret_cast<const Patch800 &>(DEFAULT_PATCH_800), defaultPatchVST, context);
+
+		// Convert rhythm setup / special setup. Index 0 is the internal setup, index 1 the temporary setup.
+		// Each setup is converted at most once to each format that is needed by any of the targets.
+		const std::array<uint32_t, 2> setupAddresses800 = { BASE_ADDR_800_SETUP_INTERNAL, BASE_ADDR_800_SETUP_TEMPORARY };
+		const std::array<uint32_t, 2> setupAddresses990 = { BASE_ADDR_990_SETUP_INTERNAL, BASE_ADDR_990_SETUP_TEMPORARY };
+		std::array<const SpecialSetup800 *, 2> setups800{};
+		std::array<const SpecialSetup990 *, 2> setups990{};
+		std::array<SpecialSetup800, 2> convertedSetups800;
+		std::array<SpecialSetup990, 2> convertedSetups990;
+		for (size_t i = 0; i < 2; i++)
+		{
+			if (sourceDeviceType == DeviceType::JD800 && memory[setupAddresses800[i]] != UNDEFINED_MEMORY)
+				setups800[i] = reinterpret_cast<const SpecialSetup800 *>(memory.data() + setupAddresses800[i]);
+			else if (sourceDeviceType == DeviceType::JD990 && memory[setupAddresses990[i]] != UNDEFINED_MEMORY)
+				setups990[i] = reinterpret_cast<const SpecialSetup990 *>(memory.data() + setupAddresses990[i]);
+		}
+		const auto convertSetup = [&](const size_t i, const PatchFormat format, const std::string_view suffix)
+		{
+			if (format == PatchFormat::JD800 && !setups800[i] && setups990[i])
+			{
+				std::cout << "Converting special setup" << suffix << ": " << ToString(setups990[i]->common.name) << std::endl;
+				ConvertSetup990To800(*setups990[i], convertedSetups800[i], context);
+				setups800[i] = &convertedSetups800[i];
+			}
+			else if (format == PatchFormat::JD990 && !setups990[i] && setups800[i])
+			{
+				std::cout << "Converting special setup" << suffix << std::endl;
+				ConvertSetup800To990(*setups800[i], convertedSetups990[i], context);
+				setups990[i] = &convertedSetups990[i];
+			}
+		};
 
-		const uint32_t numPatches = static_cast<uint32_t>(vstPatches.size());
-		uint32_t bankSize = 64;
-		if (targetType == InputFile::Type::SVD)
+		std::vector<PatchVST> setupPatchesVST;
+		if (hasVSTTarget)
 		{
-			bankSize = 256 - patchOffsetSVD;
-			if(numPatches < bankSize)
-				bankSize = numPatches;
+			const size_t setup = (setups800[0] || setups990[0]) ? 0 : 1;
+			if (setups800[setup])
+				std::cout << "Converting special setup" << std::endl;
+			convertSetup(setup, PatchFormat::JD800, "");
+			if (setups800[setup])
+				setupPatchesVST = ConvertSetup800ToVST(*setups800[setup], context);
 		}
-		const uint32_t numBanks = (numPatches + bankSize - 1) / bankSize;
-		uint32_t sourcePatch = 0;
-		std::vector<PatchVST> bankPatchesVST(bankSize);
 
-		for (uint32_t bank = 0; bank < numBanks; bank++)
+		ConvertedPatches convertedTemporary;
+		if (hasSysExTarget && sourceFormat != PatchFormat::VST)
 		{
-			std::string outFilename{outFilenameBase};
-			if (numBanks > 1)
+			convertSetup(0, sysExFormat, "");
+
+			// Convert temporary patches
+			const auto convertTemporaryPatches = [&](const auto sysExTarget)
 			{
-				if (outFilename.size() > 4 && outFilename[outFilename.size() - 4] == '.')
-					outFilename = outFilename.substr(0, outFilename.size() - 3) + std::to_string(bank + 1) + outFilename.substr(outFilename.size() - 4);
-				else
-					outFilename += "." + std::to_string(bank + 1) + "." + std::string{targetExt};
-			}
+				using TSysExPatch = typename decltype(sysExTarget)::type;
+				std::vector<TSysExPatch> &results = convertedTemporary.Get<TSysExPatch>();
+				for (const auto &p800 : temporaryPatches800)
+				{
+					std::cout << "Converting temporary patch: " << ToString(p800.common.name) << std::endl;
+					ConvertPath(p800, results.emplace_back(), context);
+				}
+				for (const auto &p990 : temporaryPatches990)
+				{
+					std::cout << "Converting temporary patch: " << ToString(p990.common.name) << std::endl;
+					ConvertPath(p990, results.emplace_back(), context);
+				}
+			};
+			if (sysExFormat == PatchFormat::JD800)
+				convertTemporaryPatches(std::type_identity<Patch800>{});
+			else
+				convertTemporaryPatches(std::type_identity<Patch990>{});
 
-			std::ofstream outFile{ outFilename, std::ios::trunc | std::ios::binary };
+			convertSetup(1, sysExFormat, " (temporary)");
+		}
 
-			// Convert patches
-			for (uint32_t destPatch = 0; destPatch < bankSize; destPatch++, sourcePatch++)
+		if (strict && context.GetNumWarnings())
+		{
+			std::cout << "Not writing any output, information would be lost in " << context.GetNumWarnings() << " places!" << std::endl;
+			return 3;
+		}
+
+		// Instantiated for the patch format of each target
+		const auto writeTarget = [&](ConvertTarget &target, const auto codec)
+		{
+			using Codec = decltype(codec);
+			// Every writer thread needs its own context for replacing patches by the default patch
+			ConversionContext fixupContext{target.messages, conversionOptions};
+			const bool ownFixups = (sourceFormat == PatchFormat::VST && (checksModel(target.type) != checkModel || fixesMFX(target.type) != fixMFX));
+			std::vector<PatchVST> bankPatchesVST(target.bankSize);
+
+			for (uint32_t bank = 0; bank < target.numBanks; bank++)
 			{
-				if (sourcePatch >= numPatches)
+				std::string outFilename = target.outFilenameBase;
+				if (target.numBanks > 1)
 				{
-					ConvertPatch800ToVST(reinterpret_cast<const Patch800 &>(DEFAULT_PATCH_800), bankPatchesVST[destPatch]);
-					continue;
+					if (outFilename.size() > 4 && outFilename[outFilename.size() - 4] == '.')
+						outFilename = outFilename.substr(0, outFilename.size() - 3) + std::to_string(bank + 1) + outFilename.substr(outFilename.size() - 4);
+					else
+						outFilename.append(".").append(std::to_string(bank + 1)).append(".").append(target.ext);
+				}
+
+				// If all patches fit into the existing SVD file, only their slots are overwritten
+				const bool tryInPlaceSVD = (target.type == InputFile::Type::SVD && target.numBanks == 1 && !outArchive && !IsStandardStream(target.outFilenameBase));
+				std::ofstream outFileStream;
+				std::ostream *outFile = nullptr;
+				if (!tryInPlaceSVD)
+					outFile = &openOutputFile(outFileStream, outFilename);
+				// The MIDI file is written once all SysEx messages of this bank have been collected
+				std::optional<MidiFileWriter> midiFile;
+				if (target.type == InputFile::Type::MID)
+				{
+					midiFile.emplace(*outFile, sysExTiming.value_or(SysExTiming::ForDevice(sysExFormat)), target.messages);
+					outFile = &midiFile->GetStream();
 				}
 
-				if (sourceDeviceType == DeviceType::JD800VST)
+				const uint32_t firstPatch = bank * target.bankSize;
+				if constexpr (Codec::format != PatchFormat::VST)
 				{
-					PatchVST &pVST = vstPatches[sourcePatch];
-					if (targetType != InputFile::Type::SVZplugin)
+					WriteSysExBank(*outFile, converted.Get<typename Codec::Patch>(), patchPresent, firstPatch, target.bankSize);
+				}
+				else
+				{
+					for (uint32_t destPatch = 0; destPatch < target.bankSize; destPatch++)
 					{
-						if (pVST.zenHeader.modelID1 != 3 || pVST.zenHeader.modelID2 != 5)
+						const uint32_t sourcePatch = firstPatch + destPatch;
+						if (sourcePatch >= numPatches)
 						{
-							std::cerr << "Ignoring patch" << GetPatchIndex(sourcePatch, numPatches) << ", appears to be for another synth model!" << std::endl;
-							Reconstruct(pVST);
-							ConvertPatch800ToVST(reinterpret_cast<const Patch800 &>(DEFAULT_PATCH_800), pVST);
+							bankPatchesVST[destPatch] = defaultPatchVST;
+						}
+						else if (!patchPresent[sourcePatch])
+						{
+							continue;
+						}
+						else if (ownFixups)
+						{
+							bankPatchesVST[destPatch] = vstPatches[sourcePatch];
+							FixVSTPatch(bankPatchesVST[destPatch], checksModel(target.type), fixesMFX(target.type), {}, false, fixupContext);
+						}
+						else
+						{
+							bankPatchesVST[destPatch] = converted.pVST[sourcePatch];
 						}
-					}
-					if (pVST.effectsGroupA.mfxType != 93 && targetType != InputFile::Type::SVZhardware)
-					{
-						// Patch didn't use JD Multi effect - disable effect group A.
-						if (pVST.effectsGroupA.mfxType != 0)
-							std::cerr << "Warning, patch " << GetPatchIndex(sourcePatch, numPatches) << " uses an MFX other than JD Multi - disabling effect group A" << std::endl;
-						pVST.effectsGroupA.mfxType = 93;
-						pVST.effectsGroupA.groupAenabled = 0;
 					}
 				}
 
-				const uint32_t address800src = BASE_ADDR_800_PATCH_INTERNAL + ((sourcePatch * 0x03) << 7);
-				const uint32_t address990src = BASE_ADDR_990_PATCH_INTERNAL + (sourcePatch << 14);
-				const uint32_t address800dst = BASE_ADDR_800_PATCH_INTERNAL + ((destPatch * 0x03) << 7);
-				const uint32_t address990dst = BASE_ADDR_990_PATCH_INTERNAL + (destPatch << 14);
-				if (sourceDeviceType == DeviceType::JD800)
+				if (target.codec->writeBank)
+					target.codec->writeBank(*outFile, bankPatchesVST);
+				else if (target.type == InputFile::Type::SVD)
 				{
-					if (memory[address800src] == UNDEFINED_MEMORY)
-						continue;
-					const Patch800 &p800 = *reinterpret_cast<const Patch800 *>(memory.data() + address800src);
-					std::cout << "Converting " << GetPatchIndex(sourcePatch, numPatches) << ": " << ToString(p800.common.name) << std::endl;
-					if (targetType == InputFile::Type::SYX)
+					if (tryInPlaceSVD && WriteSVDInPlace(*svdFile, svdPatchChunk, bankPatchesVST, patchOffsetSVD))
 					{
-						Patch990 p990;
-						ConvertPatch800To990(p800, p990);
-						WriteSysEx(outFile, address990dst, true, p990);
+						target.messages << "Updated " << bankPatchesVST.size() << " patch slots in " << outFilename << std::endl;
 					}
 					else
 					{
-						ConvertPatch800ToVST(p800, bankPatchesVST[destPatch]);
+						loadOriginalSVD();
+						if (!outFile)
+							outFile = &openOutputFile(outFileStream, outFilename);
+						const auto bankRecords = MakeSVDPatchRecords(bankPatchesVST);
+						WriteSVD(*outFile, MergePatchesIntoSVD(bankRecords, svdOutputPatches, patchOffsetSVD), originalSVDfile);
 					}
 				}
-				else if (sourceDeviceType == DeviceType::JD990)
-				{
-					if (memory[address990src] == UNDEFINED_MEMORY)
-						continue;
-					const Patch990 &p990 = *reinterpret_cast<const Patch990 *>(memory.data() + address990src);
-					std::cout << "Converting " << GetPatchIndex(sourcePatch, numPatches) << ": " << ToString(p990.common.name) << std::endl;
-					Patch800 p800;
-					ConvertPatch990To800(p990, p800);
-					if (targetType == InputFile::Type::SYX)
-						WriteSysEx(outFile, address800dst, false, p800);
-					else
-						ConvertPatch800ToVST(p800, bankPatchesVST[destPatch]);
-				}
-				else if (sourceDeviceType == DeviceType::JD800VST)
+
+				if (bank > 0)
+					continue;
+
+				if (!target.codec->isSysEx)
 				{
-					const PatchVST &pVST = vstPatches[sourcePatch];
-					std::cout << "Converting " << GetPatchIndex(sourcePatch, numPatches) << ": " << ToString(pVST.name) << std::endl;
-					if (targetType == InputFile::Type::SYX)
+					if (!setupPatchesVST.empty() && IsStandardStream(target.outFilenameBase) && !outArchive)
 					{
-						Patch800 p800;
-						ConvertPatchVSTTo800(pVST, p800);
-						WriteSysEx(outFile, address800dst, false, p800);
+						target.messages << "The special setup cannot be written to standard output together with the patches. Use --zip - to write both to standard output as a ZIP archive." << std::endl;
 					}
-					else
+					else if (!setupPatchesVST.empty())
 					{
-						bankPatchesVST[destPatch] = vstPatches[sourcePatch];
+						if (outFilename.size() > 4 && outFilename[outFilename.size() - 4] == '.')
+							outFilename = outFilename.substr(0, outFilename.size() - 3) + "setup" + outFilename.substr(outFilename.size() - 4);
+						else
+							outFilename += ".setup." + std::string{target.ext};
+
+						if (target.type == InputFile::Type::SVD)
+							loadOriginalSVD();
+						std::ofstream outFileSetupStream;
+						std::ostream &outFileSetup = openOutputFile(outFileSetupStream, outFilename);
+
+						if (target.codec->writeBank)
+							target.codec->writeBank(outFileSetup, setupPatchesVST);
+						else if (target.type == InputFile::Type::SVD)
+							WriteSVD(outFileSetup, MergePatchesIntoSVD(MakeSVDPatchRecords(setupPatchesVST), svdOutputPatches, patchOffsetSVD), originalSVDfile);
 					}
-				}
-			}
-
-			if (targetType == InputFile::Type::SVZplugin)
-				WriteSVZforPlugin(outFile, bankPatchesVST);
-			else if (targetType == InputFile::Type::SVZhardware)
-				WriteSVZforHardware(outFile, bankPatchesVST);
-			else if (targetType == InputFile::Type::SVD)
-				WriteSVD(outFile, MergePatchesIntoSVD(bankPatchesVST, svdOutputPatches, patchOffsetSVD), originalSVDfile);
-
-			if(bank > 0)
-				continue;
-
-			if (targetType != InputFile::Type::SYX && targetType != InputFile::Type::MID)
-			{
-				// Convert rhythm setup / special setup
-				const uint32_t address800 = (memory[BASE_ADDR_800_SETUP_INTERNAL] != UNDEFINED_MEMORY) ? BASE_ADDR_800_SETUP_INTERNAL : BASE_ADDR_800_SETUP_TEMPORARY;
-				const uint32_t address990 = (memory[BASE_ADDR_990_SETUP_INTERNAL] != UNDEFINED_MEMORY) ? BASE_ADDR_990_SETUP_INTERNAL : BASE_ADDR_990_SETUP_TEMPORARY;
-				std::vector<PatchVST> setupPatches;
-				if (sourceDeviceType == DeviceType::JD800 && memory[address800] != UNDEFINED_MEMORY)
-				{
-					const SpecialSetup800 &s800 = *reinterpret_cast<const SpecialSetup800 *>(memory.data() + address800);
-					std::cout << "Converting special setup" << std::endl;
-					setupPatches = ConvertSetup800ToVST(s800);
-				}
-				else if (sourceDeviceType == DeviceType::JD990 && memory[address990] != UNDEFINED_MEMORY)
-				{
-					const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + address990);
-					SpecialSetup800 s800;
-					std::cout << "Converting special setup: " << ToString(s990.common.name) << std::endl;
-					ConvertSetup990To800(s990, s800);
-					setupPatches = ConvertSetup800ToVST(s800);
+					continue;
 				}
 
-				if (!setupPatches.empty())
+				if constexpr (Codec::format != PatchFormat::VST)
 				{
-					if (outFilename.size() > 4 && outFilename[outFilename.size() - 4] == '.')
-						outFilename = outFilename.substr(0, outFilename.size() - 3) + "setup" + outFilename.substr(outFilename.size() - 4);
-					else
-						outFilename += ".setup." + std::string{ targetExt };
-
-					std::ofstream outFileSetup{ outFilename, std::ios::trunc | std::ios::binary };
-
-					if (targetType == InputFile::Type::SVZplugin)
-						WriteSVZforPlugin(outFileSetup, setupPatches);
-					else if (targetType == InputFile::Type::SVZhardware)
-						WriteSVZforHardware(outFileSetup, setupPatches);
-					else if (targetType == InputFile::Type::SVD)
-						WriteSVD(outFileSetup, MergePatchesIntoSVD(setupPatches, svdOutputPatches, patchOffsetSVD), originalSVDfile);
+					const auto writeSysExSetup = [&](const size_t setup)
+					{
+						if constexpr (Codec::format == PatchFormat::JD800)
+						{
+							if (setups800[setup])
+								WriteSysEx(*outFile, setupAddresses800[setup], Codec::isJD990, *setups800[setup]);
+						}
+						else if (setups990[setup])
+						{
+							WriteSysEx(*outFile, setupAddresses990[setup], Codec::isJD990, *setups990[setup]);
+						}
+					};
+					writeSysExSetup(0);
+					for (const auto &patch : convertedTemporary.Get<typename Codec::Patch>())
+						WriteSysEx(*outFile, Codec::temporaryAddress, Codec::isJD990, patch);
+					writeSysExSetup(1);
 				}
-
-				continue;
 			}
+		};
 
-			// Convert rhythm setup / special setup
-			const uint32_t address800 = BASE_ADDR_800_SETUP_INTERNAL;
-			const uint32_t address990 = BASE_ADDR_990_SETUP_INTERNAL;
-			if (sourceDeviceType == DeviceType::JD800 && memory[address800] != UNDEFINED_MEMORY)
-			{
-				const SpecialSetup800 &s800 = *reinterpret_cast<const SpecialSetup800 *>(memory.data() + address800);
-				SpecialSetup990 s990;
-				std::cout << "Converting special setup" << std::endl;
-				ConvertSetup800To990(s800, s990);
-				WriteSysEx(outFile, address990, true, s990);
-			}
-			else if (sourceDeviceType == DeviceType::JD990 && memory[address990] != UNDEFINED_MEMORY)
+		std::vector<std::thread> writers;
+		for (ConvertTarget &target : targets)
+		{
+			writers.emplace_back([&writeTarget, &target]()
 			{
-				const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + address990);
-				SpecialSetup800 s800;
-				std::cout << "Converting special setup: " << ToString(s990.common.name) << std::endl;
-				ConvertSetup990To800(s990, s800);
-				WriteSysEx(outFile, address800, false, s800);
-			}
+				DispatchPatchCodec(target.format, [&](const auto codec) { writeTarget(target, codec); });
+			});
+		}
+		for (std::thread &writer : writers)
+			writer.join();
+		for (const ConvertTarget &target : targets)
+			std::cout << target.messages.str() << std::flush;
 
-			// Convert temporary patches
-			for (const auto &p800 : temporaryPatches800)
-			{
-				std::cout << "Converting temporary patch: " << ToString(p800.common.name) << std::endl;
-				Patch990 p990;
-				ConvertPatch800To990(p800, p990);
-				WriteSysEx(outFile, BASE_ADDR_990_PATCH_TEMPORARY, true, p990);
-			}
-			for (const auto &p990 : temporaryPatches990)
-			{
-				std::cout << "Converting temporary patch: " << ToString(p990.common.name) << std::endl;
-				Patch800 p800;
-				ConvertPatch990To800(p990, p800);
-				WriteSysEx(outFile, BASE_ADDR_800_PATCH_TEMPORARY, false, p800);
-			}
-			if (sourceDeviceType == DeviceType::JD800 && memory[BASE_ADDR_800_SETUP_TEMPORARY] != UNDEFINED_MEMORY)
-			{
-				const SpecialSetup800 &s800 = *reinterpret_cast<const SpecialSetup800 *>(memory.data() + BASE_ADDR_800_SETUP_TEMPORARY);
-				SpecialSetup990 s990;
-				std::cout << "Converting special setup (temporary)" << std::endl;
-				ConvertSetup800To990(s800, s990);
-				WriteSysEx(outFile, BASE_ADDR_990_SETUP_TEMPORARY, true, s990);
-			}
-			else if (sourceDeviceType == DeviceType::JD990 && memory[BASE_ADDR_990_SETUP_TEMPORARY] != UNDEFINED_MEMORY)
-			{
-				const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + BASE_ADDR_990_SETUP_TEMPORARY);
-				SpecialSetup800 s800;
-				std::cout << "Converting special setup (temporary): " << ToString(s990.common.name) << std::endl;
-				ConvertSetup990To800(s990, s800);
-				WriteSysEx(outFile, BASE_ADDR_800_SETUP_TEMPORARY, false, s800);
-			}
+		if (printStats)
+		{
+			const ToneCacheStats toneCache = context.GetToneCacheStats();
+			std::cout << "Tone cache: " << toneCache.hits << " hits, " << toneCache.misses << " misses";
+			if (toneCache.hits + toneCache.misses)
+				std::cout << " (" << (toneCache.hits * 100 / (toneCache.hits + toneCache.misses)) << "% hit rate)";
+			std::cout << std::endl;
 		}
 	}
 	else if (verb == "merge")
@@ -734,6 +1222,11 @@ int main(const int argc, char *argv[])
 
 		const size_t numPatches = (sourceDeviceType == DeviceType::JD800) ? temporaryPatches800.size() : temporaryPatches990.size();
 		const size_t numBanks = (numPatches + 63) / 64;
+		if (numBanks > 1 && IsStandardStream(outFilenameParam) && !outArchive)
+		{
+			std::cout << "The output consists of " << numBanks << " banks, which cannot be written to standard output. Use --zip - to write all banks to standard output as a ZIP archive." << std::endl;
+			return 2;
+		}
 		size_t sourcePatch = 0;
 
 		for (size_t bank = 0; bank < numBanks; bank++)
@@ -747,26 +1240,22 @@ int main(const int argc, char *argv[])
 					outFilename += "." + std::to_string(bank + 1);
 			}
 
-			std::ofstream outFile{outFilename, std::ios::trunc | std::ios::binary};
+			std::ofstream outFileStream;
+			std::ostream &outFile = openOutputFile(outFileStream, outFilename);
 
-			for (uint32_t destPatch = 0; destPatch < 64; destPatch++, sourcePatch++)
+			const auto addPatches = [&](const auto &temporaryPatches)
 			{
-				if (sourcePatch >= numPatches)
-					break;
-
-				if (sourceDeviceType == DeviceType::JD800)
+				using Codec = PatchCodec<typename std::remove_cvref_t<decltype(temporaryPatches)>::value_type>;
+				for (uint32_t destPatch = 0; destPatch < 64 && sourcePatch < numPatches; destPatch++, sourcePatch++)
 				{
-					const uint32_t address800 = BASE_ADDR_800_PATCH_INTERNAL + ((destPatch * 0x03) << 7);
-					std::cout << "Adding " << GetPatchIndex(destPatch, 64) << ": " << ToString(temporaryPatches800[sourcePatch].common.name) << std::endl;
-					WriteSysEx(outFile, address800, false, temporaryPatches800[sourcePatch]);
+					std::cout << "Adding " << GetPatchIndex(destPatch, 64) << ": " << ToString(Codec::GetName(temporaryPatches[sourcePatch])) << std::endl;
+					WriteSysEx(outFile, Codec::GetInternalAddress(destPatch), Codec::isJD990, temporaryPatches[sourcePatch]);
 				}
-				else if (sourceDeviceType == DeviceType::JD990)
-				{
-					const uint32_t address990 = BASE_ADDR_990_PATCH_INTERNAL + (destPatch << 14);
-					std::cout << "Adding " << GetPatchIndex(destPatch, 64) << ": " << ToString(temporaryPatches990[sourcePatch].common.name) << std::endl;
-					WriteSysEx(outFile, address990, true, temporaryPatches990[sourcePatch]);
-				}
-			}
+			};
+			if (sourceDeviceType == DeviceType::JD800)
+				addPatches(temporaryPatches800);
+			else if (sourceDeviceType == DeviceType::JD990)
+				addPatches(temporaryPatches990);
 		}
 
 	}
@@ -824,7 +1313,7 @@ int main(const int argc, char *argv[])
 				const Patch800 &p800 = *reinterpret_cast<const Patch800 *>(memory.data() + address800);
 				std::cout << GetPatchIndex(patch, numPatches) << ": " << ToString(p800.common.name) << std::endl;
 				if (verbose)
-					PrintPatch(p800);
+					PrintPatch(std::cout, p800);
 			}
 			else if (sourceDeviceType == DeviceType::JD990)
 			{
@@ -833,13 +1322,13 @@ int main(const int argc, char *argv[])
 				const Patch990 &p990 = *reinterpret_cast<const Patch990 *>(memory.data() + address990);
 				std::cout << GetPatchIndex(patch, numPatches) << ": " << ToString(p990.common.name) << std::endl;
 				if (verbose)
-					PrintPatch(p990);
+					PrintPatch(std::cout, p990);
 			}
 			else if (sourceDeviceType == DeviceType::JD800VST)
 			{
 				std::cout << GetPatchIndex(patch, numPatches) << ": " << ToString(vstPatches[patch].name) << std::endl;
 				if (verbose)
-					PrintPatch(vstPatches[patch]);
+					PrintPatch(std::cout, vstPatches[patch]);
 			}
 		}
 		for (uint32_t patch = 0; patch < 64; patch++)
@@ -869,14 +1358,14 @@ int main(const int argc, char *argv[])
 				const SpecialSetup800 &s800 = *reinterpret_cast<const SpecialSetup800 *>(memory.data() + BASE_ADDR_800_SETUP_INTERNAL);
 				std::cout << "Special setup (internal): JD-800 Drum Set" << std::endl;
 				if (verbose)
-					PrintSetup(s800);
+					PrintSetup(std::cout, s800);
 			}
 			if (memory[BASE_ADDR_800_SETUP_TEMPORARY] != UNDEFINED_MEMORY)
 			{
 				const SpecialSetup800 &s800 = *reinterpret_cast<const SpecialSetup800 *>(memory.data() + BASE_ADDR_800_SETUP_TEMPORARY);
 				std::cout << "Special setup (temporary): JD-800 Drum Set" << std::endl;
 				if (verbose)
-					PrintSetup(s800);
+					PrintSetup(std::cout, s800);
 			}
 		}
 		else if (sourceDeviceType == DeviceType::JD990)
@@ -886,24 +1375,34 @@ int main(const int argc, char *argv[])
 				const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + BASE_ADDR_990_SETUP_INTERNAL);
 				std::cout << "Special setup (internal): " << ToString(s990.common.name) << std::endl;
 				if (verbose)
-					PrintSetup(s990);
+					PrintSetup(std::cout, s990);
 			}
 			if (memory[BASE_ADDR_990_SETUP_CARD] != UNDEFINED_MEMORY)
 			{
 				const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + BASE_ADDR_990_SETUP_CARD);
 				std::cout << "Special setup (card): " << ToString(s990.common.name) << std::endl;
 				if (verbose)
-					PrintSetup(s990);
+					PrintSetup(std::cout, s990);
 			}
 			if (memory[BASE_ADDR_990_SETUP_TEMPORARY] != UNDEFINED_MEMORY)
 			{
 				const SpecialSetup990 &s990 = *reinterpret_cast<const SpecialSetup990 *>(memory.data() + BASE_ADDR_990_SETUP_TEMPORARY);
 				std::cout << "Special setup (temporary): " << ToString(s990.common.name) << std::endl;
 				if (verbose)
-					PrintSetup(s990);
+					PrintSetup(std::cout, s990);
 			}
 		}
 	}
 
+	if (outArchive)
+	{
+		teeOut.reset();
+		teeErr.reset();
+		outArchive->AddMember("diagnostics.txt") << diagnostics.str();
+		if (!outArchive->Write(std::string{outArchiveFilename}))
+			return 2;
+		std::cout << "Wrote all output files to " << outArchiveFilename << std::endl;
+	}
+
 	return 0;
 }
@@ -4,29 +4,36 @@
 
 #pragma once
 
+#include <iosfwd>
+#include <string_view>
 #include <vector>
 
+class ConversionContext;
 struct Patch800;
 struct Patch990;
 struct PatchVST;
 struct SpecialSetup800;
 struct SpecialSetup990;
 
-void ConvertPatch800To990(const Patch800 &p800, Patch990 &p990);
-void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800);
+// All converters report lost information to the context and only use the context's scratch memory,
+// so they can be called from several threads at once with different contexts.
+void ConvertPatch800To990(const Patch800 &p800, Patch990 &p990, ConversionContext &context);
+void ConvertPatch990To800(const Patch990 &p990, Patch800 &p800, ConversionContext &context);
 
-void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST);
-void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800);
+void ConvertPatch800ToVST(const Patch800 &p800, PatchVST &pVST, ConversionContext &context);
+void ConvertPatchVSTTo800(const PatchVST &pVST, Patch800 &p800, ConversionContext &context);
 
-struct SpecialSetup800;
-struct SpecialSetup990;
+void ConvertSetup800To990(const SpecialSetup800 &s800, SpecialSetup990 &s990, ConversionContext &context);
+void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800, ConversionContext &context);
+std::vector<PatchVST> ConvertSetup800ToVST(const SpecialSetup800 &s800, ConversionContext &context);
 
-void ConvertSetup800To990(const SpecialSetup800 &s800, SpecialSetup990 &s990);
-void ConvertSetup990To800(const SpecialSetup990 &s990, SpecialSetup800 &s800);
-std::vector<PatchVST> ConvertSetup800ToVST(const SpecialSetup800 &s800);
+// Used for empty bank slots
+const Patch800 &GetDefaultPatch800();
+// Replaces patches for other ZenCore synth models by the default patch (checkModel) and disables MFX other than JD Multi (fixMFX)
+void FixVSTPatch(PatchVST &pVST, const bool checkModel, const bool fixMFX, const std::string_view patchIndex, const bool printWarnings, ConversionContext &context);
 
-void PrintPatch(const Patch800 &patch);
-void PrintPatch(const Patch990 &patch);
-void PrintPatch(const PatchVST &patch);
-void PrintSetup(const SpecialSetup800 &setup);
-void PrintSetup(const SpecialSetup990 &setup);
+void PrintPatch(std::ostream &out, const Patch800 &patch);
+void PrintPatch(std::ostream &out, const Patch990 &patch);
+void PrintPatch(std::ostream &out, const PatchVST &patch);
+void PrintSetup(std::ostream &out, const SpecialSetup800 &setup);
+void PrintSetup(std::ostream &out, const SpecialSetup990 &setup);
@@ -0,0 +1,107 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "MappedFile.hpp"
+#include "StandardStreams.hpp"
+
+#include <istream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::vector<uint8_t> ReadStandardInput()
+	{
+		const auto input = OpenStandardInput();
+		return std::vector<uint8_t>{std::istreambuf_iterator<char>{*input}, std::istreambuf_iterator<char>{}};
+	}
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filename)
+{
+	if (IsStandardStream(filename))
+	{
+		m_buffer = ReadStandardInput();
+		m_data = m_buffer.empty() ? nullptr : m_buffer.data();
+		m_size = m_buffer.size();
+		return;
+	}
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	m_file = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || static_cast<uint64_t>(size.QuadPart) > SIZE_MAX)
+		return;
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mapping)
+		return;
+
+	m_data = static_cast<const uint8_t *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data)
+		m_size = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data && m_buffer.empty())
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file)
+		CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &filename)
+{
+	if (IsStandardStream(filename))
+	{
+		m_buffer = ReadStandardInput();
+		m_data = m_buffer.empty() ? nullptr : m_buffer.data();
+		m_size = m_buffer.size();
+		return;
+	}
+
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat st{};
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED)
+		{
+			m_data = static_cast<const uint8_t *>(data);
+			m_size = static_cast<size_t>(st.st_size);
+		}
+	}
+	// The mapping stays valid after closing the file descriptor
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_data && m_buffer.empty())
+		munmap(const_cast<uint8_t *>(m_data), m_size);
+}
+
+#endif
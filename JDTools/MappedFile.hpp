@@ -0,0 +1,36 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only memory mapping of a whole file.
+// Standard input ("-") cannot be mapped, so it is read into memory instead.
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string &filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	// Returns false if the file could not be opened or is empty
+	bool IsValid() const noexcept { return m_data != nullptr; }
+	const uint8_t *GetData() const noexcept { return m_data; }
+	size_t GetSize() const noexcept { return m_size; }
+
+private:
+	const uint8_t *m_data = nullptr;
+	size_t m_size = 0;
+	std::vector<uint8_t> m_buffer;  // Only used for standard input
+#ifdef _WIN32
+	void *m_file = nullptr;
+	void *m_mapping = nullptr;
+#endif
+};
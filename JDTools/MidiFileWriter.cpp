@@ -0,0 +1,172 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "MidiFileWriter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// MIDI sends 31250 bits per second, and every byte takes 10 bits including start and stop bit
+	constexpr double WIRE_BYTE_TIME = 10.0 * 1000.0 / 31250.0;
+
+	// 500000 microseconds per quarter note (120 BPM) at 1000 ticks per quarter note, so one tick is half a millisecond
+	constexpr uint32_t MIDI_TEMPO = 500000;
+	constexpr uint16_t MIDI_TICKS_PER_QUARTER = 1000;
+	constexpr double MIDI_TICK_TIME = MIDI_TEMPO / 1000.0 / MIDI_TICKS_PER_QUARTER;
+
+	void WriteVarInt(std::vector<uint8_t> &out, uint32_t value)
+	{
+		uint8_t bytes[5];
+		int numBytes = 0;
+		do
+		{
+			bytes[numBytes++] = value & 0x7F;
+			value >>= 7;
+		} while (value);
+		while (numBytes > 1)
+		{
+			out.push_back(bytes[--numBytes] | 0x80);
+		}
+		out.push_back(bytes[0]);
+	}
+
+	void WriteUint32BE(std::vector<uint8_t> &out, const uint32_t value)
+	{
+		out.insert(out.end(), { static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value) });
+	}
+
+	// A message that has been sent to the device but has not been processed yet, so it still occupies the receive buffer
+	struct PendingMessage
+	{
+		double processed;
+		size_t size;
+	};
+
+	// Schedules every message as early as the MIDI wire speed and the device's receive buffer allow, and calls func with the MIDI tick,
+	// start (F0) and end (F7) of each message. Returns the time in milliseconds until the device has processed the last message.
+	template<typename Func>
+	double ScheduleSysEx(std::span<const uint8_t> sysExData, const SysExTiming &timing, Func &&func)
+	{
+		std::deque<PendingMessage> pending;
+		size_t bufferUsed = 0;
+		double wireFree = 0.0, deviceFree = 0.0;
+		for (auto start = std::find(sysExData.begin(), sysExData.end(), uint8_t(0xF0)); start != sysExData.end(); )
+		{
+			const auto end = std::find(start, sysExData.end(), uint8_t(0xF7));
+			if (end == sysExData.end())
+				break;
+			const size_t size = std::distance(start, end) + 1;
+
+			// Wait for earlier messages to be processed until this one fits into the receive buffer
+			double sendTime = wireFree;
+			while (!pending.empty() && (pending.front().processed <= sendTime || bufferUsed + size > std::max(size_t(timing.bufferSize), size)))
+			{
+				sendTime = std::max(sendTime, pending.front().processed);
+				bufferUsed -= pending.front().size;
+				pending.pop_front();
+			}
+
+			const uint32_t tick = static_cast<uint32_t>(std::ceil(sendTime / MIDI_TICK_TIME - 1e-9));
+			sendTime = tick * MIDI_TICK_TIME;
+			wireFree = sendTime + size * WIRE_BYTE_TIME;
+			deviceFree = std::max(wireFree, deviceFree) + timing.messageTime + size * timing.byteTime;
+			pending.push_back({ deviceFree, size });
+			bufferUsed += size;
+
+			func(tick, start, end);
+
+			start = std::find(end, sysExData.end(), uint8_t(0xF0));
+		}
+		return deviceFree;
+	}
+}
+
+SysExTiming SysExTiming::ForDevice(const PatchFormat device)
+{
+	// Both devices need to write the received data to memory and update their display, which is slower than receiving the data.
+	// The receive buffer is assumed to hold just a bit more than one message as written by JDTools.
+	if (device == PatchFormat::JD990)
+		return { 30.0, 0.0, 300 };
+	return { 50.0, 0.0, 300 };
+}
+
+bool SysExTiming::Parse(const std::string_view str, SysExTiming &timing)
+{
+	const size_t firstComma = str.find(','), secondComma = str.find(',', firstComma + 1);
+	if (firstComma == std::string_view::npos || secondComma == std::string_view::npos)
+		return false;
+
+	SysExTiming result;
+	const auto parse = [](const std::string_view part, auto &value)
+	{
+		const auto [ptr, ec] = std::from_chars(part.data(), part.data() + part.size(), value);
+		return ec == std::errc{} && ptr == part.data() + part.size() && value >= 0;
+	};
+	if (!parse(str.substr(0, firstComma), result.messageTime)
+		|| !parse(str.substr(firstComma + 1, secondComma - firstComma - 1), result.byteTime)
+		|| !parse(str.substr(secondComma + 1), result.bufferSize))
+		return false;
+	timing = result;
+	return true;
+}
+
+double SysExTiming::GetMessageCost(const size_t size) const
+{
+	return messageTime + size * (WIRE_BYTE_TIME + byteTime);
+}
+
+double WriteMidiFile(std::ostream &outFile, std::span<const uint8_t> sysExData, const SysExTiming &timing)
+{
+	std::vector<uint8_t> track;
+	// Tempo
+	track.insert(track.end(), { 0x00, 0xFF, 0x51, 0x03, static_cast<uint8_t>(MIDI_TEMPO >> 16), static_cast<uint8_t>(MIDI_TEMPO >> 8), static_cast<uint8_t>(MIDI_TEMPO) });
+
+	uint32_t lastTick = 0;
+	const double deviceFree = ScheduleSysEx(sysExData, timing, [&](const uint32_t tick, const auto start, const auto end)
+	{
+		WriteVarInt(track, tick - lastTick);
+		track.push_back(0xF0);
+		WriteVarInt(track, static_cast<uint32_t>(std::distance(start, end)));
+		track.insert(track.end(), start + 1, end + 1);
+		lastTick = tick;
+	});
+
+	// End of track
+	track.insert(track.end(), { 0x00, 0xFF, 0x2F, 0x00 });
+
+	std::vector<uint8_t> header = { 'M', 'T', 'h', 'd' };
+	WriteUint32BE(header, 6);
+	header.insert(header.end(), { 0x00, 0x00, 0x00, 0x01, static_cast<uint8_t>(MIDI_TICKS_PER_QUARTER >> 8), static_cast<uint8_t>(MIDI_TICKS_PER_QUARTER & 0xFF) });
+	header.insert(header.end(), { 'M', 'T', 'r', 'k' });
+	WriteUint32BE(header, static_cast<uint32_t>(track.size()));
+	outFile.write(reinterpret_cast<const char *>(header.data()), header.size());
+	outFile.write(reinterpret_cast<const char *>(track.data()), track.size());
+	return deviceFree;
+}
+
+double GetSysExTransferTime(std::span<const uint8_t> sysExData, const SysExTiming &timing)
+{
+	return ScheduleSysEx(sysExData, timing, [](uint32_t, auto, auto) {});
+}
+
+MidiFileWriter::MidiFileWriter(std::ostream &outFile, const SysExTiming &timing, std::ostream &messages)
+	: m_outFile{outFile}
+	, m_messages{messages}
+	, m_timing{timing}
+{
+}
+
+MidiFileWriter::~MidiFileWriter()
+{
+	const std::string sysExData = m_sysEx.str();
+	const double duration = WriteMidiFile(m_outFile, std::span<const uint8_t>{reinterpret_cast<const uint8_t *>(sysExData.data()), sysExData.size()}, m_timing);
+	m_messages << "Transferring the MIDI file to the device takes " << (duration / 1000.0) << " seconds." << std::endl;
+}
@@ -0,0 +1,57 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionPlan.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <sstream>
+#include <string_view>
+
+// How long a device needs to process SysEx messages. Used to send messages as fast as possible without overrunning the device.
+struct SysExTiming
+{
+	double messageTime = 0.0;  // Processing time per message in milliseconds, starting once the message has been received completely
+	double byteTime = 0.0;     // Additional processing time per byte in milliseconds
+	uint32_t bufferSize = 0;   // Size of the device's receive buffer in bytes
+
+	// Conservative defaults for the JD-800 and JD-990
+	static SysExTiming ForDevice(const PatchFormat device);
+	// Parses "<message time>,<byte time>,<buffer size>". Returns false if the string is malformed.
+	static bool Parse(const std::string_view str, SysExTiming &timing);
+
+	// Time in milliseconds that a message of the given size (including F0 and F7) keeps the MIDI connection and the device busy,
+	// not taking into account that the device can already receive the next message while processing one.
+	double GetMessageCost(const size_t size) const;
+};
+
+// Writes the SysEx messages (each including F0 and F7) to a Standard MIDI File.
+// Every message is scheduled as early as the MIDI wire speed and the device's receive buffer allow.
+// Returns the time in milliseconds until the device has processed the last message.
+double WriteMidiFile(std::ostream &outFile, std::span<const uint8_t> sysExData, const SysExTiming &timing);
+// Returns the time in milliseconds that sending the SysEx messages takes when they are scheduled like in WriteMidiFile
+double GetSysExTransferTime(std::span<const uint8_t> sysExData, const SysExTiming &timing);
+
+// Collects all SysEx messages written to its stream and writes them to a Standard MIDI File once destroyed.
+// The resulting transfer time is reported to the messages stream.
+class MidiFileWriter
+{
+public:
+	MidiFileWriter(std::ostream &outFile, const SysExTiming &timing, std::ostream &messages);
+	~MidiFileWriter();
+
+	MidiFileWriter(const MidiFileWriter &) = delete;
+	MidiFileWriter &operator=(const MidiFileWriter &) = delete;
+
+	std::ostream &GetStream() { return m_sysEx; }
+
+private:
+	std::ostream &m_outFile;
+	std::ostream &m_messages;
+	const SysExTiming m_timing;
+	std::ostringstream m_sysEx;
+};
@@ -0,0 +1,168 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "OutputArchive.hpp"
+#include "StandardStreams.hpp"
+
+#include "miniz.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	struct CompressedMember
+	{
+		std::string data;
+		void *compressed = nullptr;
+		size_t compressedSize = 0;
+		mz_uint32 crc = 0;
+	};
+
+	class ZipWriter
+	{
+	public:
+		ZipWriter()
+		{
+			m_valid = mz_zip_writer_init_heap(&m_zip, 0, 0);
+		}
+
+		~ZipWriter()
+		{
+			if (m_valid)
+				mz_zip_writer_end(&m_zip);
+		}
+
+		ZipWriter(const ZipWriter &) = delete;
+		ZipWriter &operator=(const ZipWriter &) = delete;
+
+		bool IsValid() const { return m_valid; }
+		mz_zip_archive &operator*() { return m_zip; }
+
+	private:
+		mz_zip_archive m_zip{};
+		bool m_valid = false;
+	};
+
+	std::mutex teeMutex;
+}
+
+std::ostream &OutputArchive::AddMember(const std::string &name)
+{
+	const std::lock_guard lock{m_mutex};
+	auto &member = m_members.emplace_back(std::make_unique<Member>());
+	member->name = name;
+	return member->data;
+}
+
+bool OutputArchive::Write(const std::string &filename) const
+{
+	std::vector<CompressedMember> compressed(m_members.size());
+	for (size_t i = 0; i < m_members.size(); i++)
+	{
+		compressed[i].data = m_members[i]->data.str();
+	}
+
+	// Raw deflate streams are produced independently per member, the ZIP writer only has to store them
+	std::atomic<size_t> nextMember = 0;
+	const auto compressMembers = [&]()
+	{
+		const int flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+		for (size_t i = nextMember++; i < compressed.size(); i = nextMember++)
+		{
+			CompressedMember &member = compressed[i];
+			member.crc = static_cast<mz_uint32>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char *>(member.data.data()), member.data.size()));
+			if (!member.data.empty())
+				member.compressed = tdefl_compress_mem_to_heap(member.data.data(), member.data.size(), &member.compressedSize, flags);
+		}
+	};
+	const size_t numThreads = std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), compressed.size());
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < numThreads; i++)
+	{
+		threads.emplace_back(compressMembers);
+	}
+	compressMembers();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	ZipWriter zip;
+	bool success = zip.IsValid();
+	for (size_t i = 0; i < compressed.size() && success; i++)
+	{
+		const CompressedMember &member = compressed[i];
+		const char *name = m_members[i]->name.c_str();
+		if (member.compressed)
+			success = mz_zip_writer_add_mem_ex(&*zip, name, member.compressed, member.compressedSize, nullptr, 0, MZ_ZIP_FLAG_COMPRESSED_DATA, member.data.size(), member.crc);
+		else
+			success = mz_zip_writer_add_mem(&*zip, name, member.data.data(), member.data.size(), MZ_NO_COMPRESSION);
+	}
+	for (auto &member : compressed)
+	{
+		mz_free(member.compressed);
+	}
+
+	void *archiveData = nullptr;
+	size_t archiveSize = 0;
+	if (success)
+		success = mz_zip_writer_finalize_heap_archive(&*zip, &archiveData, &archiveSize);
+	if (success && IsStandardStream(filename))
+	{
+		std::ostream &outFile = OpenStandardOutput();
+		outFile.write(static_cast<const char *>(archiveData), archiveSize);
+		success = outFile.flush().good();
+	}
+	else if (success)
+	{
+		std::ofstream outFile{filename, std::ios::trunc | std::ios::binary};
+		outFile.write(static_cast<const char *>(archiveData), archiveSize);
+		success = outFile.good();
+	}
+	mz_free(archiveData);
+	if (!success)
+		std::cout << "Could not write " << filename << "!" << std::endl;
+	return success;
+}
+
+StreamTee::StreamTee(std::ostream &stream, std::ostream &copy)
+	: m_stream{stream}
+	, m_original{stream.rdbuf()}
+	, m_copy{copy.rdbuf()}
+{
+	m_stream.rdbuf(this);
+}
+
+StreamTee::~StreamTee()
+{
+	m_stream.rdbuf(m_original);
+}
+
+int StreamTee::overflow(int c)
+{
+	if (c == traits_type::eof())
+		return traits_type::not_eof(c);
+	const std::lock_guard lock{teeMutex};
+	if (m_original->sputc(static_cast<char>(c)) == traits_type::eof() || m_copy->sputc(static_cast<char>(c)) == traits_type::eof())
+		return traits_type::eof();
+	return c;
+}
+
+std::streamsize StreamTee::xsputn(const char *s, std::streamsize count)
+{
+	const std::lock_guard lock{teeMutex};
+	m_copy->sputn(s, count);
+	return m_original->sputn(s, count);
+}
+
+int StreamTee::sync()
+{
+	const std::lock_guard lock{teeMutex};
+	return (m_original->pubsync() == 0 && m_copy->pubsync() == 0) ? 0 : -1;
+}
@@ -0,0 +1,57 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Collects all files written by a single invocation and stores them as members of one ZIP archive
+class OutputArchive
+{
+public:
+	// Returns the stream to write the member's contents to. It stays valid until the archive is written.
+	// Members may be added from several threads at once, but each stream must only be written to by one thread.
+	std::ostream &AddMember(const std::string &name);
+
+	// Members are compressed in parallel, then the archive is assembled and written in one go.
+	// Prints an error message and returns false if the archive could not be written.
+	bool Write(const std::string &filename) const;
+
+private:
+	struct Member
+	{
+		std::string name;
+		std::ostringstream data;
+	};
+
+	std::vector<std::unique_ptr<Member>> m_members;
+	std::mutex m_mutex;
+};
+
+// Duplicates all output written to a stream (e.g. std::cout) into another stream until destroyed.
+// All tees share a lock, so several of them can write into the same copy from different threads.
+class StreamTee : private std::streambuf
+{
+public:
+	StreamTee(std::ostream &stream, std::ostream &copy);
+	~StreamTee();
+
+	StreamTee(const StreamTee &) = delete;
+	StreamTee &operator=(const StreamTee &) = delete;
+
+private:
+	int overflow(int c) override;
+	std::streamsize xsputn(const char *s, std::streamsize count) override;
+	int sync() override;
+
+	std::ostream &m_stream;
+	std::streambuf *m_original;
+	std::streambuf *m_copy;
+};
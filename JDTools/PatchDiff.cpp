@@ -0,0 +1,227 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchDiff.hpp"
+#include "ConversionContext.hpp"
+#include "InputArchive.hpp"
+#include "JDTools.hpp"
+#include "PatchLibrary.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	// The part of the patch data that is compared. For VST patches, this is the part that is stored in SVZ and SVD files.
+	std::string_view GetComparedBytes(const PatchFormat format, const std::vector<uint8_t> &data)
+	{
+		if (format == PatchFormat::VST)
+		{
+			const PatchVST &pVST = *reinterpret_cast<const PatchVST *>(data.data());
+			return { reinterpret_cast<const char *>(&pVST.name), 2048 - sizeof(pVST.zenHeader) };
+		}
+		return { reinterpret_cast<const char *>(data.data()), data.size() };
+	}
+
+	// Of two formats, the one that can represent less information: JD-990 patches can hold everything a JD-800 patch can, and JD-800 patches can hold everything a VST patch can
+	PatchFormat GetComparisonFormat(const PatchFormat formatA, const PatchFormat formatB)
+	{
+		if (formatA == PatchFormat::VST || formatB == PatchFormat::VST)
+			return PatchFormat::VST;
+		if (formatA == PatchFormat::JD800 || formatB == PatchFormat::JD800)
+			return PatchFormat::JD800;
+		return PatchFormat::JD990;
+	}
+
+	// Converts the patch into the comparison format by way of the other patch's format
+	std::vector<uint8_t> NormalizePatch(const LibraryPatch &patch, const PatchFormat otherFormat, const PatchFormat comparisonFormat, ConversionContext &context)
+	{
+		std::vector<uint8_t> data = patch.data;
+		PatchFormat format = patch.format;
+		for (const PatchFormat nextFormat : { otherFormat, comparisonFormat })
+		{
+			if (nextFormat == format)
+				continue;
+			std::vector<uint8_t> converted(GetPatchSize(nextFormat));
+			ConversionPlan{format, nextFormat}.Convert(data.data(), converted.data(), context);
+			data = std::move(converted);
+			format = nextFormat;
+		}
+		return data;
+	}
+
+	// Both patches in the same format. If they already share a format, their own data is referenced instead of being copied.
+	class NormalizedPatches
+	{
+	public:
+		NormalizedPatches(const LibraryPatch &patchA, const LibraryPatch &patchB, ConversionContext &context)
+			: m_format{patchA.format}
+			, m_dataA{&patchA.data}
+			, m_dataB{&patchB.data}
+		{
+			if (patchA.format == patchB.format)
+				return;
+			m_format = GetComparisonFormat(patchA.format, patchB.format);
+			m_convertedA = NormalizePatch(patchA, patchB.format, m_format, context);
+			m_convertedB = NormalizePatch(patchB, patchA.format, m_format, context);
+			m_dataA = &m_convertedA;
+			m_dataB = &m_convertedB;
+		}
+
+		NormalizedPatches(const NormalizedPatches &) = delete;
+		NormalizedPatches &operator=(const NormalizedPatches &) = delete;
+
+		PatchFormat GetFormat() const noexcept { return m_format; }
+		const std::vector<uint8_t> &GetDataA() const noexcept { return *m_dataA; }
+		const std::vector<uint8_t> &GetDataB() const noexcept { return *m_dataB; }
+
+		bool Differ() const
+		{
+			return GetComparedBytes(m_format, *m_dataA) != GetComparedBytes(m_format, *m_dataB);
+		}
+
+	private:
+		PatchFormat m_format;
+		const std::vector<uint8_t> *m_dataA, *m_dataB;
+		std::vector<uint8_t> m_convertedA, m_convertedB;
+	};
+
+	std::string PrintPatchData(const PatchFormat format, const std::vector<uint8_t> &data)
+	{
+		std::ostringstream out;
+		switch (format)
+		{
+		case PatchFormat::JD800: PrintPatch(out, *reinterpret_cast<const Patch800 *>(data.data())); break;
+		case PatchFormat::JD990: PrintPatch(out, *reinterpret_cast<const Patch990 *>(data.data())); break;
+		case PatchFormat::VST: PrintPatch(out, *reinterpret_cast<const PatchVST *>(data.data())); break;
+		}
+		return std::move(out).str();
+	}
+
+	std::string_view NextLine(std::string_view &text)
+	{
+		const auto lineEnd = text.find('\n');
+		const std::string_view line = text.substr(0, lineEnd);
+		text.remove_prefix((lineEnd != std::string_view::npos) ? lineEnd + 1 : text.size());
+		return line;
+	}
+
+	// Both patches are printed as in list-verbose mode and compared line by line.
+	// Section headings are remembered so that each difference can be printed with its full parameter path.
+	size_t PrintParameterDifferences(const PatchFormat format, const std::vector<uint8_t> &dataA, const std::vector<uint8_t> &dataB)
+	{
+		const std::string textA = PrintPatchData(format, dataA), textB = PrintPatchData(format, dataB);
+		std::string_view remainA = textA, remainB = textB;
+		std::vector<std::string_view> sections;
+		size_t numDifferences = 0;
+		while (!remainA.empty() || !remainB.empty())
+		{
+			const std::string_view lineA = NextLine(remainA), lineB = NextLine(remainB);
+			const std::string_view propertyA = lineA.substr(std::min(lineA.find_first_not_of('\t'), lineA.size()));
+			const size_t depth = lineA.size() - propertyA.size();
+			const auto separator = propertyA.find(": ");
+			if (separator == std::string_view::npos)
+			{
+				sections.resize(std::max(depth, size_t(1)) - 1);
+				sections.push_back(propertyA);
+				continue;
+			}
+			if (lineA == lineB)
+				continue;
+
+			numDifferences++;
+			std::cout << "  ";
+			for (size_t i = 0; i + 1 < depth && i < sections.size(); i++)
+			{
+				std::cout << sections[i] << " / ";
+			}
+			const std::string_view propertyB = lineB.substr(std::min(lineB.find_first_not_of('\t'), lineB.size()));
+			if (propertyB.substr(0, separator + 2) == propertyA.substr(0, separator + 2))
+				std::cout << propertyA << " -> " << propertyB.substr(separator + 2) << "\n";
+			else
+				std::cout << propertyA << " -> " << propertyB << "\n";
+		}
+		return numDifferences;
+	}
+}
+
+bool PatchesDiffer(const LibraryPatch &patchA, const LibraryPatch &patchB, ConversionContext &context)
+{
+	return NormalizedPatches{patchA, patchB, context}.Differ();
+}
+
+int RunDiff(const std::string &filenameA, const std::string &filenameB)
+{
+	std::vector<LibraryPatch> patchesA, patchesB;
+	for (const auto &[filename, patches] : { std::pair{&filenameA, &patchesA}, std::pair{&filenameB, &patchesB} })
+	{
+		const std::vector<InputSource> sources = OpenInputSources(*filename);
+		if (sources.empty())
+			return 2;
+		if (sources.size() > 1)
+		{
+			std::cout << *filename << " contains several patch files, please specify one of them as " << *filename << ":<file>" << std::endl;
+			return 2;
+		}
+		*patches = LoadLibraryFile(*sources.front().stream, std::cerr);
+		if (patches->empty())
+		{
+			std::cout << "No patches found in " << *filename << "!" << std::endl;
+			return 2;
+		}
+	}
+
+	// Differences are listed anyway, so warnings about lost information are not printed
+	ConversionContext context;
+	size_t numCompared = 0, numDifferent = 0, numUnmatched = 0;
+	auto patchA = patchesA.begin(), patchB = patchesB.begin();
+	while (patchA != patchesA.end() || patchB != patchesB.end())
+	{
+		if (patchB == patchesB.end() || (patchA != patchesA.end() && patchA->slot < patchB->slot))
+		{
+			std::cout << GetLibrarySlotName(patchA->format, patchA->slot, static_cast<uint32_t>(patchesA.size())) << ": Only in " << filenameA << "\n";
+			numUnmatched++;
+			patchA++;
+			continue;
+		}
+		if (patchA == patchesA.end() || patchB->slot < patchA->slot)
+		{
+			std::cout << GetLibrarySlotName(patchB->format, patchB->slot, static_cast<uint32_t>(patchesB.size())) << ": Only in " << filenameB << "\n";
+			numUnmatched++;
+			patchB++;
+			continue;
+		}
+
+		const NormalizedPatches normalized{*patchA, *patchB, context};
+
+		numCompared++;
+		if (normalized.Differ())
+		{
+			numDifferent++;
+			const auto trim = [](const std::string_view name) { return name.substr(0, name.find_last_not_of(' ') + 1); };
+			const std::string_view nameA = trim(patchA->GetName()), nameB = trim(patchB->GetName());
+			std::cout << GetLibrarySlotName(patchA->format, patchA->slot, static_cast<uint32_t>(patchesA.size())) << ": " << nameA;
+			if (nameA != nameB)
+				std::cout << " -> " << nameB;
+			std::cout << "\n";
+			if (!PrintParameterDifferences(normalized.GetFormat(), normalized.GetDataA(), normalized.GetDataB()) && nameA == nameB)
+				std::cout << "  (only internal data differs)\n";
+		}
+		patchA++;
+		patchB++;
+	}
+
+	std::cout << numDifferent << " of " << numCompared << " patches differ";
+	if (numUnmatched)
+		std::cout << ", " << numUnmatched << " patches only exist in one of the files";
+	std::cout << "." << std::endl;
+	return (numDifferent || numUnmatched) ? 1 : 0;
+}
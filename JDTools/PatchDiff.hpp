@@ -0,0 +1,19 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <string>
+
+class ConversionContext;
+struct LibraryPatch;
+
+// Compares the patches of two files slot by slot and prints all parameters that differ.
+// Returns the process exit code: 0 if all patches are identical, 1 if there are differences, 2 if a file could not be read.
+int RunDiff(const std::string &filenameA, const std::string &filenameB);
+
+// Returns true if the diff verb would report the two patches as different.
+// Patches of different formats are compared in the format that can represent less information, after passing both of them through the other patch's format.
+// That way, fields that are not preserved by the conversion between the two formats are normalized on both sides, and the result does not depend on the order of the patches.
+bool PatchesDiffer(const LibraryPatch &patchA, const LibraryPatch &patchB, ConversionContext &context);
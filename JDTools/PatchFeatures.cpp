@@ -0,0 +1,334 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchFeatures.hpp"
+#include "InputArchive.hpp"
+#include "MappedFile.hpp"
+#include "PatchFingerprint.hpp"
+#include "PatchIndex.hpp"
+#include "PatchLibrary.hpp"
+
+#include "JD-800.hpp"
+#include "PrecomputedTablesVST.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+	class FeatureWriter
+	{
+	public:
+		constexpr explicit FeatureWriter(PatchFeatures &features)
+			: m_features{features}
+		{
+		}
+
+		constexpr size_t GetPosition() const noexcept { return m_position; }
+
+		// Linear parameter in the range 0...maxValue
+		constexpr void Add(const int value, const int maxValue)
+		{
+			m_features[m_position++] = static_cast<uint8_t>(std::clamp(value, 0, maxValue) * 255 / maxValue);
+		}
+
+		// Parameter that is mapped through a lookup table
+		template<typename T, size_t N>
+		constexpr void Add(const T (&table)[N], const uint8_t value)
+		{
+			const auto [minValue, maxValue] = std::minmax_element(std::begin(table), std::end(table));
+			Add(SafeTable(table, value) - *minValue, *maxValue - *minValue);
+		}
+
+		// Parameter that is stored with an offset of 50 and mapped through a lookup table using its absolute value
+		template<typename T, size_t N>
+		constexpr void AddSigned(const T (&table)[N], const uint8_t value)
+		{
+			const int offset = value - 50;
+			const int maxValue = *std::max_element(std::begin(table), std::end(table));
+			const int tableValue = SafeTable(table, static_cast<uint8_t>((offset < 0) ? -offset : offset));
+			Add(maxValue + ((offset < 0) ? -tableValue : tableValue), 2 * maxValue);
+		}
+
+	private:
+		PatchFeatures &m_features;
+		size_t m_position = 0;
+	};
+
+	constexpr void AddLFOFeatures(FeatureWriter &writer, const Tone800::LFO &lfo)
+	{
+		writer.Add(LFORates, lfo.rate);
+		writer.Add(LFODelay, lfo.delay);
+		writer.AddSigned(LFOFade, lfo.fade);
+		writer.Add(lfo.waveform, 4);
+		writer.Add(lfo.offset, 2);
+		writer.Add(lfo.keyTrigger, 1);
+	}
+
+	constexpr void AddToneFeatures(FeatureWriter &writer, const Tone800 &tone, const uint8_t keyRangeLow, const uint8_t keyRangeHigh)
+	{
+		writer.Add(keyRangeLow, 127);
+		writer.Add(keyRangeHigh, 127);
+
+		writer.Add(tone.common.velocityCurve, 3);
+		writer.Add(tone.common.holdControl, 1);
+
+		AddLFOFeatures(writer, tone.lfo1);
+		AddLFOFeatures(writer, tone.lfo2);
+
+		writer.Add(tone.wg.waveSource, 2);
+		writer.Add((tone.wg.waveformMSB << 7) | tone.wg.waveformLSB, 255);
+		writer.Add(tone.wg.pitchCoarse, 96);
+		writer.Add(tone.wg.pitchFine, 100);
+		writer.Add(PitchRandom, tone.wg.pitchRandom);
+		writer.Add(PitchKF, tone.wg.keyFollow);
+		writer.Add(tone.wg.benderSwitch, 1);
+		writer.Add(tone.wg.aTouchBend, 1);
+		writer.Add(tone.wg.lfo1Sens, 100);
+		writer.Add(tone.wg.lfo2Sens, 100);
+		writer.Add(tone.wg.leverSens, 100);
+		writer.Add(tone.wg.aTouchModSens, 100);
+
+		writer.AddSigned(EnvVelo, tone.pitchEnv.velo);
+		writer.AddSigned(EnvVelo, tone.pitchEnv.timeVelo);
+		writer.Add(tone.pitchEnv.timeKF, 20);
+		writer.AddSigned(PitchEnvLevels, tone.pitchEnv.level0);
+		writer.Add(PitchEnvTime, tone.pitchEnv.time1);
+		writer.AddSigned(PitchEnvLevels, tone.pitchEnv.level1);
+		writer.Add(PitchEnvTime, tone.pitchEnv.time2);
+		writer.Add(PitchEnvTime, tone.pitchEnv.time3);
+		writer.AddSigned(PitchEnvLevels, tone.pitchEnv.level2);
+
+		writer.Add(tone.tvf.filterMode, 2);
+		writer.Add(Cutoff, tone.tvf.cutoffFreq);
+		writer.Add(Resonance, tone.tvf.resonance);
+		writer.Add(tone.tvf.keyFollow, 50);
+		writer.Add(tone.tvf.aTouchSens, 100);
+		writer.Add(tone.tvf.lfoSelect, 1);
+		writer.Add(tone.tvf.lfoDepth, 100);
+		writer.AddSigned(EnvVelo, tone.tvf.envDepth);
+
+		writer.AddSigned(EnvVelo, tone.tvfEnv.velo);
+		writer.AddSigned(EnvVelo, tone.tvfEnv.timeVelo);
+		writer.Add(tone.tvfEnv.timeKF, 20);
+		writer.Add(TVFEnvTime1, tone.tvfEnv.time1);
+		writer.Add(TVFEnvLevels, tone.tvfEnv.level1);
+		writer.Add(TVFEnvTime2, tone.tvfEnv.time2);
+		writer.Add(TVFEnvLevels, tone.tvfEnv.level2);
+		writer.Add(TVFEnvTime3, tone.tvfEnv.time3);
+		writer.Add(TVFEnvLevels, tone.tvfEnv.sustainLevel);
+		writer.Add(TVFEnvTime4, tone.tvfEnv.time4);
+		writer.Add(TVFEnvLevels, tone.tvfEnv.level4);
+
+		writer.Add(tone.tva.biasDirection, 2);
+		writer.Add(tone.tva.biasPoint, 127);
+		writer.Add(BiasLevel, tone.tva.biasLevel);
+		writer.Add(tone.tva.level, 100);
+		writer.Add(AtouchSensTVA, tone.tva.aTouchSens);
+		writer.Add(tone.tva.lfoSelect, 1);
+		writer.Add(tone.tva.lfoDepth, 100);
+
+		writer.AddSigned(EnvVelo, tone.tvaEnv.velo);
+		writer.AddSigned(EnvVelo, tone.tvaEnv.timeVelo);
+		writer.Add(tone.tvaEnv.timeKF, 20);
+		writer.Add(TVAEnvTime1, tone.tvaEnv.time1);
+		writer.Add(TVAEnvLevels, tone.tvaEnv.level1);
+		writer.Add(TVAEnvTime2, tone.tvaEnv.time2);
+		writer.Add(TVAEnvLevels, tone.tvaEnv.level2);
+		writer.Add(TVAEnvTime34, tone.tvaEnv.time3);
+		writer.Add(TVAEnvLevels, tone.tvaEnv.sustainLevel);
+		writer.Add(TVAEnvTime34, tone.tvaEnv.time4);
+	}
+
+	constexpr void AddCommonFeatures(FeatureWriter &writer, const Patch800 &p800)
+	{
+		writer.Add(p800.common.patchLevel, 100);
+		writer.Add(p800.common.benderRangeDown, 48);
+		writer.Add(p800.common.benderRangeUp, 12);
+		writer.Add(ATouchBend, p800.common.aTouchBend);
+		writer.Add(p800.common.soloSW, 1);
+		writer.Add(p800.common.soloLegato, 1);
+		writer.Add(p800.common.portamentoSW, 1);
+		writer.Add(p800.common.portamentoMode, 1);
+		writer.Add(PortaTime, p800.common.portamentoTime);
+
+		writer.Add(EQLowFreq, p800.eq.lowFreq);
+		writer.Add(p800.eq.lowGain, 30);
+		writer.Add(EQMidFreq, p800.eq.midFreq);
+		writer.Add(EQMidQ, p800.eq.midQ);
+		writer.Add(p800.eq.midGain, 30);
+		writer.Add(EQHighFreq, p800.eq.highFreq);
+		writer.Add(p800.eq.highGain, 30);
+
+		const Patch800::Effect &effect = p800.effect;
+		writer.Add(effect.groupAsequence, 23);
+		writer.Add(effect.groupBsequence, 5);
+		writer.Add(effect.groupAblockSwitch1, 1);
+		writer.Add(effect.groupAblockSwitch2, 1);
+		writer.Add(effect.groupAblockSwitch3, 1);
+		writer.Add(effect.groupAblockSwitch4, 1);
+		writer.Add(effect.groupBblockSwitch1, 1);
+		writer.Add(effect.groupBblockSwitch2, 1);
+		writer.Add(effect.groupBblockSwitch3, 1);
+		writer.Add(effect.effectsBalanceGroupB, 100);
+
+		writer.Add(effect.distortionType, 6);
+		writer.Add(effect.distortionDrive, 100);
+		writer.Add(effect.distortionLevel, 100);
+
+		writer.Add(effect.phaserManual, 99);
+		writer.Add(effect.phaserRate, 99);
+		writer.Add(effect.phaserDepth, 100);
+		writer.Add(effect.phaserResonance, 100);
+		writer.Add(effect.phaserMix, 100);
+
+		writer.Add(effect.spectrumBand1, 30);
+		writer.Add(effect.spectrumBand2, 30);
+		writer.Add(effect.spectrumBand3, 30);
+		writer.Add(effect.spectrumBand4, 30);
+		writer.Add(effect.spectrumBand5, 30);
+		writer.Add(effect.spectrumBand6, 30);
+		writer.Add(effect.spectrumBandwidth, 4);
+
+		writer.Add(effect.enhancerSens, 100);
+		writer.Add(effect.enhancerMix, 100);
+
+		writer.Add(effect.delayCenterTap, 125);
+		writer.Add(effect.delayCenterLevel, 100);
+		writer.Add(effect.delayLeftTap, 125);
+		writer.Add(effect.delayLeftLevel, 100);
+		writer.Add(effect.delayRightTap, 125);
+		writer.Add(effect.delayRightLevel, 100);
+		writer.Add(effect.delayFeedback, 98);
+
+		writer.Add(effect.chorusRate, 99);
+		writer.Add(effect.chorusDepth, 100);
+		writer.Add(effect.chorusDelayTime, 99);
+		writer.Add(effect.chorusFeedback, 98);
+		writer.Add(effect.chorusLevel, 100);
+
+		writer.Add(effect.reverbType, 9);
+		writer.Add(effect.reverbPreDelay, 120);
+		writer.Add(effect.reverbEarlyRefLevel, 100);
+		writer.Add(effect.reverbHFDamp, 16);
+		writer.Add(effect.reverbTime, 100);
+		writer.Add(effect.reverbLevel, 100);
+	}
+
+	constexpr size_t WritePatchFeatures(PatchFeatures &features, const Patch800 &p800)
+	{
+		FeatureWriter writer{features};
+		AddToneFeatures(writer, p800.toneA, p800.common.keyRangeLowA, p800.common.keyRangeHighA);
+		AddToneFeatures(writer, p800.toneB, p800.common.keyRangeLowB, p800.common.keyRangeHighB);
+		AddToneFeatures(writer, p800.toneC, p800.common.keyRangeLowC, p800.common.keyRangeHighC);
+		AddToneFeatures(writer, p800.toneD, p800.common.keyRangeLowD, p800.common.keyRangeHighD);
+		AddCommonFeatures(writer, p800);
+		return writer.GetPosition();
+	}
+
+	// Evaluating the writers at compile time catches NUM_TONE_FEATURES / NUM_COMMON_FEATURES getting out of sync with them
+	constexpr size_t CountPatchFeatures()
+	{
+		PatchFeatures features{};
+		return WritePatchFeatures(features, Patch800{});
+	}
+	static_assert(CountPatchFeatures() == NUM_PATCH_FEATURES, "Feature count mismatch");
+}
+
+PatchFeatures GetPatchFeatures(const Patch800 &p800)
+{
+	PatchFeatures features{};
+	WritePatchFeatures(features, p800);
+	return features;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> FindSimilarPatches(const PatchIndexView &index, const PatchFeatures &features, const size_t count)
+{
+	// The feature table is stored column by column, so the distances are accumulated one feature at a time.
+	// The inner loop has no dependencies between patches, so the compiler can vectorize it.
+	const size_t numPatches = index.patches.size();
+	std::vector<uint32_t> distances(numPatches, 0);
+	for (size_t feature = 0; feature < NUM_PATCH_FEATURES; feature++)
+	{
+		const uint8_t *column = index.features.data() + feature * numPatches;
+		uint32_t *distance = distances.data();
+		const int32_t value = features[feature];
+		for (size_t patch = 0; patch < numPatches; patch++)
+		{
+			const int32_t diff = column[patch] - value;
+			distance[patch] += static_cast<uint32_t>(diff * diff);
+		}
+	}
+
+	std::vector<uint32_t> order(numPatches);
+	std::iota(order.begin(), order.end(), 0u);
+	const size_t numResults = std::min(count, numPatches);
+	std::partial_sort(order.begin(), order.begin() + numResults, order.end(), [&distances](const uint32_t l, const uint32_t r)
+	{
+		return distances[l] < distances[r] || (distances[l] == distances[r] && l < r);
+	});
+
+	std::vector<std::pair<uint32_t, uint32_t>> result;
+	result.reserve(numResults);
+	for (size_t i = 0; i < numResults; i++)
+	{
+		result.emplace_back(order[i], distances[order[i]]);
+	}
+	return result;
+}
+
+int RunSimilar(const std::string &indexFilename, const std::string &patchFilename, const std::string &slotName, const size_t count)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const MappedFile mappedFile{indexFilename};
+	PatchIndexView index;
+	if (!mappedFile.IsValid() || !ParsePatchIndex(mappedFile.GetData(), mappedFile.GetSize(), index))
+	{
+		std::cout << "Could not read index file " << indexFilename << "! Run the index verb to create or update it." << std::endl;
+		return 2;
+	}
+
+	const std::vector<InputSource> sources = OpenInputSources(patchFilename);
+	if (sources.empty())
+		return 2;
+	if (sources.size() > 1)
+	{
+		std::cout << patchFilename << " contains several patch files, please specify one of them as " << patchFilename << ":<file>" << std::endl;
+		return 2;
+	}
+	const std::vector<LibraryPatch> patches = LoadLibraryFile(*sources.front().stream, std::cerr);
+	const auto patch = std::find_if(patches.begin(), patches.end(), [&](const LibraryPatch &p)
+	{
+		const std::string name = GetLibrarySlotName(p.format, p.slot, static_cast<uint32_t>(patches.size()));
+		return std::equal(name.begin(), name.end(), slotName.begin(), slotName.end(), [](const char l, const char r) { return std::toupper(static_cast<unsigned char>(l)) == std::toupper(static_cast<unsigned char>(r)); });
+	});
+	if (patch == patches.end())
+	{
+		std::cout << "Patch " << slotName << " not found in " << patchFilename << "!" << std::endl;
+		return 1;
+	}
+
+	PatchFingerprinter fingerprinter;
+	const PatchFeatures features = GetPatchFeatures(fingerprinter.GetNormalizedPatch(*patch));
+
+	const auto nearest = FindSimilarPatches(index, features, count);
+	const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	std::string_view patchName = patch->GetName();
+	patchName = patchName.substr(0, patchName.find_last_not_of(' ') + 1);
+	std::cout << "Patches similar to " << patchName << ":\n";
+	for (const auto &[patchNumber, distance] : nearest)
+	{
+		const PatchIndexPatch &entry = index.patches[patchNumber];
+		const PatchIndexFile &file = index.files[entry.file];
+		std::cout << index.GetPath(file) << " " << GetLibrarySlotName(static_cast<PatchFormat>(entry.format), entry.slot, file.numPatches) << ": " << ToString(entry.name) << " (distance " << distance << ")\n";
+	}
+	std::cout << "Searched " << index.patches.size() << " patches in " << milliseconds << " ms." << std::endl;
+	return 0;
+}
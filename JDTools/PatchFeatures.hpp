@@ -0,0 +1,32 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Patch800;
+struct PatchIndexView;
+
+constexpr size_t NUM_TONE_FEATURES = 73;
+constexpr size_t NUM_COMMON_FEATURES = 61;
+constexpr size_t NUM_PATCH_FEATURES = 4 * NUM_TONE_FEATURES + NUM_COMMON_FEATURES;
+
+// All sound-relevant parameters of a patch, each scaled to 0...255.
+// Parameters that the JD-08 / VST conversion maps through a lookup table are scaled according to that table,
+// so that e.g. a difference in envelope times is weighted by how much the actual time differs.
+using PatchFeatures = std::array<uint8_t, NUM_PATCH_FEATURES>;
+
+// The patch should be normalized with NormalizePatch800 first, so that disabled tones do not contribute to the features
+PatchFeatures GetPatchFeatures(const Patch800 &p800);
+
+// Returns the patch numbers and squared feature distances of the patches in the index that are closest to the given features, closest first
+std::vector<std::pair<uint32_t, uint32_t>> FindSimilarPatches(const PatchIndexView &index, const PatchFeatures &features, const size_t count);
+
+// Lists the patches in the index that are most similar to a patch in the given file. Returns the process exit code.
+int RunSimilar(const std::string &indexFilename, const std::string &patchFilename, const std::string &slotName, const size_t count);
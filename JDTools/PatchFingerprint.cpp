@@ -0,0 +1,141 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchFingerprint.hpp"
+#include "PatchLibrary.hpp"
+
+#include "JD-800.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+PatchFingerprinter::PatchFingerprinter()
+	: m_patch{std::make_unique<Patch800>()}
+{
+	for (const PatchFormat source : { PatchFormat::JD800, PatchFormat::JD990, PatchFormat::VST })
+	{
+		m_plans[static_cast<size_t>(source)] = std::make_unique<ConversionPlan>(source, PatchFormat::JD800);
+	}
+}
+
+PatchFingerprinter::~PatchFingerprinter() = default;
+
+const Patch800 &PatchFingerprinter::GetNormalizedPatch(const LibraryPatch &patch)
+{
+	m_plans[static_cast<size_t>(patch.format)]->Convert(patch.data.data(), m_patch.get(), m_context);
+	NormalizePatch800(*m_patch);
+	return *m_patch;
+}
+
+uint64_t PatchFingerprinter::GetFingerprint(const LibraryPatch &patch)
+{
+	return HashFNV1a(&GetNormalizedPatch(patch), sizeof(Patch800));
+}
+
+void NormalizePatch800(Patch800 &p800)
+{
+	p800.common.name = {};
+	p800.midiTx.dummy = 0;
+	p800.effect.dummy = 0;
+
+	// A tone can only be heard if it is both part of the layer and switched on
+	const uint8_t enabledTones = p800.common.layerTone & p800.common.activeTone & 0x0F;
+	p800.common.layerTone = enabledTones;
+	p800.common.activeTone = enabledTones;
+
+	Tone800 *tones[] = { &p800.toneA, &p800.toneB, &p800.toneC, &p800.toneD };
+	std::pair<uint8_t &, uint8_t &> keyRanges[] =
+	{
+		{ p800.common.keyRangeLowA, p800.common.keyRangeHighA },
+		{ p800.common.keyRangeLowB, p800.common.keyRangeHighB },
+		{ p800.common.keyRangeLowC, p800.common.keyRangeHighC },
+		{ p800.common.keyRangeLowD, p800.common.keyRangeHighD },
+	};
+	for (size_t tone = 0; tone < 4; tone++)
+	{
+		if (enabledTones & (1 << tone))
+			continue;
+		*tones[tone] = {};
+		keyRanges[tone].first = 0;
+		keyRanges[tone].second = 0;
+	}
+}
+
+int RunDedupe(const std::string &directory)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::filesystem::path> files;
+	std::error_code ec;
+	for (std::filesystem::recursive_directory_iterator it{directory, std::filesystem::directory_options::skip_permission_denied, ec}, end; it != end; it.increment(ec))
+	{
+		if (!ec && it->is_regular_file(ec) && IsLibraryFile(it->path()))
+			files.push_back(it->path());
+	}
+	if (ec && files.empty())
+	{
+		std::cout << "Could not read directory " << directory << ": " << ec.message() << std::endl;
+		return 2;
+	}
+	std::sort(files.begin(), files.end());
+
+	struct ClusterEntry
+	{
+		uint32_t file;
+		PatchFormat format;
+		uint32_t slot;
+		uint32_t numPatchesInFile;
+		std::string name;
+	};
+	std::vector<std::vector<ClusterEntry>> clusters;
+	std::unordered_map<uint64_t, uint32_t> clusterIndices;
+	size_t numPatches = 0;
+
+	// Only the fingerprints of the patches are kept, so the library is processed one file at a time.
+	// Parser warnings are not of interest here.
+	PatchFingerprinter fingerprinter;
+	std::ostream parserWarnings{nullptr};
+	for (uint32_t file = 0; file < files.size(); file++)
+	{
+		std::ifstream inFile{files[file], std::ios::binary};
+		if (!inFile)
+			continue;
+		const std::vector<LibraryPatch> patches = LoadLibraryFile(inFile, parserWarnings);
+		for (const LibraryPatch &patch : patches)
+		{
+			const auto [cluster, inserted] = clusterIndices.try_emplace(fingerprinter.GetFingerprint(patch), static_cast<uint32_t>(clusters.size()));
+			if (inserted)
+				clusters.emplace_back();
+			clusters[cluster->second].push_back({ file, patch.format, patch.slot, static_cast<uint32_t>(patches.size()), std::string{patch.GetName()} });
+		}
+		numPatches += patches.size();
+	}
+
+	size_t numDuplicateClusters = 0, numDuplicatePatches = 0;
+	for (const auto &cluster : clusters)
+	{
+		if (cluster.size() < 2)
+			continue;
+		numDuplicateClusters++;
+		numDuplicatePatches += cluster.size();
+		std::cout << "Duplicate group " << numDuplicateClusters << " (" << cluster.size() << " patches):\n";
+		for (const ClusterEntry &entry : cluster)
+		{
+			const std::u8string relativePath = std::filesystem::relative(files[entry.file], directory, ec).generic_u8string();
+			std::cout << "  " << std::string_view{reinterpret_cast<const char *>(relativePath.data()), relativePath.size()} << " " << GetLibrarySlotName(entry.format, entry.slot, entry.numPatchesInFile) << ": " << entry.name << "\n";
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Found " << numDuplicateClusters << " groups of identical patches containing " << numDuplicatePatches << " patches. "
+		<< clusters.size() << " distinct patches out of " << numPatches << " patches in " << files.size() << " files, processed in " << seconds << " seconds." << std::endl;
+	return 0;
+}
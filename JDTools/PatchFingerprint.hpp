@@ -0,0 +1,40 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionContext.hpp"
+#include "ConversionPlan.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct LibraryPatch;
+struct Patch800;
+
+// Identifies patches that sound the same, regardless of their name, position and format.
+// All patches are converted to the JD-800 format first. Warnings about lost information are counted but not printed.
+class PatchFingerprinter
+{
+public:
+	PatchFingerprinter();
+	~PatchFingerprinter();
+
+	// The returned patch is only valid until the next call
+	const Patch800 &GetNormalizedPatch(const LibraryPatch &patch);
+	uint64_t GetFingerprint(const LibraryPatch &patch);
+
+private:
+	std::array<std::unique_ptr<ConversionPlan>, 3> m_plans;  // Indexed by source PatchFormat
+	std::unique_ptr<Patch800> m_patch;
+	ConversionContext m_context;
+};
+
+// Removes everything from the patch that does not contribute to its sound: The name, disabled tones and unused bytes
+void NormalizePatch800(Patch800 &p800);
+
+// Reports all groups of identical patches found in the directory and its subdirectories. Returns the process exit code.
+int RunDedupe(const std::string &directory);
@@ -0,0 +1,384 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchIndex.hpp"
+#include "ConversionContext.hpp"
+#include "PatchFingerprint.hpp"
+#include "PatchLibrary.hpp"
+#include "StandardStreams.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+	struct ScannedFile
+	{
+		std::filesystem::path path;
+		std::string relativePath;
+		uint64_t modificationTime = 0;
+		uint64_t fileSize = 0;
+		const PatchIndexFile *previous = nullptr;  // Entry in the previous index if the file did not change
+		std::vector<LibraryPatch> libraryPatches;  // Only kept until the index entries have been created
+		std::vector<PatchIndexPatch> patches;
+		std::vector<PatchFeatures> features;
+	};
+
+	// Runs every conversion that the patch could be subjected to and records which of them report lost information.
+	class LossyConversionCheck
+	{
+	public:
+		LossyConversionCheck()
+			: m_target(sizeof(PatchVST))
+		{
+			for (const PatchFormat source : { PatchFormat::JD800, PatchFormat::JD990, PatchFormat::VST })
+			{
+				for (const PatchFormat target : { PatchFormat::JD800, PatchFormat::JD990, PatchFormat::VST })
+				{
+					if (source != target)
+						m_plans.push_back(std::make_unique<ConversionPlan>(source, target));
+				}
+			}
+		}
+
+		uint8_t GetFlags(const LibraryPatch &patch)
+		{
+			uint8_t flags = 0;
+			for (auto &plan : m_plans)
+			{
+				if (plan->GetSource() != patch.format)
+					continue;
+				const uint64_t numWarnings = m_context.GetNumWarnings();
+				plan->Convert(patch.data.data(), m_target.data(), m_context);
+				if (m_context.GetNumWarnings() != numWarnings)
+					flags |= GetLossyFlag(plan->GetTarget());
+			}
+			return flags;
+		}
+
+	private:
+		std::vector<std::unique_ptr<ConversionPlan>> m_plans;
+		ConversionContext m_context;
+		std::vector<uint8_t> m_target;
+	};
+
+	void ScanFile(ScannedFile &file, std::ostream &warnings)
+	{
+		std::ifstream inFile{file.path, std::ios::binary};
+		if (!inFile)
+			return;
+		file.libraryPatches = LoadLibraryFile(inFile, warnings);
+		for (const LibraryPatch &patch : file.libraryPatches)
+		{
+			file.patches.push_back(MakePatchIndexEntry(patch, 0));
+		}
+	}
+
+	template<typename TTone>
+	void SetToneWaveform(PatchIndexPatch &entry, const size_t tone, const TTone &t)
+	{
+		entry.waveSource[tone] = t.wg.waveSource;
+		entry.waveform[tone] = static_cast<uint16_t>(((t.wg.waveformMSB << 7) | t.wg.waveformLSB) + 1);
+	}
+}
+
+PatchIndexPatch MakePatchIndexEntry(const LibraryPatch &patch, const uint32_t file)
+{
+	PatchIndexPatch entry{};
+	entry.file = file;
+	entry.slot = static_cast<uint16_t>(patch.slot);
+	entry.format = static_cast<uint8_t>(patch.format);
+	const std::string_view name = patch.GetName();
+	std::copy(name.begin(), name.begin() + std::min(name.size(), entry.name.size()), entry.name.begin());
+	entry.hash = patch.GetHash();
+
+	if (patch.format == PatchFormat::JD800)
+	{
+		const Patch800 &p800 = patch.As<Patch800>();
+		entry.layerTones = p800.common.layerTone & 0x0F;
+		SetToneWaveform(entry, 0, p800.toneA);
+		SetToneWaveform(entry, 1, p800.toneB);
+		SetToneWaveform(entry, 2, p800.toneC);
+		SetToneWaveform(entry, 3, p800.toneD);
+	}
+	else if (patch.format == PatchFormat::JD990)
+	{
+		const Patch990 &p990 = patch.As<Patch990>();
+		entry.layerTones = p990.common.layerTone & 0x0F;
+		SetToneWaveform(entry, 0, p990.toneA);
+		SetToneWaveform(entry, 1, p990.toneB);
+		SetToneWaveform(entry, 2, p990.toneC);
+		SetToneWaveform(entry, 3, p990.toneD);
+	}
+	else if (patch.format == PatchFormat::VST)
+	{
+		const PatchVST &pVST = patch.As<PatchVST>();
+		for (size_t tone = 0; tone < 4; tone++)
+		{
+			if (pVST.tone[tone].common.layerEnabled)
+				entry.layerTones |= (1 << tone);
+			// ZenCore swaps waveforms 88 and 89 (see ConvertVSTto800)
+			const uint8_t waveform = pVST.tone[tone].wg.waveformLSB;
+			entry.waveSource[tone] = 0;
+			entry.waveform[tone] = (waveform == 88) ? 89 : ((waveform == 89) ? 88 : waveform);
+		}
+	}
+	for (size_t tone = 0; tone < 4; tone++)
+	{
+		if ((entry.layerTones & (1 << tone)) && entry.waveSource[tone] != 0)
+			entry.flags |= PATCH_CARD_WAVEFORM;
+	}
+	return entry;
+}
+
+bool ReadPatchIndex(std::istream &inFile, PatchIndex &index)
+{
+	PatchIndexHeader header;
+	if (!Read(inFile, header) || !header.IsValid())
+		return false;
+
+	if (!ReadVector(inFile, index.files, header.numFiles)
+		|| !ReadVector(inFile, index.patches, header.numPatches)
+		|| !ReadVector(inFile, index.features, header.numPatches * NUM_PATCH_FEATURES)
+		|| !ReadVector(inFile, index.strings, header.stringTableSize))
+	{
+		return false;
+	}
+
+	for (const auto &file : index.files)
+	{
+		if (uint64_t(file.pathOffset) + file.pathLength > index.strings.size() || uint64_t(file.firstPatch) + file.numPatches > index.patches.size())
+			return false;
+	}
+	return true;
+}
+
+bool ParsePatchIndex(const uint8_t *data, const size_t size, PatchIndexView &index)
+{
+	PatchIndexHeader header;
+	if (size < sizeof(header))
+		return false;
+	std::memcpy(&header, data, sizeof(header));
+	if (!header.IsValid())
+		return false;
+
+	const uint64_t filesSize = uint64_t(header.numFiles) * sizeof(PatchIndexFile);
+	const uint64_t patchesSize = uint64_t(header.numPatches) * sizeof(PatchIndexPatch);
+	const uint64_t featuresSize = uint64_t(header.numPatches) * NUM_PATCH_FEATURES;
+	if (sizeof(header) + filesSize + patchesSize + featuresSize + header.stringTableSize > size)
+		return false;
+
+	data += sizeof(header);
+	index.files = { reinterpret_cast<const PatchIndexFile *>(data), header.numFiles };
+	data += filesSize;
+	index.patches = { reinterpret_cast<const PatchIndexPatch *>(data), header.numPatches };
+	data += patchesSize;
+	index.features = { data, static_cast<size_t>(featuresSize) };
+	data += featuresSize;
+	index.strings = { reinterpret_cast<const char *>(data), header.stringTableSize };
+
+	for (const auto &file : index.files)
+	{
+		if (uint64_t(file.pathOffset) + file.pathLength > index.strings.size() || uint64_t(file.firstPatch) + file.numPatches > index.patches.size())
+			return false;
+	}
+	for (const auto &patch : index.patches)
+	{
+		if (patch.file >= index.files.size())
+			return false;
+	}
+	return true;
+}
+
+void WritePatchIndex(std::ostream &outFile, const PatchIndex &index)
+{
+	PatchIndexHeader header;
+	header.numFiles = static_cast<uint32_t>(index.files.size());
+	header.numPatches = static_cast<uint32_t>(index.patches.size());
+	header.stringTableSize = static_cast<uint32_t>(index.strings.size());
+	Write(outFile, header);
+	WriteVector(outFile, index.files);
+	WriteVector(outFile, index.patches);
+	WriteVector(outFile, index.features);
+	WriteVector(outFile, index.strings);
+}
+
+int RunIndex(const std::string &directory, const std::string &indexFilename)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	PatchIndex previousIndex;
+	std::unordered_map<std::string_view, const PatchIndexFile *> previousFiles;
+	// When writing to standard output, the index is always created from scratch
+	std::ostream *standardOutput = IsStandardStream(indexFilename) ? &OpenStandardOutput() : nullptr;
+	if (!standardOutput)
+	{
+		if (std::ifstream inFile{indexFilename, std::ios::binary}; inFile && ReadPatchIndex(inFile, previousIndex))
+		{
+			for (const auto &file : previousIndex.files)
+			{
+				previousFiles[previousIndex.GetPath(file)] = &file;
+			}
+		}
+	}
+
+	std::vector<ScannedFile> files;
+	std::error_code ec;
+	for (std::filesystem::recursive_directory_iterator it{directory, std::filesystem::directory_options::skip_permission_denied, ec}, end; it != end; it.increment(ec))
+	{
+		if (ec || !it->is_regular_file(ec) || !IsLibraryFile(it->path()))
+			continue;
+
+		ScannedFile &file = files.emplace_back();
+		file.path = it->path();
+		const std::u8string relativePath = std::filesystem::relative(file.path, directory, ec).generic_u8string();
+		file.relativePath.assign(relativePath.begin(), relativePath.end());
+		file.fileSize = it->file_size(ec);
+		file.modificationTime = static_cast<uint64_t>(it->last_write_time(ec).time_since_epoch().count());
+	}
+	if (ec && files.empty())
+	{
+		std::cout << "Could not read directory " << directory << ": " << ec.message() << std::endl;
+		return 2;
+	}
+	std::sort(files.begin(), files.end(), [](const ScannedFile &l, const ScannedFile &r) { return l.relativePath < r.relativePath; });
+
+	std::vector<ScannedFile *> filesToScan;
+	for (auto &file : files)
+	{
+		const auto previous = previousFiles.find(file.relativePath);
+		if (previous != previousFiles.end() && previous->second->fileSize == file.fileSize && previous->second->modificationTime == file.modificationTime)
+			file.previous = previous->second;
+		else
+			filesToScan.push_back(&file);
+	}
+
+	// Files are parsed and checked in parallel. Every file's full patch data is discarded as soon as it has been checked,
+	// so that the full patch data of a large library is never held in memory at once.
+	const size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::atomic<size_t> nextFile = 0;
+	const auto scanFiles = [&]()
+	{
+		// Every thread converts patches with its own plans and conversion context.
+		// Problems with individual files would just be noise for a whole library, so each thread discards the parser warnings.
+		LossyConversionCheck lossyCheck;
+		PatchFingerprinter fingerprinter;
+		std::ostream parserWarnings{nullptr};
+		for (size_t i = nextFile++; i < filesToScan.size(); i = nextFile++)
+		{
+			ScannedFile &file = *filesToScan[i];
+			ScanFile(file, parserWarnings);
+			for (size_t patch = 0; patch < file.patches.size(); patch++)
+			{
+				file.patches[patch].flags |= lossyCheck.GetFlags(file.libraryPatches[patch]);
+				file.features.push_back(GetPatchFeatures(fingerprinter.GetNormalizedPatch(file.libraryPatches[patch])));
+			}
+			file.libraryPatches = {};
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < std::min(numThreads, filesToScan.size()); i++)
+	{
+		threads.emplace_back(scanFiles);
+	}
+	scanFiles();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	PatchIndex index;
+	std::vector<PatchFeatures> features;
+	for (const auto &file : files)
+	{
+		PatchIndexFile &entry = index.files.emplace_back();
+		entry.modificationTime = file.modificationTime;
+		entry.fileSize = file.fileSize;
+		entry.pathOffset = static_cast<uint32_t>(index.strings.size());
+		entry.pathLength = static_cast<uint32_t>(file.relativePath.size());
+		entry.firstPatch = static_cast<uint32_t>(index.patches.size());
+		index.strings.insert(index.strings.end(), file.relativePath.begin(), file.relativePath.end());
+
+		const uint32_t fileIndex = static_cast<uint32_t>(index.files.size() - 1);
+		if (file.previous)
+		{
+			index.patches.insert(index.patches.end(), previousIndex.patches.begin() + file.previous->firstPatch, previousIndex.patches.begin() + file.previous->firstPatch + file.previous->numPatches);
+			const size_t numPreviousPatches = previousIndex.patches.size();
+			for (size_t patch = file.previous->firstPatch; patch < file.previous->firstPatch + file.previous->numPatches; patch++)
+			{
+				PatchFeatures &patchFeatures = features.emplace_back();
+				for (size_t feature = 0; feature < NUM_PATCH_FEATURES; feature++)
+				{
+					patchFeatures[feature] = previousIndex.features[feature * numPreviousPatches + patch];
+				}
+			}
+		}
+		else
+		{
+			index.patches.insert(index.patches.end(), file.patches.begin(), file.patches.end());
+			features.insert(features.end(), file.features.begin(), file.features.end());
+		}
+		for (auto patch = index.patches.begin() + entry.firstPatch; patch != index.patches.end(); patch++)
+		{
+			patch->file = fileIndex;
+		}
+		entry.numPatches = static_cast<uint32_t>(index.patches.size() - entry.firstPatch);
+	}
+
+	const size_t numPatches = index.patches.size();
+	index.features.resize(numPatches * NUM_PATCH_FEATURES);
+	for (size_t patch = 0; patch < numPatches; patch++)
+	{
+		for (size_t feature = 0; feature < NUM_PATCH_FEATURES; feature++)
+		{
+			index.features[feature * numPatches + patch] = features[patch][feature];
+		}
+	}
+
+	if (standardOutput)
+	{
+		WritePatchIndex(*standardOutput, index);
+		if (!standardOutput->flush())
+		{
+			std::cout << "Could not write index to standard output!" << std::endl;
+			return 2;
+		}
+	}
+	else
+	{
+		// Write to a temporary file first so that an interrupted run does not destroy the previous index
+		const std::string tempFilename = indexFilename + ".tmp";
+		{
+			std::ofstream outFile{tempFilename, std::ios::trunc | std::ios::binary};
+			WritePatchIndex(outFile, index);
+			if (!outFile)
+			{
+				std::cout << "Could not write " << tempFilename << "!" << std::endl;
+				return 2;
+			}
+		}
+		std::filesystem::rename(tempFilename, indexFilename, ec);
+		if (ec)
+		{
+			std::cout << "Could not write " << indexFilename << ": " << ec.message() << std::endl;
+			return 2;
+		}
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Indexed " << index.patches.size() << " patches in " << index.files.size() << " files (" << filesToScan.size() << " files scanned) in " << seconds << " seconds." << std::endl;
+	return 0;
+}
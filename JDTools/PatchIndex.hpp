@@ -0,0 +1,120 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionPlan.hpp"
+#include "PatchFeatures.hpp"
+#include "Utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct LibraryPatch;
+
+// The index file consists of the header, followed by all file entries, all patch entries, the patch feature table and finally the string table containing the file paths.
+// The feature table is stored column by column, i.e. first feature 0 of all patches, then feature 1 of all patches, and so on.
+struct PatchIndexHeader
+{
+	static constexpr uint32_t CURRENT_VERSION = 5;
+
+	std::array<char, 4> magic = { 'J', 'D', 'I', 'X' };
+	uint32le version = CURRENT_VERSION;
+	uint32le numFiles = 0;
+	uint32le numPatches = 0;
+	uint32le stringTableSize = 0;
+
+	bool IsValid() const noexcept
+	{
+		static_assert(sizeof(PatchIndexHeader) == 20);
+
+		const PatchIndexHeader expected{};
+		return magic == expected.magic && version == expected.version;
+	}
+};
+
+struct PatchIndexFile
+{
+	uint64le modificationTime;
+	uint64le fileSize;
+	uint32le pathOffset;  // Offset into string table, path is relative to the indexed directory
+	uint32le pathLength;
+	uint32le firstPatch;
+	uint32le numPatches;
+};
+
+enum PatchIndexFlags : uint8_t
+{
+	PATCH_LOSSY_TO_JD800 = 0x01,  // Converting the patch to this format prints conversion warnings
+	PATCH_LOSSY_TO_JD990 = 0x02,
+	PATCH_LOSSY_TO_VST   = 0x04,
+	PATCH_CARD_WAVEFORM  = 0x08,  // At least one enabled tone uses a waveform card
+};
+
+constexpr PatchIndexFlags GetLossyFlag(const PatchFormat target) noexcept
+{
+	switch (target)
+	{
+	case PatchFormat::JD800: return PATCH_LOSSY_TO_JD800;
+	case PatchFormat::JD990: return PATCH_LOSSY_TO_JD990;
+	case PatchFormat::VST: return PATCH_LOSSY_TO_VST;
+	}
+	return PatchIndexFlags{};
+}
+
+struct PatchIndexPatch
+{
+	uint32le file;
+	uint16le slot;  // See LibraryPatch::slot
+	uint8_t format;  // PatchFormat
+	uint8_t layerTones;  // Bit mask of enabled tones
+	uint8_t flags;  // PatchIndexFlags
+	uint8_t reserved;
+	std::array<char, 16> name;
+	uint64le hash;
+	std::array<uint8_t, 4> waveSource;  // Per tone, 0 = internal
+	std::array<uint16le, 4> waveform;   // Per tone, 1-based as shown on the device
+};
+
+struct PatchIndex
+{
+	std::vector<PatchIndexFile> files;
+	std::vector<PatchIndexPatch> patches;
+	std::vector<uint8_t> features;
+	std::vector<char> strings;
+
+	std::string_view GetPath(const PatchIndexFile &file) const
+	{
+		return std::string_view{strings.data() + file.pathOffset, file.pathLength};
+	}
+};
+
+// Read-only view of an index file that is already in memory, e.g. a memory-mapped file
+struct PatchIndexView
+{
+	std::span<const PatchIndexFile> files;
+	std::span<const PatchIndexPatch> patches;
+	std::span<const uint8_t> features;
+	std::string_view strings;
+
+	std::string_view GetPath(const PatchIndexFile &file) const
+	{
+		return strings.substr(file.pathOffset, file.pathLength);
+	}
+};
+
+PatchIndexPatch MakePatchIndexEntry(const LibraryPatch &patch, const uint32_t file);
+
+bool ReadPatchIndex(std::istream &inFile, PatchIndex &index);
+// Returns false if the data is not a valid index file. The view points into the provided data.
+bool ParsePatchIndex(const uint8_t *data, const size_t size, PatchIndexView &index);
+void WritePatchIndex(std::ostream &outFile, const PatchIndex &index);
+
+// Scans the directory recursively and writes all found patches to the index file. Returns the process exit code.
+int RunIndex(const std::string &directory, const std::string &indexFilename);
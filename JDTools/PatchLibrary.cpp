@@ -0,0 +1,183 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchLibrary.hpp"
+#include "InputFile.hpp"
+#include "SVZ.hpp"
+#include "SysExAddresses.hpp"
+#include "SysExImage.hpp"
+#include "Utils.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+
+namespace
+{
+	template<typename T>
+	void AddPatch(std::vector<LibraryPatch> &patches, const PatchFormat format, const uint32_t slot, const uint8_t *data)
+	{
+		LibraryPatch &patch = patches.emplace_back();
+		patch.format = format;
+		patch.slot = slot;
+		patch.data.assign(data, data + sizeof(T));
+	}
+
+	std::vector<LibraryPatch> LoadSysEx(InputFile &inputFile)
+	{
+		SysExImage memory;
+		std::vector<LibraryPatch> patches;
+		std::vector<std::vector<uint8_t>> temporaryPatches;
+		std::optional<bool> isJD990;
+
+		std::vector<uint8_t> message;
+		while (!(message = inputFile.NextSysExMessage()).empty())
+		{
+			DataSetMessage dataSet;
+			if (!ParseDataSetMessage(message, dataSet))
+				continue;
+
+			// Only process the first device type found in the file
+			if (isJD990.has_value() && *isJD990 != dataSet.isJD990)
+				continue;
+			isJD990 = dataSet.isJD990;
+
+			memory.Write(dataSet.address, dataSet.data.data(), dataSet.data.size());
+
+			const uint32_t temporaryAddress = dataSet.isJD990 ? BASE_ADDR_990_PATCH_TEMPORARY : BASE_ADDR_800_PATCH_TEMPORARY;
+			if (dataSet.address == temporaryAddress + 256)
+			{
+				const size_t patchSize = dataSet.isJD990 ? sizeof(Patch990) : sizeof(Patch800);
+				if (const uint8_t *data = memory.Get(temporaryAddress, patchSize))
+					temporaryPatches.emplace_back(data, data + patchSize);
+			}
+		}
+
+		if (!isJD990.has_value())
+			return {};
+
+		for (uint32_t patch = 0; patch < 64; patch++)
+		{
+			if (*isJD990)
+			{
+				if (const uint8_t *data = memory.Get(BASE_ADDR_990_PATCH_INTERNAL + (patch << 14), sizeof(Patch990)))
+					AddPatch<Patch990>(patches, PatchFormat::JD990, patch, data);
+			}
+			else
+			{
+				if (const uint8_t *data = memory.Get(BASE_ADDR_800_PATCH_INTERNAL + ((patch * 0x03) << 7), sizeof(Patch800)))
+					AddPatch<Patch800>(patches, PatchFormat::JD800, patch, data);
+			}
+		}
+		for (uint32_t patch = 0; patch < 64 && *isJD990; patch++)
+		{
+			if (const uint8_t *data = memory.Get(BASE_ADDR_990_PATCH_CARD + (patch << 14), sizeof(Patch990)))
+				AddPatch<Patch990>(patches, PatchFormat::JD990, LIBRARY_SLOT_CARD + patch, data);
+		}
+		for (uint32_t patch = 0; patch < temporaryPatches.size(); patch++)
+		{
+			if (*isJD990)
+				AddPatch<Patch990>(patches, PatchFormat::JD990, LIBRARY_SLOT_TEMPORARY + patch, temporaryPatches[patch].data());
+			else
+				AddPatch<Patch800>(patches, PatchFormat::JD800, LIBRARY_SLOT_TEMPORARY + patch, temporaryPatches[patch].data());
+		}
+		return patches;
+	}
+}
+
+bool ParseDataSetMessage(std::span<const uint8_t> message, DataSetMessage &result)
+{
+	if (message.size() < 6 || message[0] != 0x41 || (message[2] != 0x3D && message[2] != 0x57) || message[3] != 0x12)
+		return false;
+
+	const bool isJD990 = (message[2] == 0x57);
+	// Remove EOX
+	message = message.first(message.size() - 1);
+	uint8_t checksum = 0;
+	for (size_t i = 4; i < message.size(); i++)
+	{
+		checksum += message[i];
+	}
+	if (((~checksum + 1) & 0x7F) != 0)
+		return false;
+	// Remove checksum byte
+	message = message.first(message.size() - 1);
+
+	const size_t headerSize = isJD990 ? 8 : 7;
+	if (message.size() < headerSize)
+		return false;
+
+	result.isJD990 = isJD990;
+	if (isJD990)
+		result.address = (message[4] << 21) | (message[5] << 14) | (message[6] << 7) | message[7];
+	else
+		result.address = (message[4] << 14) | (message[5] << 7) | message[6];
+	result.data = message.subspan(headerSize);
+	return true;
+}
+
+std::string_view LibraryPatch::GetName() const
+{
+	switch (format)
+	{
+	case PatchFormat::JD800: return ToString(As<Patch800>().common.name);
+	case PatchFormat::JD990: return ToString(As<Patch990>().common.name);
+	case PatchFormat::VST: return ToString(As<PatchVST>().name);
+	}
+	return {};
+}
+
+uint64_t LibraryPatch::GetHash() const
+{
+	if (format == PatchFormat::VST)
+	{
+		// The ZEN header is not stored in SVD files, and only the first 2048 bytes of the patch are stored in SVZ and SVD files
+		const PatchVST &pVST = As<PatchVST>();
+		return HashFNV1a(&pVST.name, 2048 - sizeof(pVST.zenHeader));
+	}
+	return HashFNV1a(data.data(), data.size());
+}
+
+std::vector<LibraryPatch> LoadLibraryFile(std::istream &inFile, std::ostream &warnings)
+{
+	InputFile inputFile{inFile, warnings};
+	if (inputFile.GetType() == InputFile::Type::SYX || inputFile.GetType() == InputFile::Type::MID)
+		return LoadSysEx(inputFile);
+
+	const std::vector<PatchVST> vstPatches = (inputFile.GetType() == InputFile::Type::SVD) ? ReadSVD(inFile, warnings) : ReadSVZ(inFile, warnings);
+	std::vector<LibraryPatch> patches;
+	patches.reserve(vstPatches.size());
+	for (uint32_t patch = 0; patch < vstPatches.size(); patch++)
+	{
+		AddPatch<PatchVST>(patches, PatchFormat::VST, patch, reinterpret_cast<const uint8_t *>(&vstPatches[patch]));
+	}
+	return patches;
+}
+
+std::string GetLibrarySlotName(const PatchFormat format, const uint32_t slot, const uint32_t numPatchesInFile)
+{
+	if (format == PatchFormat::VST)
+		return GetPatchIndex(slot, numPatchesInFile);
+	else if (slot >= LIBRARY_SLOT_TEMPORARY)
+	{
+		std::string slotName = std::to_string(slot - LIBRARY_SLOT_TEMPORARY + 1);
+		slotName.insert(slotName.begin(), 'T');
+		return slotName;
+	}
+	else if (slot >= LIBRARY_SLOT_CARD)
+		return GetPatchIndex(slot - LIBRARY_SLOT_CARD, 64, true);
+	else
+		return GetPatchIndex(slot, 64);
+}
+
+bool IsLibraryFile(const std::filesystem::path &path)
+{
+	std::string ext = path.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+	return ext == ".syx" || ext == ".mid" || ext == ".bin" || ext == ".svz" || ext == ".svd";
+}
@@ -0,0 +1,59 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionPlan.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A single patch found in a SysEx dump, BIN, SVZ or SVD file, in its original format.
+struct LibraryPatch
+{
+	PatchFormat format = PatchFormat::JD800;
+	// For SysEx dumps, slots 0-63 are internal patches, 64-127 are JD-990 card patches and temporary patches follow after that.
+	// For all other files, this is simply the position in the patch bank.
+	uint32_t slot = 0;
+	std::vector<uint8_t> data;  // Patch800, Patch990 or PatchVST, depending on format
+
+	template<typename T>
+	const T &As() const { return *reinterpret_cast<const T *>(data.data()); }
+
+	std::string_view GetName() const;
+	// Hash of all patch data that is stored in the original file
+	uint64_t GetHash() const;
+};
+
+constexpr uint32_t LIBRARY_SLOT_CARD = 64;
+constexpr uint32_t LIBRARY_SLOT_TEMPORARY = 128;
+
+// Payload of a JD-800 or JD-990 Data Set (DT1) message
+struct DataSetMessage
+{
+	bool isJD990 = false;
+	uint32_t address = 0;  // Linear address, i.e. the 7-bit address bytes are concatenated
+	std::span<const uint8_t> data;
+};
+
+// Parses a SysEx message as returned by InputFile::NextSysExMessage (without F0, but including F7).
+// Returns false if it is not a JD-800 / JD-990 Data Set message or if its checksum is wrong.
+bool ParseDataSetMessage(std::span<const uint8_t> message, DataSetMessage &result);
+
+// Returns all patches contained in the file, or an empty list if the file could not be parsed.
+// Unlike the convert verb, SysEx dumps are collected in a sparse memory image, so this is cheap to call for many files.
+// Problems with the file are reported on the warnings stream, so concurrent callers can each pass their own stream.
+std::vector<LibraryPatch> LoadLibraryFile(std::istream &inFile, std::ostream &warnings);
+
+// Human-readable slot name, e.g. "I11", "C42", "B17" or "T3"
+std::string GetLibrarySlotName(const PatchFormat format, const uint32_t slot, const uint32_t numPatchesInFile);
+
+// Returns true if the file extension belongs to a file type that LoadLibraryFile can read
+bool IsLibraryFile(const std::filesystem::path &path);
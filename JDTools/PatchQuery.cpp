@@ -0,0 +1,198 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "PatchQuery.hpp"
+#include "MappedFile.hpp"
+#include "PatchLibrary.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <optional>
+
+PatchQuery::PatchQuery(const PatchIndexView &index)
+	: m_index{index}
+{
+	const uint32_t numPatches = static_cast<uint32_t>(index.patches.size());
+	m_names.reserve(numPatches);
+	for (uint32_t i = 0; i < numPatches; i++)
+	{
+		const PatchIndexPatch &patch = index.patches[i];
+		m_names.push_back(Normalize(ToString(patch.name)));
+
+		for (size_t tone = 0; tone < 4; tone++)
+		{
+			if ((patch.layerTones & (1 << tone)) && patch.waveSource[tone] == 0)
+			{
+				auto &postings = m_waveforms[patch.waveform[tone]];
+				if (postings.empty() || postings.back() != i)
+					postings.push_back(i);
+			}
+		}
+		for (size_t flag = 0; flag < m_flags.size(); flag++)
+		{
+			if (patch.flags & (1 << flag))
+				m_flags[flag].push_back(i);
+		}
+	}
+
+	m_sortedByName.resize(numPatches);
+	std::iota(m_sortedByName.begin(), m_sortedByName.end(), 0u);
+	std::stable_sort(m_sortedByName.begin(), m_sortedByName.end(), [this](const uint32_t l, const uint32_t r) { return m_names[l] < m_names[r]; });
+
+	m_trie.emplace_back().last = numPatches;
+	for (uint32_t pos = 0; pos < numPatches; pos++)
+	{
+		uint32_t node = 0;
+		for (const char c : m_names[m_sortedByName[pos]])
+		{
+			// Thanks to the sorted insertion order, an existing child for this character must be the most recently added one
+			const uint32_t lastChild = m_trie[node].lastChild;
+			if (lastChild != 0 && m_trie[lastChild].c == c)
+			{
+				node = lastChild;
+				m_trie[node].last = pos + 1;
+				continue;
+			}
+			const uint32_t child = static_cast<uint32_t>(m_trie.size());
+			TrieNode &newNode = m_trie.emplace_back();
+			newNode.c = c;
+			newNode.first = pos;
+			newNode.last = pos + 1;
+			if (lastChild != 0)
+				m_trie[lastChild].nextSibling = child;
+			else
+				m_trie[node].firstChild = child;
+			m_trie[node].lastChild = child;
+			node = child;
+		}
+	}
+}
+
+std::vector<uint32_t> PatchQuery::FindNamePrefix(std::string_view prefix) const
+{
+	uint32_t node = 0;
+	for (const char c : Normalize(prefix))
+	{
+		uint32_t child = m_trie[node].firstChild;
+		while (child != 0 && m_trie[child].c != c)
+		{
+			child = m_trie[child].nextSibling;
+		}
+		if (child == 0)
+			return {};
+		node = child;
+	}
+
+	std::vector<uint32_t> result{m_sortedByName.begin() + m_trie[node].first, m_sortedByName.begin() + m_trie[node].last};
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+std::vector<uint32_t> PatchQuery::FindNameSubstring(std::string_view text) const
+{
+	const std::string normalizedText = Normalize(text);
+	std::vector<uint32_t> result;
+	for (uint32_t i = 0; i < m_names.size(); i++)
+	{
+		if (m_names[i].find(normalizedText) != std::string::npos)
+			result.push_back(i);
+	}
+	return result;
+}
+
+std::vector<uint32_t> PatchQuery::FindWaveform(const uint16_t waveform) const
+{
+	const auto postings = m_waveforms.find(waveform);
+	if (postings == m_waveforms.end())
+		return {};
+	return postings->second;
+}
+
+std::vector<uint32_t> PatchQuery::FindFlag(const PatchIndexFlags flag) const
+{
+	for (size_t i = 0; i < m_flags.size(); i++)
+	{
+		if (flag == (1 << i))
+			return m_flags[i];
+	}
+	return {};
+}
+
+std::string PatchQuery::Normalize(std::string_view name)
+{
+	while (!name.empty() && (name.back() == ' ' || name.back() == '\0'))
+	{
+		name.remove_suffix(1);
+	}
+	std::string normalized{name};
+	std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](const char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+	return normalized;
+}
+
+int RunQuery(const std::string &indexFilename, const std::vector<std::string> &terms)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const MappedFile mappedFile{indexFilename};
+	PatchIndexView index;
+	if (!mappedFile.IsValid() || !ParsePatchIndex(mappedFile.GetData(), mappedFile.GetSize(), index))
+	{
+		std::cout << "Could not read index file " << indexFilename << "! Run the index verb to create or update it." << std::endl;
+		return 2;
+	}
+
+	const PatchQuery query{index};
+	std::optional<std::vector<uint32_t>> result;
+	for (const std::string &term : terms)
+	{
+		const auto separator = term.find('=');
+		const std::string_view key = std::string_view{term}.substr(0, separator);
+		const std::string_view value = (separator != std::string::npos) ? std::string_view{term}.substr(separator + 1) : std::string_view{};
+
+		std::vector<uint32_t> matches;
+		if (key == "name" && separator != std::string::npos)
+			matches = query.FindNamePrefix(value);
+		else if (key == "contains" && separator != std::string::npos)
+			matches = query.FindNameSubstring(value);
+		else if (key == "waveform" && !value.empty() && std::all_of(value.begin(), value.end(), [](const char c) { return c >= '0' && c <= '9'; }) && value.size() <= 4)
+			matches = query.FindWaveform(static_cast<uint16_t>(std::stoul(std::string{value})));
+		else if (key == "card" && separator == std::string::npos)
+			matches = query.FindFlag(PATCH_CARD_WAVEFORM);
+		else if (key == "lossy" && (value == "jd800" || value == "JD800"))
+			matches = query.FindFlag(PATCH_LOSSY_TO_JD800);
+		else if (key == "lossy" && (value == "jd990" || value == "JD990"))
+			matches = query.FindFlag(PATCH_LOSSY_TO_JD990);
+		else if (key == "lossy" && (value == "vst" || value == "VST"))
+			matches = query.FindFlag(PATCH_LOSSY_TO_VST);
+		else
+		{
+			std::cout << "Invalid query term: " << term << std::endl;
+			return 1;
+		}
+
+		if (result)
+		{
+			std::vector<uint32_t> intersection;
+			std::set_intersection(result->begin(), result->end(), matches.begin(), matches.end(), std::back_inserter(intersection));
+			result = std::move(intersection);
+		}
+		else
+		{
+			result = std::move(matches);
+		}
+	}
+	const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	for (const uint32_t patchNumber : *result)
+	{
+		const PatchIndexPatch &patch = index.patches[patchNumber];
+		const PatchIndexFile &file = index.files[patch.file];
+		std::cout << index.GetPath(file) << " " << GetLibrarySlotName(static_cast<PatchFormat>(patch.format), patch.slot, file.numPatches) << ": " << ToString(patch.name) << "\n";
+	}
+	std::cout << result->size() << " matching patches (query took " << milliseconds << " ms)." << std::endl;
+	return 0;
+}
@@ -0,0 +1,56 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "PatchIndex.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Search structures built from a patch index.
+// All Find functions return a sorted list of patch numbers, i.e. positions in the index' patch table.
+class PatchQuery
+{
+public:
+	explicit PatchQuery(const PatchIndexView &index);
+
+	// Patch name searches are case-insensitive and ignore trailing spaces
+	std::vector<uint32_t> FindNamePrefix(std::string_view prefix) const;
+	std::vector<uint32_t> FindNameSubstring(std::string_view text) const;
+	// Patches with at least one enabled tone using the given internal waveform (1-based)
+	std::vector<uint32_t> FindWaveform(const uint16_t waveform) const;
+	std::vector<uint32_t> FindFlag(const PatchIndexFlags flag) const;
+
+	const PatchIndexView &GetIndex() const noexcept { return m_index; }
+
+private:
+	// Nodes are stored as first-child / next-sibling lists. As names are inserted in sorted order,
+	// the patches below each node form a contiguous range in m_sortedByName.
+	struct TrieNode
+	{
+		uint32_t firstChild = 0;  // 0 = no children, the root can never be a child
+		uint32_t lastChild = 0;
+		uint32_t nextSibling = 0;
+		uint32_t first = 0;
+		uint32_t last = 0;
+		char c = 0;
+	};
+
+	static std::string Normalize(std::string_view name);
+
+	const PatchIndexView &m_index;
+	std::vector<std::string> m_names;
+	std::vector<uint32_t> m_sortedByName;
+	std::vector<TrieNode> m_trie;
+	std::unordered_map<uint16_t, std::vector<uint32_t>> m_waveforms;
+	std::array<std::vector<uint32_t>, 8> m_flags;
+};
+
+// Answers a query over the given index file. Returns the process exit code.
+int RunQuery(const std::string &indexFilename, const std::vector<std::string> &terms);
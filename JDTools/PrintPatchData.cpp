@@ -132,721 +132,721 @@ static std::string KeyName(int key)
 	return name;
 }
 
-static void PrintProperty(const char *name, bool value)
+static void PrintProperty(std::ostream &out, const char *name, bool value)
 {
-	std::cout << name << ": " << (value ? "ON" : "OFF") << std::endl;
+	out << name << ": " << (value ? "ON" : "OFF") << std::endl;
 }
 
-static void PrintProperty(const char *name, int value, int offset = 0)
+static void PrintProperty(std::ostream &out, const char *name, int value, int offset = 0)
 {
-	std::cout << name << ": " << (value - offset) << std::endl;
+	out << name << ": " << (value - offset) << std::endl;
 }
 
-static void PrintProperty(const char *name, double value)
+static void PrintProperty(std::ostream &out, const char *name, double value)
 {
-	std::cout << name << ": " << value << std::endl;
+	out << name << ": " << value << std::endl;
 }
 
-static void PrintProperty(const char *name, const char *value)
+static void PrintProperty(std::ostream &out, const char *name, const char *value)
 {
-	std::cout << name << ": " << value << std::endl;
+	out << name << ": " << value << std::endl;
 }
 
-static void PrintProperty(const char *name, const std::string_view value)
+static void PrintProperty(std::ostream &out, const char *name, const std::string_view value)
 {
-	std::cout << name << ": " << value << std::endl;
+	out << name << ": " << value << std::endl;
 }
 
-static void PrintLFO(const Tone800::LFO &lfo)
+static void PrintLFO(std::ostream &out, const Tone800::LFO &lfo)
 {
-	PrintProperty("\t\t\tRate", lfo.rate);
+	PrintProperty(out, "\t\t\tRate", lfo.rate);
 	if (lfo.delay == 101)
-		PrintProperty("\t\t\tDelay", "REL");
+		PrintProperty(out, "\t\t\tDelay", "REL");
 	else
-		PrintProperty("\t\t\tDelay", lfo.delay);
-	PrintProperty("\t\t\tFade", lfo.fade, 50);
-	PrintProperty("\t\t\tWaveform", SafeTable(LFOWaveform800, lfo.waveform));
-	PrintProperty("\t\t\tOffset", SafeTable(LFOOffset, lfo.offset));
-	PrintProperty("\t\t\tKey Trigger", lfo.keyTrigger != 0);
+		PrintProperty(out, "\t\t\tDelay", lfo.delay);
+	PrintProperty(out, "\t\t\tFade", lfo.fade, 50);
+	PrintProperty(out, "\t\t\tWaveform", SafeTable(LFOWaveform800, lfo.waveform));
+	PrintProperty(out, "\t\t\tOffset", SafeTable(LFOOffset, lfo.offset));
+	PrintProperty(out, "\t\t\tKey Trigger", lfo.keyTrigger != 0);
 }
 
-static void PrintTone(const Tone800 &tone)
+static void PrintTone(std::ostream &out, const Tone800 &tone)
 {
-	std::cout << "\t\tCommon" << std::endl;
-	PrintProperty("\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
-	PrintProperty("\t\t\tHold Control", tone.common.holdControl != 0);
-	std::cout << "\t\tLFO 1" << std::endl;
-	PrintLFO(tone.lfo1);
-	std::cout << "\t\tLFO 2" << std::endl;
-	PrintLFO(tone.lfo2);
-	std::cout << "\t\tWG" << std::endl;
-	PrintProperty("\t\t\tWave Source", SafeTable(WaveSource, tone.wg.waveSource));
+	out << "\t\tCommon" << std::endl;
+	PrintProperty(out, "\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
+	PrintProperty(out, "\t\t\tHold Control", tone.common.holdControl != 0);
+	out << "\t\tLFO 1" << std::endl;
+	PrintLFO(out, tone.lfo1);
+	out << "\t\tLFO 2" << std::endl;
+	PrintLFO(out, tone.lfo2);
+	out << "\t\tWG" << std::endl;
+	PrintProperty(out, "\t\t\tWave Source", SafeTable(WaveSource, tone.wg.waveSource));
 	const int waveform = ((tone.wg.waveformMSB << 8) | tone.wg.waveformLSB) + 1;
 	if (tone.wg.waveSource)
-		PrintProperty("\t\t\tWaveform", waveform);
+		PrintProperty(out, "\t\t\tWaveform", waveform);
 	else
-		std::cout << "\t\t\tWaveform: " << waveform << " (" << SafeTable(WaveformNames, tone.wg.waveformLSB + 1) << ")" << std::endl;
-	PrintProperty("\t\t\tPitch Coarse", tone.wg.pitchCoarse, 48);
-	PrintProperty("\t\t\tPitch Fine", tone.wg.pitchFine, 50);
-	PrintProperty("\t\t\tPitch Random", tone.wg.pitchRandom);
-	PrintProperty("\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
-	PrintProperty("\t\t\tBender Switch", tone.wg.benderSwitch != 0);
-	PrintProperty("\t\t\tAftertouch Bend", tone.wg.aTouchBend != 0);
-	PrintProperty("\t\t\tLFO 1 Amount", tone.wg.lfo1Sens, 50);
-	PrintProperty("\t\t\tLFO 2 Amount", tone.wg.lfo2Sens, 50);
-	PrintProperty("\t\t\tLever Destination", SafeTable(LFOSelect, (tone.wg.leverSens < 50) ? 1 : 0));
-	PrintProperty("\t\t\tLever LFO Amount", std::abs(tone.wg.leverSens - 50));
-	PrintProperty("\t\t\tAftertouch Destination", SafeTable(LFOSelect, (tone.wg.aTouchModSens < 50) ? 1 : 0));
-	PrintProperty("\t\t\tAftertouch LFO Amount", std::abs(tone.wg.aTouchModSens - 50));
-	std::cout << "\t\tPitch Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.pitchEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.pitchEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.pitchEnv.timeKF, 10);
-	PrintProperty("\t\t\tLevel 0", tone.pitchEnv.level0, 50);
-	PrintProperty("\t\t\tTime 1", tone.pitchEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.pitchEnv.level1, 50);
-	PrintProperty("\t\t\tTime 2", tone.pitchEnv.time2);
-	PrintProperty("\t\t\tTime 3", tone.pitchEnv.time3);
-	PrintProperty("\t\t\tLevel 2", tone.pitchEnv.level2, 50);
-	std::cout << "\t\tTVF" << std::endl;
-	PrintProperty("\t\t\tFilter Mode", SafeTable(FilterMode, tone.tvf.filterMode));
-	PrintProperty("\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
-	PrintProperty("\t\t\tResonance", tone.tvf.resonance);
-	PrintProperty("\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
-	PrintProperty("\t\t\tAftertouch Amount", tone.tvf.aTouchSens, 50);
-	PrintProperty("\t\t\tLFO Source", SafeTable(LFOSelect, tone.tvf.lfoSelect));
-	PrintProperty("\t\t\tLFO Depth", tone.tvf.lfoDepth, 50);
-	PrintProperty("\t\t\tEnvelope Depth", tone.tvf.envDepth, 50);
-	std::cout << "\t\tTVF Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvfEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.tvfEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvfEnv.timeKF, 10);
-	PrintProperty("\t\t\tTime 1", tone.tvfEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvfEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvfEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvfEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvfEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvfEnv.time4);
-	PrintProperty("\t\t\tLevel 4", tone.tvfEnv.level4);
-	std::cout << "\t\tTVA" << std::endl;
-	PrintProperty("\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
-	PrintProperty("\t\t\tBias Point", KeyName(tone.tva.biasPoint));
-	PrintProperty("\t\t\tBias Level", tone.tva.biasLevel, 10);
-	PrintProperty("\t\t\tLevel", tone.tva.level);
-	PrintProperty("\t\t\tAftertouch Amount", tone.tva.aTouchSens, 50);
-	PrintProperty("\t\t\tLFO Source", SafeTable(LFOSelect, tone.tva.lfoSelect));
-	PrintProperty("\t\t\tLFO Depth", tone.tva.lfoDepth, 50);
-	std::cout << "\t\tTVA Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvaEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.tvaEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvaEnv.timeKF, 10);
-	PrintProperty("\t\t\tTime 1", tone.tvaEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvaEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvaEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvaEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvaEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvaEnv.time4);
+		out << "\t\t\tWaveform: " << waveform << " (" << SafeTable(WaveformNames, tone.wg.waveformLSB + 1) << ")" << std::endl;
+	PrintProperty(out, "\t\t\tPitch Coarse", tone.wg.pitchCoarse, 48);
+	PrintProperty(out, "\t\t\tPitch Fine", tone.wg.pitchFine, 50);
+	PrintProperty(out, "\t\t\tPitch Random", tone.wg.pitchRandom);
+	PrintProperty(out, "\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
+	PrintProperty(out, "\t\t\tBender Switch", tone.wg.benderSwitch != 0);
+	PrintProperty(out, "\t\t\tAftertouch Bend", tone.wg.aTouchBend != 0);
+	PrintProperty(out, "\t\t\tLFO 1 Amount", tone.wg.lfo1Sens, 50);
+	PrintProperty(out, "\t\t\tLFO 2 Amount", tone.wg.lfo2Sens, 50);
+	PrintProperty(out, "\t\t\tLever Destination", SafeTable(LFOSelect, (tone.wg.leverSens < 50) ? 1 : 0));
+	PrintProperty(out, "\t\t\tLever LFO Amount", std::abs(tone.wg.leverSens - 50));
+	PrintProperty(out, "\t\t\tAftertouch Destination", SafeTable(LFOSelect, (tone.wg.aTouchModSens < 50) ? 1 : 0));
+	PrintProperty(out, "\t\t\tAftertouch LFO Amount", std::abs(tone.wg.aTouchModSens - 50));
+	out << "\t\tPitch Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.pitchEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.pitchEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.pitchEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tLevel 0", tone.pitchEnv.level0, 50);
+	PrintProperty(out, "\t\t\tTime 1", tone.pitchEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.pitchEnv.level1, 50);
+	PrintProperty(out, "\t\t\tTime 2", tone.pitchEnv.time2);
+	PrintProperty(out, "\t\t\tTime 3", tone.pitchEnv.time3);
+	PrintProperty(out, "\t\t\tLevel 2", tone.pitchEnv.level2, 50);
+	out << "\t\tTVF" << std::endl;
+	PrintProperty(out, "\t\t\tFilter Mode", SafeTable(FilterMode, tone.tvf.filterMode));
+	PrintProperty(out, "\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
+	PrintProperty(out, "\t\t\tResonance", tone.tvf.resonance);
+	PrintProperty(out, "\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
+	PrintProperty(out, "\t\t\tAftertouch Amount", tone.tvf.aTouchSens, 50);
+	PrintProperty(out, "\t\t\tLFO Source", SafeTable(LFOSelect, tone.tvf.lfoSelect));
+	PrintProperty(out, "\t\t\tLFO Depth", tone.tvf.lfoDepth, 50);
+	PrintProperty(out, "\t\t\tEnvelope Depth", tone.tvf.envDepth, 50);
+	out << "\t\tTVF Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvfEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvfEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvfEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvfEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvfEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvfEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvfEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvfEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvfEnv.time4);
+	PrintProperty(out, "\t\t\tLevel 4", tone.tvfEnv.level4);
+	out << "\t\tTVA" << std::endl;
+	PrintProperty(out, "\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
+	PrintProperty(out, "\t\t\tBias Point", KeyName(tone.tva.biasPoint));
+	PrintProperty(out, "\t\t\tBias Level", tone.tva.biasLevel, 10);
+	PrintProperty(out, "\t\t\tLevel", tone.tva.level);
+	PrintProperty(out, "\t\t\tAftertouch Amount", tone.tva.aTouchSens, 50);
+	PrintProperty(out, "\t\t\tLFO Source", SafeTable(LFOSelect, tone.tva.lfoSelect));
+	PrintProperty(out, "\t\t\tLFO Depth", tone.tva.lfoDepth, 50);
+	out << "\t\tTVA Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvaEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvaEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvaEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvaEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvaEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvaEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvaEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvaEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvaEnv.time4);
 }
 
-static void PrintTone(const Tone800 &tone, bool enabled, bool selected, uint8_t keyRangeLow, uint8_t keyRangeHigh)
+static void PrintTone(std::ostream &out, const Tone800 &tone, bool enabled, bool selected, uint8_t keyRangeLow, uint8_t keyRangeHigh)
 {
-	PrintProperty("\t\tEnabled", enabled);
-	PrintProperty("\t\tSelected", selected);
-	PrintProperty("\t\tKey Range Low", KeyName(keyRangeLow));
-	PrintProperty("\t\tKey Range High", KeyName(keyRangeHigh));
-	PrintTone(tone);
+	PrintProperty(out, "\t\tEnabled", enabled);
+	PrintProperty(out, "\t\tSelected", selected);
+	PrintProperty(out, "\t\tKey Range Low", KeyName(keyRangeLow));
+	PrintProperty(out, "\t\tKey Range High", KeyName(keyRangeHigh));
+	PrintTone(out, tone);
 }
 
-void PrintEQ(const EQ800 &eq)
+void PrintEQ(std::ostream &out, const EQ800 &eq)
 {
-	std::cout << "\tEQ" << std::endl;
-	PrintProperty("\t\tLow Frequency", SafeTable(EQLowFreq, eq.lowFreq));
-	PrintProperty("\t\tLow Gain", eq.lowGain, 15);
-	PrintProperty("\t\tMid Frequency", SafeTable(EQMidFreq, eq.midFreq));
-	PrintProperty("\t\tMid Q", SafeTable(EQMidQ, eq.midQ) * 0.1);
-	PrintProperty("\t\tMid Gain", eq.midGain, 15);
-	PrintProperty("\t\tHigh Frequency", SafeTable(EQHighFreq, eq.highFreq));
-	PrintProperty("\t\tHigh Gain", eq.highGain, 15);
+	out << "\tEQ" << std::endl;
+	PrintProperty(out, "\t\tLow Frequency", SafeTable(EQLowFreq, eq.lowFreq));
+	PrintProperty(out, "\t\tLow Gain", eq.lowGain, 15);
+	PrintProperty(out, "\t\tMid Frequency", SafeTable(EQMidFreq, eq.midFreq));
+	PrintProperty(out, "\t\tMid Q", SafeTable(EQMidQ, eq.midQ) * 0.1);
+	PrintProperty(out, "\t\tMid Gain", eq.midGain, 15);
+	PrintProperty(out, "\t\tHigh Frequency", SafeTable(EQHighFreq, eq.highFreq));
+	PrintProperty(out, "\t\tHigh Gain", eq.highGain, 15);
 }
 
-void PrintPatch(const Patch800 &patch)
+void PrintPatch(std::ostream &out, const Patch800 &patch)
 {
-	std::cout << "\tCommon" << std::endl;
-	PrintProperty("\t\tPatch Level", patch.common.patchLevel);
-	PrintProperty("\t\tBender Range Down", patch.common.benderRangeDown);
-	PrintProperty("\t\tBender Range Up", patch.common.benderRangeUp);
-	PrintProperty("\t\tAftertouch Bend Amount", ATouchBendSens(patch.common.aTouchBend));
-	PrintProperty("\t\tSolo Switch", patch.common.soloSW != 0);
-	PrintProperty("\t\tSolo Legato", patch.common.soloLegato != 0);
-	PrintProperty("\t\tPortamento Switch", patch.common.portamentoSW != 0);
-	PrintProperty("\t\tPortamento Mode", patch.common.portamentoMode ? "LEGATO" : "NORMAL");
-	PrintProperty("\t\tPortamento Time", patch.common.portamentoTime);
-	PrintEQ(patch.eq);
-	std::cout << "\tMIDI TX" << std::endl;
-	PrintProperty("\t\tKey Mode", SafeTable(KeyMode800, patch.midiTx.keyMode));
-	PrintProperty("\t\tSplit Point", KeyName(patch.midiTx.splitPoint + 24));
-	PrintProperty("\t\tLower Channel", patch.midiTx.lowerChannel + 1);
-	PrintProperty("\t\tUpper Channel", patch.midiTx.upperChannel + 1);
-	PrintProperty("\t\tLower Program Change", patch.midiTx.lowerProgramChange + 1);
-	PrintProperty("\t\tUpper Program Change", patch.midiTx.upperProgramChange + 1);
-	PrintProperty("\t\tHold Mode", SafeTable(HoldMode800, patch.midiTx.holdMode));
-	std::cout << "\tEffects" << std::endl;
-	PrintProperty("\t\tGroup A Sequence", SafeTable(FXGroupASequence, patch.effect.groupAsequence));
-	PrintProperty("\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effect.groupBsequence));
-	PrintProperty("\t\tGroup A Block 1 Switch", patch.effect.groupAblockSwitch1 != 0);
-	PrintProperty("\t\tGroup A Block 2 Switch", patch.effect.groupAblockSwitch2 != 0);
-	PrintProperty("\t\tGroup A Block 3 Switch", patch.effect.groupAblockSwitch3 != 0);
-	PrintProperty("\t\tGroup A Block 4 Switch", patch.effect.groupAblockSwitch4 != 0);
-	PrintProperty("\t\tGroup B Block 1 Switch", patch.effect.groupBblockSwitch1 != 0);
-	PrintProperty("\t\tGroup B Block 2 Switch", patch.effect.groupBblockSwitch2 != 0);
-	PrintProperty("\t\tGroup B Block 3 Switch", patch.effect.groupBblockSwitch3 != 0);
-	PrintProperty("\t\tGroup B Effects Balance", patch.effect.effectsBalanceGroupB);
-	PrintProperty("\t\tDistortion Type", SafeTable(DistortionType, patch.effect.distortionType));
-	PrintProperty("\t\tDistortion Drive", patch.effect.distortionDrive);
-	PrintProperty("\t\tDistortion Level", patch.effect.distortionLevel);
-	PrintProperty("\t\tPhaser Manual", PhaserManual(patch.effect.phaserManual));
-	PrintProperty("\t\tPhaser Rate (Hz)", patch.effect.phaserRate * 0.1 + 0.1);
-	PrintProperty("\t\tPhaser Depth", patch.effect.phaserDepth);
-	PrintProperty("\t\tPhaser Resonance", patch.effect.phaserResonance);
-	PrintProperty("\t\tPhaser Mix", patch.effect.phaserMix);
-	PrintProperty("\t\tSpectrum Band 1", patch.effect.spectrumBand1);
-	PrintProperty("\t\tSpectrum Band 2", patch.effect.spectrumBand2);
-	PrintProperty("\t\tSpectrum Band 3", patch.effect.spectrumBand3);
-	PrintProperty("\t\tSpectrum Band 4", patch.effect.spectrumBand4);
-	PrintProperty("\t\tSpectrum Band 5", patch.effect.spectrumBand5);
-	PrintProperty("\t\tSpectrum Band 6", patch.effect.spectrumBand6);
-	PrintProperty("\t\tSpectrum Bandwidth", patch.effect.spectrumBandwidth);
-	PrintProperty("\t\tEnhancer Sensitivity", patch.effect.enhancerSens);
-	PrintProperty("\t\tEnhancer Mix", patch.effect.enhancerMix);
-	PrintProperty("\t\tDelay Center Tap (ms)", DelayTime(patch.effect.delayCenterTap));
-	PrintProperty("\t\tDelay Center Level", patch.effect.delayCenterLevel);
-	PrintProperty("\t\tDelay Left Tap (ms)", DelayTime(patch.effect.delayLeftTap));
-	PrintProperty("\t\tDelay Left Level", patch.effect.delayLeftLevel);
-	PrintProperty("\t\tDelay Right Tap (ms)", DelayTime(patch.effect.delayRightTap));
-	PrintProperty("\t\tDelay Right Level", patch.effect.delayRightLevel);
-	PrintProperty("\t\tDelay Feedback", patch.effect.delayFeedback);
-	PrintProperty("\t\tChorus Rate (Hz)", 0.1 + patch.effect.chorusRate * 0.1);
-	PrintProperty("\t\tChorus Depth", patch.effect.chorusDepth);
-	PrintProperty("\t\tChorus Delay Time (ms)", ChorusTime(patch.effect.chorusDelayTime));
-	PrintProperty("\t\tChorus Feedback", -98 + patch.effect.chorusFeedback * 2);
-	PrintProperty("\t\tChorus Level", patch.effect.chorusLevel);
-	PrintProperty("\t\tReverb Type", SafeTable(ReverbType, patch.effect.reverbType));
-	PrintProperty("\t\tReverb Pre-Delay", patch.effect.reverbPreDelay);
-	PrintProperty("\t\tReverb Early Reflections Level", patch.effect.reverbEarlyRefLevel);
-	PrintProperty("\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effect.reverbHFDamp));
-	PrintProperty("\t\tReverb Time (ms)", ReverbTime(patch.effect.reverbTime, patch.effect.reverbType));
-	PrintProperty("\t\tReverb Level", patch.effect.reverbLevel);
-	std::cout << "\tTone A" << std::endl;
-	PrintTone(patch.toneA, patch.common.layerTone & 1, patch.common.activeTone & 1, patch.common.keyRangeLowA, patch.common.keyRangeHighA);
-	std::cout << "\tTone B" << std::endl;
-	PrintTone(patch.toneB, patch.common.layerTone & 2, patch.common.activeTone & 2, patch.common.keyRangeLowB, patch.common.keyRangeHighB);
-	std::cout << "\tTone C" << std::endl;
-	PrintTone(patch.toneC, patch.common.layerTone & 4, patch.common.activeTone & 4, patch.common.keyRangeLowC, patch.common.keyRangeHighC);
-	std::cout << "\tTone D" << std::endl;
-	PrintTone(patch.toneD, patch.common.layerTone & 8, patch.common.activeTone & 8, patch.common.keyRangeLowD, patch.common.keyRangeHighD);
+	out << "\tCommon" << std::endl;
+	PrintProperty(out, "\t\tPatch Level", patch.common.patchLevel);
+	PrintProperty(out, "\t\tBender Range Down", patch.common.benderRangeDown);
+	PrintProperty(out, "\t\tBender Range Up", patch.common.benderRangeUp);
+	PrintProperty(out, "\t\tAftertouch Bend Amount", ATouchBendSens(patch.common.aTouchBend));
+	PrintProperty(out, "\t\tSolo Switch", patch.common.soloSW != 0);
+	PrintProperty(out, "\t\tSolo Legato", patch.common.soloLegato != 0);
+	PrintProperty(out, "\t\tPortamento Switch", patch.common.portamentoSW != 0);
+	PrintProperty(out, "\t\tPortamento Mode", patch.common.portamentoMode ? "LEGATO" : "NORMAL");
+	PrintProperty(out, "\t\tPortamento Time", patch.common.portamentoTime);
+	PrintEQ(out, patch.eq);
+	out << "\tMIDI TX" << std::endl;
+	PrintProperty(out, "\t\tKey Mode", SafeTable(KeyMode800, patch.midiTx.keyMode));
+	PrintProperty(out, "\t\tSplit Point", KeyName(patch.midiTx.splitPoint + 24));
+	PrintProperty(out, "\t\tLower Channel", patch.midiTx.lowerChannel + 1);
+	PrintProperty(out, "\t\tUpper Channel", patch.midiTx.upperChannel + 1);
+	PrintProperty(out, "\t\tLower Program Change", patch.midiTx.lowerProgramChange + 1);
+	PrintProperty(out, "\t\tUpper Program Change", patch.midiTx.upperProgramChange + 1);
+	PrintProperty(out, "\t\tHold Mode", SafeTable(HoldMode800, patch.midiTx.holdMode));
+	out << "\tEffects" << std::endl;
+	PrintProperty(out, "\t\tGroup A Sequence", SafeTable(FXGroupASequence, patch.effect.groupAsequence));
+	PrintProperty(out, "\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effect.groupBsequence));
+	PrintProperty(out, "\t\tGroup A Block 1 Switch", patch.effect.groupAblockSwitch1 != 0);
+	PrintProperty(out, "\t\tGroup A Block 2 Switch", patch.effect.groupAblockSwitch2 != 0);
+	PrintProperty(out, "\t\tGroup A Block 3 Switch", patch.effect.groupAblockSwitch3 != 0);
+	PrintProperty(out, "\t\tGroup A Block 4 Switch", patch.effect.groupAblockSwitch4 != 0);
+	PrintProperty(out, "\t\tGroup B Block 1 Switch", patch.effect.groupBblockSwitch1 != 0);
+	PrintProperty(out, "\t\tGroup B Block 2 Switch", patch.effect.groupBblockSwitch2 != 0);
+	PrintProperty(out, "\t\tGroup B Block 3 Switch", patch.effect.groupBblockSwitch3 != 0);
+	PrintProperty(out, "\t\tGroup B Effects Balance", patch.effect.effectsBalanceGroupB);
+	PrintProperty(out, "\t\tDistortion Type", SafeTable(DistortionType, patch.effect.distortionType));
+	PrintProperty(out, "\t\tDistortion Drive", patch.effect.distortionDrive);
+	PrintProperty(out, "\t\tDistortion Level", patch.effect.distortionLevel);
+	PrintProperty(out, "\t\tPhaser Manual", PhaserManual(patch.effect.phaserManual));
+	PrintProperty(out, "\t\tPhaser Rate (Hz)", patch.effect.phaserRate * 0.1 + 0.1);
+	PrintProperty(out, "\t\tPhaser Depth", patch.effect.phaserDepth);
+	PrintProperty(out, "\t\tPhaser Resonance", patch.effect.phaserResonance);
+	PrintProperty(out, "\t\tPhaser Mix", patch.effect.phaserMix);
+	PrintProperty(out, "\t\tSpectrum Band 1", patch.effect.spectrumBand1);
+	PrintProperty(out, "\t\tSpectrum Band 2", patch.effect.spectrumBand2);
+	PrintProperty(out, "\t\tSpectrum Band 3", patch.effect.spectrumBand3);
+	PrintProperty(out, "\t\tSpectrum Band 4", patch.effect.spectrumBand4);
+	PrintProperty(out, "\t\tSpectrum Band 5", patch.effect.spectrumBand5);
+	PrintProperty(out, "\t\tSpectrum Band 6", patch.effect.spectrumBand6);
+	PrintProperty(out, "\t\tSpectrum Bandwidth", patch.effect.spectrumBandwidth);
+	PrintProperty(out, "\t\tEnhancer Sensitivity", patch.effect.enhancerSens);
+	PrintProperty(out, "\t\tEnhancer Mix", patch.effect.enhancerMix);
+	PrintProperty(out, "\t\tDelay Center Tap (ms)", DelayTime(patch.effect.delayCenterTap));
+	PrintProperty(out, "\t\tDelay Center Level", patch.effect.delayCenterLevel);
+	PrintProperty(out, "\t\tDelay Left Tap (ms)", DelayTime(patch.effect.delayLeftTap));
+	PrintProperty(out, "\t\tDelay Left Level", patch.effect.delayLeftLevel);
+	PrintProperty(out, "\t\tDelay Right Tap (ms)", DelayTime(patch.effect.delayRightTap));
+	PrintProperty(out, "\t\tDelay Right Level", patch.effect.delayRightLevel);
+	PrintProperty(out, "\t\tDelay Feedback", patch.effect.delayFeedback);
+	PrintProperty(out, "\t\tChorus Rate (Hz)", 0.1 + patch.effect.chorusRate * 0.1);
+	PrintProperty(out, "\t\tChorus Depth", patch.effect.chorusDepth);
+	PrintProperty(out, "\t\tChorus Delay Time (ms)", ChorusTime(patch.effect.chorusDelayTime));
+	PrintProperty(out, "\t\tChorus Feedback", -98 + patch.effect.chorusFeedback * 2);
+	PrintProperty(out, "\t\tChorus Level", patch.effect.chorusLevel);
+	PrintProperty(out, "\t\tReverb Type", SafeTable(ReverbType, patch.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Pre-Delay", patch.effect.reverbPreDelay);
+	PrintProperty(out, "\t\tReverb Early Reflections Level", patch.effect.reverbEarlyRefLevel);
+	PrintProperty(out, "\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effect.reverbHFDamp));
+	PrintProperty(out, "\t\tReverb Time (ms)", ReverbTime(patch.effect.reverbTime, patch.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Level", patch.effect.reverbLevel);
+	out << "\tTone A" << std::endl;
+	PrintTone(out, patch.toneA, patch.common.layerTone & 1, patch.common.activeTone & 1, patch.common.keyRangeLowA, patch.common.keyRangeHighA);
+	out << "\tTone B" << std::endl;
+	PrintTone(out, patch.toneB, patch.common.layerTone & 2, patch.common.activeTone & 2, patch.common.keyRangeLowB, patch.common.keyRangeHighB);
+	out << "\tTone C" << std::endl;
+	PrintTone(out, patch.toneC, patch.common.layerTone & 4, patch.common.activeTone & 4, patch.common.keyRangeLowC, patch.common.keyRangeHighC);
+	out << "\tTone D" << std::endl;
+	PrintTone(out, patch.toneD, patch.common.layerTone & 8, patch.common.activeTone & 8, patch.common.keyRangeLowD, patch.common.keyRangeHighD);
 }
 
-void PrintSetup(const SpecialSetup800 &setup)
+void PrintSetup(std::ostream &out, const SpecialSetup800 &setup)
 {
-	std::cout << "\tCommon" << std::endl;
-	PrintProperty("\t\tBender Range Down", setup.common.benderRangeDown);
-	PrintProperty("\t\tBender Range Up", setup.common.benderRangeUp);
-	PrintProperty("\t\tAftertouch Bend Amount", ATouchBendSens(setup.common.aTouchBendSens));
-	PrintEQ(setup.eq);
+	out << "\tCommon" << std::endl;
+	PrintProperty(out, "\t\tBender Range Down", setup.common.benderRangeDown);
+	PrintProperty(out, "\t\tBender Range Up", setup.common.benderRangeUp);
+	PrintProperty(out, "\t\tAftertouch Bend Amount", ATouchBendSens(setup.common.aTouchBendSens));
+	PrintEQ(out, setup.eq);
 	for (int i = 0; i < 61; i++)
 	{
-		std::cout << "\tKey " << KeyName(i + 24) << ": " << ToString(setup.keys[i].name) << std::endl;
-		PrintProperty("\t\tEnvelope Mode", setup.keys[i].envMode ? "NO SUSTAIN" : "SUSTAIN");
-		PrintProperty("\t\tMute Group", setup.keys[i].muteGroup ? std::string(1, 'A' + setup.keys[i].muteGroup - 1) : "OFF");
-		PrintProperty("\t\tPan", setup.keys[i].pan, 30);
-		PrintProperty("\t\tEffect Mode", SafeTable(SetupEffectMode800, setup.keys[i].effectMode));
-		PrintProperty("\t\tEffect Level", setup.keys[i].effectLevel);
-		PrintTone(setup.keys[i].tone);
+		out << "\tKey " << KeyName(i + 24) << ": " << ToString(setup.keys[i].name) << std::endl;
+		PrintProperty(out, "\t\tEnvelope Mode", setup.keys[i].envMode ? "NO SUSTAIN" : "SUSTAIN");
+		PrintProperty(out, "\t\tMute Group", setup.keys[i].muteGroup ? std::string(1, 'A' + setup.keys[i].muteGroup - 1) : "OFF");
+		PrintProperty(out, "\t\tPan", setup.keys[i].pan, 30);
+		PrintProperty(out, "\t\tEffect Mode", SafeTable(SetupEffectMode800, setup.keys[i].effectMode));
+		PrintProperty(out, "\t\tEffect Level", setup.keys[i].effectLevel);
+		PrintTone(out, setup.keys[i].tone);
 	}
 }
 
-static void PrintLFO(const Tone990::LFO &lfo)
+static void PrintLFO(std::ostream &out, const Tone990::LFO &lfo)
 {
-	PrintProperty("\t\t\tRate", lfo.rate);
+	PrintProperty(out, "\t\t\tRate", lfo.rate);
 	if (lfo.delay == 101)
-		PrintProperty("\t\t\tDelay", "REL");
+		PrintProperty(out, "\t\t\tDelay", "REL");
 	else
-		PrintProperty("\t\t\tDelay", lfo.delay);
-	PrintProperty("\t\t\tFade", lfo.fade, 50);
-	PrintProperty("\t\t\tWaveform", SafeTable(LFOWaveform990, lfo.waveform));
-	PrintProperty("\t\t\tOffset", SafeTable(LFOOffset, lfo.offset));
-	PrintProperty("\t\t\tKey Trigger", lfo.keyTrigger != 0);
-	PrintProperty("\t\t\tPitch Depth", lfo.depthPitch, 50);
-	PrintProperty("\t\t\tTVF Depth", lfo.depthTVF, 50);
-	PrintProperty("\t\t\tTVA Depth", lfo.depthTVA, 50);
+		PrintProperty(out, "\t\t\tDelay", lfo.delay);
+	PrintProperty(out, "\t\t\tFade", lfo.fade, 50);
+	PrintProperty(out, "\t\t\tWaveform", SafeTable(LFOWaveform990, lfo.waveform));
+	PrintProperty(out, "\t\t\tOffset", SafeTable(LFOOffset, lfo.offset));
+	PrintProperty(out, "\t\t\tKey Trigger", lfo.keyTrigger != 0);
+	PrintProperty(out, "\t\t\tPitch Depth", lfo.depthPitch, 50);
+	PrintProperty(out, "\t\t\tTVF Depth", lfo.depthTVF, 50);
+	PrintProperty(out, "\t\t\tTVA Depth", lfo.depthTVA, 50);
 }
 
-static void PrintControlSource(const Tone990::ControlSource &cs)
+static void PrintControlSource(std::ostream &out, const Tone990::ControlSource &cs)
 {
-	PrintProperty("\t\t\tDestination 1", SafeTable(ControlDest990, cs.destination1));
-	PrintProperty("\t\t\tDepth 1", cs.depth1, 50);
-	PrintProperty("\t\t\tDestination 2", SafeTable(ControlDest990, cs.destination2));
-	PrintProperty("\t\t\tDepth 2", cs.depth2, 50);
-	PrintProperty("\t\t\tDestination 3", SafeTable(ControlDest990, cs.destination3));
-	PrintProperty("\t\t\tDepth 3", cs.depth3, 50);
-	PrintProperty("\t\t\tDestination 4", SafeTable(ControlDest990, cs.destination4));
-	PrintProperty("\t\t\tDepth 4", cs.depth4, 50);
+	PrintProperty(out, "\t\t\tDestination 1", SafeTable(ControlDest990, cs.destination1));
+	PrintProperty(out, "\t\t\tDepth 1", cs.depth1, 50);
+	PrintProperty(out, "\t\t\tDestination 2", SafeTable(ControlDest990, cs.destination2));
+	PrintProperty(out, "\t\t\tDepth 2", cs.depth2, 50);
+	PrintProperty(out, "\t\t\tDestination 3", SafeTable(ControlDest990, cs.destination3));
+	PrintProperty(out, "\t\t\tDepth 3", cs.depth3, 50);
+	PrintProperty(out, "\t\t\tDestination 4", SafeTable(ControlDest990, cs.destination4));
+	PrintProperty(out, "\t\t\tDepth 4", cs.depth4, 50);
 }
 
-static void PrintTone(const Tone990 &tone)
+static void PrintTone(std::ostream &out, const Tone990 &tone)
 {
-	std::cout << "\t\tCommon" << std::endl;
-	PrintProperty("\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
-	PrintProperty("\t\t\tHold Control", tone.common.holdControl != 0);
-	std::cout << "\t\tLFO 1" << std::endl;
-	PrintLFO(tone.lfo1);
-	std::cout << "\t\tLFO 2" << std::endl;
-	PrintLFO(tone.lfo2);
-	std::cout << "\t\tWG" << std::endl;
-	PrintProperty("\t\t\tWave Source", SafeTable(WaveSource, tone.wg.waveSource));
+	out << "\t\tCommon" << std::endl;
+	PrintProperty(out, "\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
+	PrintProperty(out, "\t\t\tHold Control", tone.common.holdControl != 0);
+	out << "\t\tLFO 1" << std::endl;
+	PrintLFO(out, tone.lfo1);
+	out << "\t\tLFO 2" << std::endl;
+	PrintLFO(out, tone.lfo2);
+	out << "\t\tWG" << std::endl;
+	PrintProperty(out, "\t\t\tWave Source", SafeTable(WaveSource, tone.wg.waveSource));
 	const int waveform = ((tone.wg.waveformMSB << 8) | tone.wg.waveformLSB) + 1;
 	if (tone.wg.waveSource)
-		PrintProperty("\t\t\tWaveform", waveform);
+		PrintProperty(out, "\t\t\tWaveform", waveform);
 	else
-		std::cout << "\t\t\tWaveform: " << waveform << " (" << SafeTable(WaveformNames, tone.wg.waveformLSB + 1) << ")" << std::endl;
-	PrintProperty("\t\t\tPitch Coarse", tone.wg.pitchCoarse, 48);
-	PrintProperty("\t\t\tPitch Fine", tone.wg.pitchFine, 50);
-	PrintProperty("\t\t\tPitch Random", tone.wg.pitchRandom);
-	PrintProperty("\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
-	PrintProperty("\t\t\tBender Switch", tone.wg.benderSwitch != 0);
-	PrintProperty("\t\t\tFXM Color", tone.wg.fxmColor + 1);
-	PrintProperty("\t\t\tFXM Depth", tone.wg.fxmDepth);
-	PrintProperty("\t\t\tSync Slave Switch", tone.wg.syncSlaveSwitch != 0);
-	PrintProperty("\t\t\tTone Delay Mode", SafeTable(ToneDelayMode990, tone.wg.toneDelayMode));
-	PrintProperty("\t\t\tTone Delay Time (ms)", ToneDelay(tone.wg.toneDelayTime));
-	PrintProperty("\t\t\tEnvelope Depth", tone.wg.envDepth, 12);
-	std::cout << "\t\tPitch Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.pitchEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.pitchEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.pitchEnv.timeKF, 10);
-	PrintProperty("\t\t\tLevel 0", tone.pitchEnv.level0, 50);
-	PrintProperty("\t\t\tTime 1", tone.pitchEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.pitchEnv.level1, 50);
-	PrintProperty("\t\t\tTime 2", tone.pitchEnv.time2);
-	PrintProperty("\t\t\tTime 3", tone.pitchEnv.time3);
-	PrintProperty("\t\t\tLevel 3", tone.pitchEnv.level3, 50);
-	std::cout << "\t\tTVF" << std::endl;
-	PrintProperty("\t\t\tFilter Mode", SafeTable(FilterMode, tone.tvf.filterMode));
-	PrintProperty("\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
-	PrintProperty("\t\t\tResonance", tone.tvf.resonance);
-	PrintProperty("\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
-	PrintProperty("\t\t\tEnvelope Depth", tone.tvf.envDepth, 50);
-	std::cout << "\t\tTVF Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvfEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.tvfEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvfEnv.timeKF, 10);
-	PrintProperty("\t\t\tTime 1", tone.tvfEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvfEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvfEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvfEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvfEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvfEnv.time4);
-	PrintProperty("\t\t\tLevel 4", tone.tvfEnv.level4);
-	std::cout << "\t\tTVA" << std::endl;
-	PrintProperty("\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
-	PrintProperty("\t\t\tBias Point", KeyName(tone.tva.biasPoint));
-	PrintProperty("\t\t\tBias Level", tone.tva.biasLevel, 10);
-	PrintProperty("\t\t\tLevel", tone.tva.level);
+		out << "\t\t\tWaveform: " << waveform << " (" << SafeTable(WaveformNames, tone.wg.waveformLSB + 1) << ")" << std::endl;
+	PrintProperty(out, "\t\t\tPitch Coarse", tone.wg.pitchCoarse, 48);
+	PrintProperty(out, "\t\t\tPitch Fine", tone.wg.pitchFine, 50);
+	PrintProperty(out, "\t\t\tPitch Random", tone.wg.pitchRandom);
+	PrintProperty(out, "\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
+	PrintProperty(out, "\t\t\tBender Switch", tone.wg.benderSwitch != 0);
+	PrintProperty(out, "\t\t\tFXM Color", tone.wg.fxmColor + 1);
+	PrintProperty(out, "\t\t\tFXM Depth", tone.wg.fxmDepth);
+	PrintProperty(out, "\t\t\tSync Slave Switch", tone.wg.syncSlaveSwitch != 0);
+	PrintProperty(out, "\t\t\tTone Delay Mode", SafeTable(ToneDelayMode990, tone.wg.toneDelayMode));
+	PrintProperty(out, "\t\t\tTone Delay Time (ms)", ToneDelay(tone.wg.toneDelayTime));
+	PrintProperty(out, "\t\t\tEnvelope Depth", tone.wg.envDepth, 12);
+	out << "\t\tPitch Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.pitchEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.pitchEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.pitchEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tLevel 0", tone.pitchEnv.level0, 50);
+	PrintProperty(out, "\t\t\tTime 1", tone.pitchEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.pitchEnv.level1, 50);
+	PrintProperty(out, "\t\t\tTime 2", tone.pitchEnv.time2);
+	PrintProperty(out, "\t\t\tTime 3", tone.pitchEnv.time3);
+	PrintProperty(out, "\t\t\tLevel 3", tone.pitchEnv.level3, 50);
+	out << "\t\tTVF" << std::endl;
+	PrintProperty(out, "\t\t\tFilter Mode", SafeTable(FilterMode, tone.tvf.filterMode));
+	PrintProperty(out, "\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
+	PrintProperty(out, "\t\t\tResonance", tone.tvf.resonance);
+	PrintProperty(out, "\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
+	PrintProperty(out, "\t\t\tEnvelope Depth", tone.tvf.envDepth, 50);
+	out << "\t\tTVF Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvfEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvfEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvfEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvfEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvfEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvfEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvfEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvfEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvfEnv.time4);
+	PrintProperty(out, "\t\t\tLevel 4", tone.tvfEnv.level4);
+	out << "\t\tTVA" << std::endl;
+	PrintProperty(out, "\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
+	PrintProperty(out, "\t\t\tBias Point", KeyName(tone.tva.biasPoint));
+	PrintProperty(out, "\t\t\tBias Level", tone.tva.biasLevel, 10);
+	PrintProperty(out, "\t\t\tLevel", tone.tva.level);
 	if (tone.tva.pan <= 100)
-		PrintProperty("\t\t\tPan", tone.tva.pan, 50);
+		PrintProperty(out, "\t\t\tPan", tone.tva.pan, 50);
 	else
-		PrintProperty("\t\t\tPan", SafeTable(TonePan990, tone.tva.pan - 101));
-	PrintProperty("\t\t\tPan Key Follow", SafeTable(PanKeyFollow990, tone.tva.panKeyFollow));
-	std::cout << "\t\tTVA Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvaEnv.velo, 50);
-	PrintProperty("\t\t\tTime Velo", tone.tvaEnv.timeVelo, 50);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvaEnv.timeKF, 10);
-	PrintProperty("\t\t\tTime 1", tone.tvaEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvaEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvaEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvaEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvaEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvaEnv.time4);
-	std::cout << "\t\tControl Source 1" << std::endl;
-	PrintControlSource(tone.cs1);
-	std::cout << "\t\tControl Source 2" << std::endl;
-	PrintControlSource(tone.cs2);
+		PrintProperty(out, "\t\t\tPan", SafeTable(TonePan990, tone.tva.pan - 101));
+	PrintProperty(out, "\t\t\tPan Key Follow", SafeTable(PanKeyFollow990, tone.tva.panKeyFollow));
+	out << "\t\tTVA Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvaEnv.velo, 50);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvaEnv.timeVelo, 50);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvaEnv.timeKF, 10);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvaEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvaEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvaEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvaEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvaEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvaEnv.time4);
+	out << "\t\tControl Source 1" << std::endl;
+	PrintControlSource(out, tone.cs1);
+	out << "\t\tControl Source 2" << std::endl;
+	PrintControlSource(out, tone.cs2);
 }
 
-static void PrintTone(const Tone990 &tone, bool enabled, bool selected, uint8_t keyRangeLow, uint8_t keyRangeHigh, uint8_t velocityRange, uint8_t velocityPoint, uint8_t velocityFade)
+static void PrintTone(std::ostream &out, const Tone990 &tone, bool enabled, bool selected, uint8_t keyRangeLow, uint8_t keyRangeHigh, uint8_t velocityRange, uint8_t velocityPoint, uint8_t velocityFade)
 {
-	PrintProperty("\t\tEnabled", enabled);
-	PrintProperty("\t\tSelected", selected);
-	PrintProperty("\t\tKey Range Low", KeyName(keyRangeLow));
-	PrintProperty("\t\tKey Range High", KeyName(keyRangeHigh));
-	PrintProperty("\t\tVelocity Range", SafeTable(VelocityRange990, velocityRange));
-	PrintProperty("\t\tVelocity Point", velocityPoint);
-	PrintProperty("\t\tVelocity Fade", velocityFade);
-	PrintTone(tone);
+	PrintProperty(out, "\t\tEnabled", enabled);
+	PrintProperty(out, "\t\tSelected", selected);
+	PrintProperty(out, "\t\tKey Range Low", KeyName(keyRangeLow));
+	PrintProperty(out, "\t\tKey Range High", KeyName(keyRangeHigh));
+	PrintProperty(out, "\t\tVelocity Range", SafeTable(VelocityRange990, velocityRange));
+	PrintProperty(out, "\t\tVelocity Point", velocityPoint);
+	PrintProperty(out, "\t\tVelocity Fade", velocityFade);
+	PrintTone(out, tone);
 }
 
-void PrintEQ(const EQ990 &eq)
+void PrintEQ(std::ostream &out, const EQ990 &eq)
 {
-	std::cout << "\tEQ" << std::endl;
-	PrintProperty("\t\tLow Frequency", SafeTable(EQLowFreq, eq.lowFreq));
-	PrintProperty("\t\tLow Gain", eq.lowGain, 15);
-	PrintProperty("\t\tMid Frequency", SafeTable(EQMidFreq, eq.midFreq));
-	PrintProperty("\t\tMid Q", SafeTable(EQMidQ, eq.midQ) * 0.1);
-	PrintProperty("\t\tMid Gain", eq.midGain, 15);
-	PrintProperty("\t\tHigh Frequency", SafeTable(EQHighFreq, eq.highFreq));
-	PrintProperty("\t\tHigh Gain", eq.highGain, 15);
+	out << "\tEQ" << std::endl;
+	PrintProperty(out, "\t\tLow Frequency", SafeTable(EQLowFreq, eq.lowFreq));
+	PrintProperty(out, "\t\tLow Gain", eq.lowGain, 15);
+	PrintProperty(out, "\t\tMid Frequency", SafeTable(EQMidFreq, eq.midFreq));
+	PrintProperty(out, "\t\tMid Q", SafeTable(EQMidQ, eq.midQ) * 0.1);
+	PrintProperty(out, "\t\tMid Gain", eq.midGain, 15);
+	PrintProperty(out, "\t\tHigh Frequency", SafeTable(EQHighFreq, eq.highFreq));
+	PrintProperty(out, "\t\tHigh Gain", eq.highGain, 15);
 }
 
-void PrintPatch(const Patch990 &patch)
+void PrintPatch(std::ostream &out, const Patch990 &patch)
 {
-	std::cout << "\tCommon" << std::endl;
-	PrintProperty("\t\tPatch Level", patch.common.patchLevel);
-	PrintProperty("\t\tPatch Pan", patch.common.patchPan, 50);
-	PrintProperty("\t\tAnalog Feel", patch.common.analogFeel);
-	PrintProperty("\t\tVoice Priority", patch.common.voicePriority ? "LOUDEST" : "LAST");
-	PrintProperty("\t\tBender Range Down", patch.common.bendRangeDown);
-	PrintProperty("\t\tBender Range Up", patch.common.bendRangeUp);
-	PrintProperty("\t\tTone Control Source 1", SafeTable(ControlSource990, patch.common.toneControlSource1));
-	PrintProperty("\t\tTone Control Source 2", SafeTable(ControlSource990, patch.common.toneControlSource2));
-	PrintProperty("\t\tOctave Switch", patch.octaveSwitch);
-	std::cout << "\tKey Effects" << std::endl;
-	PrintProperty("\t\tSolo Switch", patch.keyEffects.soloSW != 0);
-	PrintProperty("\t\tSolo Legato", patch.keyEffects.soloLegato != 0);
-	PrintProperty("\t\tSolo Sync Master", SafeTable(SoloSyncMaster990, patch.keyEffects.soloSyncMaster));
-	PrintProperty("\t\tPortamento Switch", patch.keyEffects.portamentoSW != 0);
-	PrintProperty("\t\tPortamento Mode", patch.keyEffects.portamentoMode ? "LEGATO" : "NORMAL");
-	PrintProperty("\t\tPortamento Type", patch.keyEffects.portamentoType ? "RATE" : "TIME");
-	PrintProperty("\t\tPortamento Time", patch.keyEffects.portamentoTime);
-	PrintEQ(patch.eq);
-	std::cout << "\tStructure Type" << std::endl;
-	PrintProperty("\t\tTone A/B Structure", patch.structureType.structureAB);
-	PrintProperty("\t\tTone C/D Structure", patch.structureType.structureCD);
-	std::cout << "\tEffects" << std::endl;
-	PrintProperty("\t\tControl Source 1", SafeTable(ControlSource990, patch.effect.controlSource1));
-	PrintProperty("\t\tControl Destination 1", SafeTable(ControlDestFX990, patch.effect.controlDest1));
-	PrintProperty("\t\tControl Depth 1", patch.effect.controlDepth1, 50);
-	PrintProperty("\t\tControl Source 2", SafeTable(ControlSource990, patch.effect.controlSource2));
-	PrintProperty("\t\tControl Destination 2", SafeTable(ControlDestFX990, patch.effect.controlDest2));
-	PrintProperty("\t\tControl Depth 2", patch.effect.controlDepth2, 50);
-	PrintProperty("\t\tGroup A Sequence", SafeTable(FXGroupASequence, patch.effect.groupAsequence));
-	PrintProperty("\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effect.groupBsequence));
-	PrintProperty("\t\tGroup A Block 1 Switch", patch.effect.groupAblockSwitch1 != 0);
-	PrintProperty("\t\tGroup A Block 2 Switch", patch.effect.groupAblockSwitch2 != 0);
-	PrintProperty("\t\tGroup A Block 3 Switch", patch.effect.groupAblockSwitch3 != 0);
-	PrintProperty("\t\tGroup A Block 4 Switch", patch.effect.groupAblockSwitch4 != 0);
-	PrintProperty("\t\tGroup B Block 1 Switch", patch.effect.groupBblockSwitch1 != 0);
-	PrintProperty("\t\tGroup B Block 2 Switch", patch.effect.groupBblockSwitch2 != 0);
-	PrintProperty("\t\tGroup B Block 3 Switch", patch.effect.groupBblockSwitch3 != 0);
-	PrintProperty("\t\tGroup B Effects Balance", patch.effect.effectsBalanceGroupB);
-	PrintProperty("\t\tDistortion Type", SafeTable(DistortionType, patch.effect.distortionType));
-	PrintProperty("\t\tDistortion Drive", patch.effect.distortionDrive);
-	PrintProperty("\t\tDistortion Level", patch.effect.distortionLevel);
-	PrintProperty("\t\tPhaser Manual", PhaserManual(patch.effect.phaserManual));
-	PrintProperty("\t\tPhaser Rate (Hz)", patch.effect.phaserRate * 0.1 + 0.1);
-	PrintProperty("\t\tPhaser Depth", patch.effect.phaserDepth);
-	PrintProperty("\t\tPhaser Resonance", patch.effect.phaserResonance);
-	PrintProperty("\t\tPhaser Mix", patch.effect.phaserMix);
-	PrintProperty("\t\tSpectrum Band 1", patch.effect.spectrumBand1);
-	PrintProperty("\t\tSpectrum Band 2", patch.effect.spectrumBand2);
-	PrintProperty("\t\tSpectrum Band 3", patch.effect.spectrumBand3);
-	PrintProperty("\t\tSpectrum Band 4", patch.effect.spectrumBand4);
-	PrintProperty("\t\tSpectrum Band 5", patch.effect.spectrumBand5);
-	PrintProperty("\t\tSpectrum Band 6", patch.effect.spectrumBand6);
-	PrintProperty("\t\tSpectrum Bandwidth", patch.effect.spectrumBandwidth);
-	PrintProperty("\t\tEnhancer Sensitivity", patch.effect.enhancerSens);
-	PrintProperty("\t\tEnhancer Mix", patch.effect.enhancerMix);
-	PrintProperty("\t\tDelay Mode", SafeTable(DelayMode990, patch.effect.delayMode));
+	out << "\tCommon" << std::endl;
+	PrintProperty(out, "\t\tPatch Level", patch.common.patchLevel);
+	PrintProperty(out, "\t\tPatch Pan", patch.common.patchPan, 50);
+	PrintProperty(out, "\t\tAnalog Feel", patch.common.analogFeel);
+	PrintProperty(out, "\t\tVoice Priority", patch.common.voicePriority ? "LOUDEST" : "LAST");
+	PrintProperty(out, "\t\tBender Range Down", patch.common.bendRangeDown);
+	PrintProperty(out, "\t\tBender Range Up", patch.common.bendRangeUp);
+	PrintProperty(out, "\t\tTone Control Source 1", SafeTable(ControlSource990, patch.common.toneControlSource1));
+	PrintProperty(out, "\t\tTone Control Source 2", SafeTable(ControlSource990, patch.common.toneControlSource2));
+	PrintProperty(out, "\t\tOctave Switch", patch.octaveSwitch);
+	out << "\tKey Effects" << std::endl;
+	PrintProperty(out, "\t\tSolo Switch", patch.keyEffects.soloSW != 0);
+	PrintProperty(out, "\t\tSolo Legato", patch.keyEffects.soloLegato != 0);
+	PrintProperty(out, "\t\tSolo Sync Master", SafeTable(SoloSyncMaster990, patch.keyEffects.soloSyncMaster));
+	PrintProperty(out, "\t\tPortamento Switch", patch.keyEffects.portamentoSW != 0);
+	PrintProperty(out, "\t\tPortamento Mode", patch.keyEffects.portamentoMode ? "LEGATO" : "NORMAL");
+	PrintProperty(out, "\t\tPortamento Type", patch.keyEffects.portamentoType ? "RATE" : "TIME");
+	PrintProperty(out, "\t\tPortamento Time", patch.keyEffects.portamentoTime);
+	PrintEQ(out, patch.eq);
+	out << "\tStructure Type" << std::endl;
+	PrintProperty(out, "\t\tTone A/B Structure", patch.structureType.structureAB);
+	PrintProperty(out, "\t\tTone C/D Structure", patch.structureType.structureCD);
+	out << "\tEffects" << std::endl;
+	PrintProperty(out, "\t\tControl Source 1", SafeTable(ControlSource990, patch.effect.controlSource1));
+	PrintProperty(out, "\t\tControl Destination 1", SafeTable(ControlDestFX990, patch.effect.controlDest1));
+	PrintProperty(out, "\t\tControl Depth 1", patch.effect.controlDepth1, 50);
+	PrintProperty(out, "\t\tControl Source 2", SafeTable(ControlSource990, patch.effect.controlSource2));
+	PrintProperty(out, "\t\tControl Destination 2", SafeTable(ControlDestFX990, patch.effect.controlDest2));
+	PrintProperty(out, "\t\tControl Depth 2", patch.effect.controlDepth2, 50);
+	PrintProperty(out, "\t\tGroup A Sequence", SafeTable(FXGroupASequence, patch.effect.groupAsequence));
+	PrintProperty(out, "\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effect.groupBsequence));
+	PrintProperty(out, "\t\tGroup A Block 1 Switch", patch.effect.groupAblockSwitch1 != 0);
+	PrintProperty(out, "\t\tGroup A Block 2 Switch", patch.effect.groupAblockSwitch2 != 0);
+	PrintProperty(out, "\t\tGroup A Block 3 Switch", patch.effect.groupAblockSwitch3 != 0);
+	PrintProperty(out, "\t\tGroup A Block 4 Switch", patch.effect.groupAblockSwitch4 != 0);
+	PrintProperty(out, "\t\tGroup B Block 1 Switch", patch.effect.groupBblockSwitch1 != 0);
+	PrintProperty(out, "\t\tGroup B Block 2 Switch", patch.effect.groupBblockSwitch2 != 0);
+	PrintProperty(out, "\t\tGroup B Block 3 Switch", patch.effect.groupBblockSwitch3 != 0);
+	PrintProperty(out, "\t\tGroup B Effects Balance", patch.effect.effectsBalanceGroupB);
+	PrintProperty(out, "\t\tDistortion Type", SafeTable(DistortionType, patch.effect.distortionType));
+	PrintProperty(out, "\t\tDistortion Drive", patch.effect.distortionDrive);
+	PrintProperty(out, "\t\tDistortion Level", patch.effect.distortionLevel);
+	PrintProperty(out, "\t\tPhaser Manual", PhaserManual(patch.effect.phaserManual));
+	PrintProperty(out, "\t\tPhaser Rate (Hz)", patch.effect.phaserRate * 0.1 + 0.1);
+	PrintProperty(out, "\t\tPhaser Depth", patch.effect.phaserDepth);
+	PrintProperty(out, "\t\tPhaser Resonance", patch.effect.phaserResonance);
+	PrintProperty(out, "\t\tPhaser Mix", patch.effect.phaserMix);
+	PrintProperty(out, "\t\tSpectrum Band 1", patch.effect.spectrumBand1);
+	PrintProperty(out, "\t\tSpectrum Band 2", patch.effect.spectrumBand2);
+	PrintProperty(out, "\t\tSpectrum Band 3", patch.effect.spectrumBand3);
+	PrintProperty(out, "\t\tSpectrum Band 4", patch.effect.spectrumBand4);
+	PrintProperty(out, "\t\tSpectrum Band 5", patch.effect.spectrumBand5);
+	PrintProperty(out, "\t\tSpectrum Band 6", patch.effect.spectrumBand6);
+	PrintProperty(out, "\t\tSpectrum Bandwidth", patch.effect.spectrumBandwidth);
+	PrintProperty(out, "\t\tEnhancer Sensitivity", patch.effect.enhancerSens);
+	PrintProperty(out, "\t\tEnhancer Mix", patch.effect.enhancerMix);
+	PrintProperty(out, "\t\tDelay Mode", SafeTable(DelayMode990, patch.effect.delayMode));
 	if (patch.effect.delayCenterTapMSB)
-		PrintProperty("\t\tDelay Center Tap", SafeTable(DelayTime990, patch.effect.delayCenterTapLSB));
+		PrintProperty(out, "\t\tDelay Center Tap", SafeTable(DelayTime990, patch.effect.delayCenterTapLSB));
 	else
-		PrintProperty("\t\tDelay Center Tap (ms)", DelayTime(patch.effect.delayCenterTapLSB));
-	PrintProperty("\t\tDelay Center Level", patch.effect.delayCenterLevel);
+		PrintProperty(out, "\t\tDelay Center Tap (ms)", DelayTime(patch.effect.delayCenterTapLSB));
+	PrintProperty(out, "\t\tDelay Center Level", patch.effect.delayCenterLevel);
 	if (patch.effect.delayLeftTapMSB)
-		PrintProperty("\t\tDelay Left Tap", SafeTable(DelayTime990, patch.effect.delayLeftTapLSB));
+		PrintProperty(out, "\t\tDelay Left Tap", SafeTable(DelayTime990, patch.effect.delayLeftTapLSB));
 	else
-		PrintProperty("\t\tDelay Left Tap (ms)", DelayTime(patch.effect.delayLeftTapLSB));
-	PrintProperty("\t\tDelay Left Level", patch.effect.delayLeftLevel);
+		PrintProperty(out, "\t\tDelay Left Tap (ms)", DelayTime(patch.effect.delayLeftTapLSB));
+	PrintProperty(out, "\t\tDelay Left Level", patch.effect.delayLeftLevel);
 	if (patch.effect.delayRightTapMSB)
-		PrintProperty("\t\tDelay Right  Tap", SafeTable(DelayTime990, patch.effect.delayRightTapLSB));
+		PrintProperty(out, "\t\tDelay Right  Tap", SafeTable(DelayTime990, patch.effect.delayRightTapLSB));
 	else
-		PrintProperty("\t\tDelay Right Tap (ms)", DelayTime(patch.effect.delayRightTapLSB));
-	PrintProperty("\t\tDelay Right Level", patch.effect.delayRightLevel);
-	PrintProperty("\t\tDelay Feedback", patch.effect.delayFeedback);
-	PrintProperty("\t\tChorus Rate (Hz)", 0.1 + patch.effect.chorusRate * 0.1);
-	PrintProperty("\t\tChorus Depth", patch.effect.chorusDepth);
-	PrintProperty("\t\tChorus Delay Time (ms)", ChorusTime(patch.effect.chorusDelayTime));
-	PrintProperty("\t\tChorus Feedback", -98 + patch.effect.chorusFeedback * 2);
-	PrintProperty("\t\tChorus Level", patch.effect.chorusLevel);
-	PrintProperty("\t\tReverb Type", SafeTable(ReverbType, patch.effect.reverbType));
-	PrintProperty("\t\tReverb Pre-Delay", patch.effect.reverbPreDelay);
-	PrintProperty("\t\tReverb Early Reflections Level", patch.effect.reverbEarlyRefLevel);
-	PrintProperty("\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effect.reverbHFDamp));
-	PrintProperty("\t\tReverb Time (ms)", ReverbTime(patch.effect.reverbTime, patch.effect.reverbType));
-	PrintProperty("\t\tReverb Level", patch.effect.reverbLevel);
-	std::cout << "\tTone A" << std::endl;
-	PrintTone(patch.toneA, patch.common.layerTone & 1, patch.common.activeTone & 1, patch.keyRanges.keyRangeLowA, patch.keyRanges.keyRangeHighA, patch.velocity.velocityRange1, patch.velocity.velocityPoint1, patch.velocity.velocityFade1);
-	std::cout << "\tTone B" << std::endl;
-	PrintTone(patch.toneB, patch.common.layerTone & 2, patch.common.activeTone & 2, patch.keyRanges.keyRangeLowB, patch.keyRanges.keyRangeHighB, patch.velocity.velocityRange2, patch.velocity.velocityPoint2, patch.velocity.velocityFade2);
-	std::cout << "\tTone C" << std::endl;
-	PrintTone(patch.toneC, patch.common.layerTone & 4, patch.common.activeTone & 4, patch.keyRanges.keyRangeLowC, patch.keyRanges.keyRangeHighC, patch.velocity.velocityRange3, patch.velocity.velocityPoint3, patch.velocity.velocityFade3);
-	std::cout << "\tTone D" << std::endl;
-	PrintTone(patch.toneD, patch.common.layerTone & 8, patch.common.activeTone & 8, patch.keyRanges.keyRangeLowD, patch.keyRanges.keyRangeHighD, patch.velocity.velocityRange4, patch.velocity.velocityPoint4, patch.velocity.velocityFade4);
+		PrintProperty(out, "\t\tDelay Right Tap (ms)", DelayTime(patch.effect.delayRightTapLSB));
+	PrintProperty(out, "\t\tDelay Right Level", patch.effect.delayRightLevel);
+	PrintProperty(out, "\t\tDelay Feedback", patch.effect.delayFeedback);
+	PrintProperty(out, "\t\tChorus Rate (Hz)", 0.1 + patch.effect.chorusRate * 0.1);
+	PrintProperty(out, "\t\tChorus Depth", patch.effect.chorusDepth);
+	PrintProperty(out, "\t\tChorus Delay Time (ms)", ChorusTime(patch.effect.chorusDelayTime));
+	PrintProperty(out, "\t\tChorus Feedback", -98 + patch.effect.chorusFeedback * 2);
+	PrintProperty(out, "\t\tChorus Level", patch.effect.chorusLevel);
+	PrintProperty(out, "\t\tReverb Type", SafeTable(ReverbType, patch.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Pre-Delay", patch.effect.reverbPreDelay);
+	PrintProperty(out, "\t\tReverb Early Reflections Level", patch.effect.reverbEarlyRefLevel);
+	PrintProperty(out, "\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effect.reverbHFDamp));
+	PrintProperty(out, "\t\tReverb Time (ms)", ReverbTime(patch.effect.reverbTime, patch.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Level", patch.effect.reverbLevel);
+	out << "\tTone A" << std::endl;
+	PrintTone(out, patch.toneA, patch.common.layerTone & 1, patch.common.activeTone & 1, patch.keyRanges.keyRangeLowA, patch.keyRanges.keyRangeHighA, patch.velocity.velocityRange1, patch.velocity.velocityPoint1, patch.velocity.velocityFade1);
+	out << "\tTone B" << std::endl;
+	PrintTone(out, patch.toneB, patch.common.layerTone & 2, patch.common.activeTone & 2, patch.keyRanges.keyRangeLowB, patch.keyRanges.keyRangeHighB, patch.velocity.velocityRange2, patch.velocity.velocityPoint2, patch.velocity.velocityFade2);
+	out << "\tTone C" << std::endl;
+	PrintTone(out, patch.toneC, patch.common.layerTone & 4, patch.common.activeTone & 4, patch.keyRanges.keyRangeLowC, patch.keyRanges.keyRangeHighC, patch.velocity.velocityRange3, patch.velocity.velocityPoint3, patch.velocity.velocityFade3);
+	out << "\tTone D" << std::endl;
+	PrintTone(out, patch.toneD, patch.common.layerTone & 8, patch.common.activeTone & 8, patch.keyRanges.keyRangeLowD, patch.keyRanges.keyRangeHighD, patch.velocity.velocityRange4, patch.velocity.velocityPoint4, patch.velocity.velocityFade4);
 }
 
-void PrintSetup(const SpecialSetup990 &setup)
+void PrintSetup(std::ostream &out, const SpecialSetup990 &setup)
 {
-	std::cout << "\tCommon" << std::endl;
-	PrintProperty("\t\tLevel", setup.common.level);
-	PrintProperty("\t\tPan", setup.common.pan, 50);
-	PrintProperty("\t\tAnalog Feel", setup.common.analogFeel);
-	PrintProperty("\t\tBender Range Down", setup.common.benderRangeDown);
-	PrintProperty("\t\tBender Range Up", setup.common.benderRangeUp);
-	PrintProperty("\t\tTone Control Source 1", SafeTable(ControlSource990, setup.common.toneControlSource1));
-	PrintProperty("\t\tTone Control Source 2", SafeTable(ControlSource990, setup.common.toneControlSource2));
-	PrintEQ(setup.eq);
-	std::cout << "\tEffects" << std::endl;
-	PrintProperty("\t\tControl Source 1", SafeTable(ControlSource990, setup.effect.controlSource1));
-	PrintProperty("\t\tControl Destination 1", SafeTable(ControlDestFX990, setup.effect.controlDest1));
-	PrintProperty("\t\tControl Depth 1", setup.effect.controlDepth1, 50);
-	PrintProperty("\t\tControl Source 2", SafeTable(ControlSource990, setup.effect.controlSource2));
-	PrintProperty("\t\tControl Destination 2", SafeTable(ControlDestFX990, setup.effect.controlDest2));
-	PrintProperty("\t\tControl Depth 2", setup.effect.controlDepth2, 50);
-	PrintProperty("\t\tDelay Mode", SafeTable(DelayMode990, setup.effect.delayMode));
+	out << "\tCommon" << std::endl;
+	PrintProperty(out, "\t\tLevel", setup.common.level);
+	PrintProperty(out, "\t\tPan", setup.common.pan, 50);
+	PrintProperty(out, "\t\tAnalog Feel", setup.common.analogFeel);
+	PrintProperty(out, "\t\tBender Range Down", setup.common.benderRangeDown);
+	PrintProperty(out, "\t\tBender Range Up", setup.common.benderRangeUp);
+	PrintProperty(out, "\t\tTone Control Source 1", SafeTable(ControlSource990, setup.common.toneControlSource1));
+	PrintProperty(out, "\t\tTone Control Source 2", SafeTable(ControlSource990, setup.common.toneControlSource2));
+	PrintEQ(out, setup.eq);
+	out << "\tEffects" << std::endl;
+	PrintProperty(out, "\t\tControl Source 1", SafeTable(ControlSource990, setup.effect.controlSource1));
+	PrintProperty(out, "\t\tControl Destination 1", SafeTable(ControlDestFX990, setup.effect.controlDest1));
+	PrintProperty(out, "\t\tControl Depth 1", setup.effect.controlDepth1, 50);
+	PrintProperty(out, "\t\tControl Source 2", SafeTable(ControlSource990, setup.effect.controlSource2));
+	PrintProperty(out, "\t\tControl Destination 2", SafeTable(ControlDestFX990, setup.effect.controlDest2));
+	PrintProperty(out, "\t\tControl Depth 2", setup.effect.controlDepth2, 50);
+	PrintProperty(out, "\t\tDelay Mode", SafeTable(DelayMode990, setup.effect.delayMode));
 	if (setup.effect.delayCenterTapMSB)
-		PrintProperty("\t\tDelay Center Tap", SafeTable(DelayTime990, setup.effect.delayCenterTapLSB));
+		PrintProperty(out, "\t\tDelay Center Tap", SafeTable(DelayTime990, setup.effect.delayCenterTapLSB));
 	else
-		PrintProperty("\t\tDelay Center Tap (ms)", DelayTime(setup.effect.delayCenterTapLSB));
-	PrintProperty("\t\tDelay Center Level", setup.effect.delayCenterLevel);
+		PrintProperty(out, "\t\tDelay Center Tap (ms)", DelayTime(setup.effect.delayCenterTapLSB));
+	PrintProperty(out, "\t\tDelay Center Level", setup.effect.delayCenterLevel);
 	if (setup.effect.delayLeftTapMSB)
-		PrintProperty("\t\tDelay Left Tap", SafeTable(DelayTime990, setup.effect.delayLeftTapLSB));
+		PrintProperty(out, "\t\tDelay Left Tap", SafeTable(DelayTime990, setup.effect.delayLeftTapLSB));
 	else
-		PrintProperty("\t\tDelay Left Tap (ms)", DelayTime(setup.effect.delayLeftTapLSB));
-	PrintProperty("\t\tDelay Left Level", setup.effect.delayLeftLevel);
+		PrintProperty(out, "\t\tDelay Left Tap (ms)", DelayTime(setup.effect.delayLeftTapLSB));
+	PrintProperty(out, "\t\tDelay Left Level", setup.effect.delayLeftLevel);
 	if (setup.effect.delayRightTapMSB)
-		PrintProperty("\t\tDelay Right  Tap", SafeTable(DelayTime990, setup.effect.delayRightTapLSB));
+		PrintProperty(out, "\t\tDelay Right  Tap", SafeTable(DelayTime990, setup.effect.delayRightTapLSB));
 	else
-		PrintProperty("\t\tDelay Right Tap (ms)", DelayTime(setup.effect.delayRightTapLSB));
-	PrintProperty("\t\tDelay Right Level", setup.effect.delayRightLevel);
-	PrintProperty("\t\tDelay Feedback", setup.effect.delayFeedback);
-	PrintProperty("\t\tChorus Rate (Hz)", 0.1 + setup.effect.chorusRate * 0.1);
-	PrintProperty("\t\tChorus Depth", setup.effect.chorusDepth);
-	PrintProperty("\t\tChorus Delay Time (ms)", ChorusTime(setup.effect.chorusDelayTime));
-	PrintProperty("\t\tChorus Feedback", -98 + setup.effect.chorusFeedback * 2);
-	PrintProperty("\t\tChorus Level", setup.effect.chorusLevel);
-	PrintProperty("\t\tReverb Type", SafeTable(ReverbType, setup.effect.reverbType));
-	PrintProperty("\t\tReverb Pre-Delay", setup.effect.reverbPreDelay);
-	PrintProperty("\t\tReverb Early Reflections Level", setup.effect.reverbEarlyRefLevel);
-	PrintProperty("\t\tReverb HF Damp", SafeTable(ReverbHFDamp, setup.effect.reverbHFDamp));
-	PrintProperty("\t\tReverb Time (ms)", ReverbTime(setup.effect.reverbTime, setup.effect.reverbType));
-	PrintProperty("\t\tReverb Level", setup.effect.reverbLevel);
+		PrintProperty(out, "\t\tDelay Right Tap (ms)", DelayTime(setup.effect.delayRightTapLSB));
+	PrintProperty(out, "\t\tDelay Right Level", setup.effect.delayRightLevel);
+	PrintProperty(out, "\t\tDelay Feedback", setup.effect.delayFeedback);
+	PrintProperty(out, "\t\tChorus Rate (Hz)", 0.1 + setup.effect.chorusRate * 0.1);
+	PrintProperty(out, "\t\tChorus Depth", setup.effect.chorusDepth);
+	PrintProperty(out, "\t\tChorus Delay Time (ms)", ChorusTime(setup.effect.chorusDelayTime));
+	PrintProperty(out, "\t\tChorus Feedback", -98 + setup.effect.chorusFeedback * 2);
+	PrintProperty(out, "\t\tChorus Level", setup.effect.chorusLevel);
+	PrintProperty(out, "\t\tReverb Type", SafeTable(ReverbType, setup.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Pre-Delay", setup.effect.reverbPreDelay);
+	PrintProperty(out, "\t\tReverb Early Reflections Level", setup.effect.reverbEarlyRefLevel);
+	PrintProperty(out, "\t\tReverb HF Damp", SafeTable(ReverbHFDamp, setup.effect.reverbHFDamp));
+	PrintProperty(out, "\t\tReverb Time (ms)", ReverbTime(setup.effect.reverbTime, setup.effect.reverbType));
+	PrintProperty(out, "\t\tReverb Level", setup.effect.reverbLevel);
 	for (int i = 0; i < 61; i++)
 	{
-		std::cout << "\tKey " << KeyName(i + 24) << ": " << ToString(setup.keys[i].name) << std::endl;
-		PrintProperty("\t\tEnvelope Mode", setup.keys[i].envMode ? "NO SUSTAIN" : "SUSTAIN");
-		PrintProperty("\t\tMute Group", setup.keys[i].muteGroup ? std::string(1, 'A' + setup.keys[i].muteGroup - 1) : "OFF");
-		PrintProperty("\t\tEffect Mode", SafeTable(SetupEffectMode990, setup.keys[i].effectMode));
-		PrintProperty("\t\tEffect Level", setup.keys[i].effectLevel);
-		PrintTone(setup.keys[i].tone);
+		out << "\tKey " << KeyName(i + 24) << ": " << ToString(setup.keys[i].name) << std::endl;
+		PrintProperty(out, "\t\tEnvelope Mode", setup.keys[i].envMode ? "NO SUSTAIN" : "SUSTAIN");
+		PrintProperty(out, "\t\tMute Group", setup.keys[i].muteGroup ? std::string(1, 'A' + setup.keys[i].muteGroup - 1) : "OFF");
+		PrintProperty(out, "\t\tEffect Mode", SafeTable(SetupEffectMode990, setup.keys[i].effectMode));
+		PrintProperty(out, "\t\tEffect Level", setup.keys[i].effectLevel);
+		PrintTone(out, setup.keys[i].tone);
 	}
 }
 
-static void PrintLFO(const ToneVST::LFO &lfo)
+static void PrintLFO(std::ostream &out, const ToneVST::LFO &lfo)
 {
-	PrintProperty("\t\t\tTempo Sync", lfo.tempoSync != 0);
+	PrintProperty(out, "\t\t\tTempo Sync", lfo.tempoSync != 0);
 	if(lfo.tempoSync)
-		PrintProperty("\t\t\tRate", SafeTable(TempoSyncVST, lfo.rateWithTempoSync));
+		PrintProperty(out, "\t\t\tRate", SafeTable(TempoSyncVST, lfo.rateWithTempoSync));
 	else
-		PrintProperty("\t\t\tRate", lfo.rate);
+		PrintProperty(out, "\t\t\tRate", lfo.rate);
 	if (lfo.delay == 101)
-		PrintProperty("\t\t\tDelay", "REL");
+		PrintProperty(out, "\t\t\tDelay", "REL");
 	else
-		PrintProperty("\t\t\tDelay", lfo.delay);
-	PrintProperty("\t\t\tFade", lfo.fade);
-	PrintProperty("\t\t\tWaveform", SafeTable(LFOWaveform800, lfo.waveform));
-	PrintProperty("\t\t\tOffset", SafeTable(LFOOffset, 2 - lfo.offset));
-	PrintProperty("\t\t\tKey Trigger", lfo.keyTrigger != 0);
+		PrintProperty(out, "\t\t\tDelay", lfo.delay);
+	PrintProperty(out, "\t\t\tFade", lfo.fade);
+	PrintProperty(out, "\t\t\tWaveform", SafeTable(LFOWaveform800, lfo.waveform));
+	PrintProperty(out, "\t\t\tOffset", SafeTable(LFOOffset, 2 - lfo.offset));
+	PrintProperty(out, "\t\t\tKey Trigger", lfo.keyTrigger != 0);
 }
 
-static void PrintTone(const ToneVST &tone, uint8_t keyRangeLow, uint8_t keyRangeHigh)
+static void PrintTone(std::ostream &out, const ToneVST &tone, uint8_t keyRangeLow, uint8_t keyRangeHigh)
 {
-	PrintProperty("\t\tEnabled", tone.common.layerEnabled != 0);
-	PrintProperty("\t\tSelected", tone.common.layerSelected != 0);
-	PrintProperty("\t\tKey Range Low", KeyName(keyRangeLow));
-	PrintProperty("\t\tKey Range High", KeyName(keyRangeHigh));
-	std::cout << "\t\tCommon" << std::endl;
-	PrintProperty("\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
-	PrintProperty("\t\t\tHold Control", tone.common.holdControl != 0);
-	std::cout << "\t\tLFO 1" << std::endl;
-	PrintLFO(tone.lfo1);
-	std::cout << "\t\tLFO 2" << std::endl;
-	PrintLFO(tone.lfo2);
-	std::cout << "\t\tWG" << std::endl;
+	PrintProperty(out, "\t\tEnabled", tone.common.layerEnabled != 0);
+	PrintProperty(out, "\t\tSelected", tone.common.layerSelected != 0);
+	PrintProperty(out, "\t\tKey Range Low", KeyName(keyRangeLow));
+	PrintProperty(out, "\t\tKey Range High", KeyName(keyRangeHigh));
+	out << "\t\tCommon" << std::endl;
+	PrintProperty(out, "\t\t\tVelocity Curve", tone.common.velocityCurve + 1);
+	PrintProperty(out, "\t\t\tHold Control", tone.common.holdControl != 0);
+	out << "\t\tLFO 1" << std::endl;
+	PrintLFO(out, tone.lfo1);
+	out << "\t\tLFO 2" << std::endl;
+	PrintLFO(out, tone.lfo2);
+	out << "\t\tWG" << std::endl;
 	const char *waveformName = SafeTable(WaveformNames, tone.wg.waveformLSB);
 	if (tone.wg.waveformLSB == 88)
 		waveformName = WaveformNames[89];
 	else if (tone.wg.waveformLSB == 89)
 		waveformName = WaveformNames[88];
-	std::cout << "\t\t\tWaveform: " << static_cast<int>(tone.wg.waveformLSB) << " (" << waveformName << ")" << std::endl;
-	PrintProperty("\t\t\tGain (dB)", (tone.wg.gain - 3) * 6);
-	PrintProperty("\t\t\tPitch Coarse", tone.wg.pitchCoarse);
-	PrintProperty("\t\t\tPitch Fine", tone.wg.pitchFine);
-	PrintProperty("\t\t\tPitch Random", tone.wg.pitchRandom);
-	PrintProperty("\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
-	PrintProperty("\t\t\tBender Switch", tone.wg.benderSwitch != 0);
-	PrintProperty("\t\t\tAftertouch Bend", tone.wg.aTouchBend != 0);
-	PrintProperty("\t\t\tLFO 1 Amount", tone.wg.lfo1Sens);
-	PrintProperty("\t\t\tLFO 2 Amount", tone.wg.lfo2Sens);
-	PrintProperty("\t\t\tLever Destination", SafeTable(LFOSelect, (tone.wg.leverSens < 0) ? 1 : 0));
-	PrintProperty("\t\t\tLever LFO Amount", std::abs(tone.wg.leverSens));
-	PrintProperty("\t\t\tAftertouch Destination", SafeTable(LFOSelect, (tone.wg.aTouchModSens < 0) ? 1 : 0));
-	PrintProperty("\t\t\tAftertouch LFO Amount", std::abs(tone.wg.aTouchModSens));
-	std::cout << "\t\tPitch Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.pitchEnv.velo);
-	PrintProperty("\t\t\tTime Velo", tone.pitchEnv.timeVelo);
-	PrintProperty("\t\t\tTime Key Follow", tone.pitchEnv.timeKF);
-	PrintProperty("\t\t\tLevel 0", tone.pitchEnv.level0);
-	PrintProperty("\t\t\tTime 1", tone.pitchEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.pitchEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.pitchEnv.time2);
-	PrintProperty("\t\t\tTime 3", tone.pitchEnv.time3);
-	PrintProperty("\t\t\tLevel 2", tone.pitchEnv.level2);
-	std::cout << "\t\tTVF" << std::endl;
-	PrintProperty("\t\t\tFilter Mode", SafeTable(FilterMode, 2 - tone.tvf.filterMode));
-	PrintProperty("\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
-	PrintProperty("\t\t\tResonance", tone.tvf.resonance);
-	PrintProperty("\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
-	PrintProperty("\t\t\tAftertouch Amount", tone.tvf.aTouchSens);
-	PrintProperty("\t\t\tLFO Source", SafeTable(LFOSelect, tone.tvf.lfoSelect));
-	PrintProperty("\t\t\tLFO Depth", tone.tvf.lfoDepth);
-	PrintProperty("\t\t\tEnvelope Depth", tone.tvf.envDepth);
-	std::cout << "\t\tTVF Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvfEnv.velo);
-	PrintProperty("\t\t\tTime Velo", tone.tvfEnv.timeVelo);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvfEnv.timeKF);
-	PrintProperty("\t\t\tTime 1", tone.tvfEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvfEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvfEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvfEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvfEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvfEnv.time4);
-	PrintProperty("\t\t\tLevel 4", tone.tvfEnv.level4);
-	std::cout << "\t\tTVA" << std::endl;
-	PrintProperty("\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
-	PrintProperty("\t\t\tBias Point", KeyName(tone.tva.biasPoint));
-	PrintProperty("\t\t\tBias Level", tone.tva.biasLevel);
-	PrintProperty("\t\t\tLevel", tone.tva.level);
-	PrintProperty("\t\t\tAftertouch Amount", tone.tva.aTouchSens);
-	PrintProperty("\t\t\tLFO Source", SafeTable(LFOSelect, tone.tva.lfoSelect));
-	PrintProperty("\t\t\tLFO Depth", tone.tva.lfoDepth);
-	std::cout << "\t\tTVA Envelope" << std::endl;
-	PrintProperty("\t\t\tVelo", tone.tvaEnv.velo);
-	PrintProperty("\t\t\tTime Velo", tone.tvaEnv.timeVelo);
-	PrintProperty("\t\t\tTime Key Follow", tone.tvaEnv.timeKF);
-	PrintProperty("\t\t\tTime 1", tone.tvaEnv.time1);
-	PrintProperty("\t\t\tLevel 1", tone.tvaEnv.level1);
-	PrintProperty("\t\t\tTime 2", tone.tvaEnv.time2);
-	PrintProperty("\t\t\tLevel 2", tone.tvaEnv.level2);
-	PrintProperty("\t\t\tTime 3", tone.tvaEnv.time3);
-	PrintProperty("\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
-	PrintProperty("\t\t\tTime 4", tone.tvaEnv.time4);
+	out << "\t\t\tWaveform: " << static_cast<int>(tone.wg.waveformLSB) << " (" << waveformName << ")" << std::endl;
+	PrintProperty(out, "\t\t\tGain (dB)", (tone.wg.gain - 3) * 6);
+	PrintProperty(out, "\t\t\tPitch Coarse", tone.wg.pitchCoarse);
+	PrintProperty(out, "\t\t\tPitch Fine", tone.wg.pitchFine);
+	PrintProperty(out, "\t\t\tPitch Random", tone.wg.pitchRandom);
+	PrintProperty(out, "\t\t\tKey Follow", SafeTable(PitchKF, tone.wg.keyFollow));
+	PrintProperty(out, "\t\t\tBender Switch", tone.wg.benderSwitch != 0);
+	PrintProperty(out, "\t\t\tAftertouch Bend", tone.wg.aTouchBend != 0);
+	PrintProperty(out, "\t\t\tLFO 1 Amount", tone.wg.lfo1Sens);
+	PrintProperty(out, "\t\t\tLFO 2 Amount", tone.wg.lfo2Sens);
+	PrintProperty(out, "\t\t\tLever Destination", SafeTable(LFOSelect, (tone.wg.leverSens < 0) ? 1 : 0));
+	PrintProperty(out, "\t\t\tLever LFO Amount", std::abs(tone.wg.leverSens));
+	PrintProperty(out, "\t\t\tAftertouch Destination", SafeTable(LFOSelect, (tone.wg.aTouchModSens < 0) ? 1 : 0));
+	PrintProperty(out, "\t\t\tAftertouch LFO Amount", std::abs(tone.wg.aTouchModSens));
+	out << "\t\tPitch Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.pitchEnv.velo);
+	PrintProperty(out, "\t\t\tTime Velo", tone.pitchEnv.timeVelo);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.pitchEnv.timeKF);
+	PrintProperty(out, "\t\t\tLevel 0", tone.pitchEnv.level0);
+	PrintProperty(out, "\t\t\tTime 1", tone.pitchEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.pitchEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.pitchEnv.time2);
+	PrintProperty(out, "\t\t\tTime 3", tone.pitchEnv.time3);
+	PrintProperty(out, "\t\t\tLevel 2", tone.pitchEnv.level2);
+	out << "\t\tTVF" << std::endl;
+	PrintProperty(out, "\t\t\tFilter Mode", SafeTable(FilterMode, 2 - tone.tvf.filterMode));
+	PrintProperty(out, "\t\t\tCutoff Frequency", tone.tvf.cutoffFreq);
+	PrintProperty(out, "\t\t\tResonance", tone.tvf.resonance);
+	PrintProperty(out, "\t\t\tKey Follow", CutoffKeyFollow(tone.tvf.keyFollow));
+	PrintProperty(out, "\t\t\tAftertouch Amount", tone.tvf.aTouchSens);
+	PrintProperty(out, "\t\t\tLFO Source", SafeTable(LFOSelect, tone.tvf.lfoSelect));
+	PrintProperty(out, "\t\t\tLFO Depth", tone.tvf.lfoDepth);
+	PrintProperty(out, "\t\t\tEnvelope Depth", tone.tvf.envDepth);
+	out << "\t\tTVF Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvfEnv.velo);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvfEnv.timeVelo);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvfEnv.timeKF);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvfEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvfEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvfEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvfEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvfEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvfEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvfEnv.time4);
+	PrintProperty(out, "\t\t\tLevel 4", tone.tvfEnv.level4);
+	out << "\t\tTVA" << std::endl;
+	PrintProperty(out, "\t\t\tBias Direction", SafeTable(BiasDirection, tone.tva.biasDirection));
+	PrintProperty(out, "\t\t\tBias Point", KeyName(tone.tva.biasPoint));
+	PrintProperty(out, "\t\t\tBias Level", tone.tva.biasLevel);
+	PrintProperty(out, "\t\t\tLevel", tone.tva.level);
+	PrintProperty(out, "\t\t\tAftertouch Amount", tone.tva.aTouchSens);
+	PrintProperty(out, "\t\t\tLFO Source", SafeTable(LFOSelect, tone.tva.lfoSelect));
+	PrintProperty(out, "\t\t\tLFO Depth", tone.tva.lfoDepth);
+	out << "\t\tTVA Envelope" << std::endl;
+	PrintProperty(out, "\t\t\tVelo", tone.tvaEnv.velo);
+	PrintProperty(out, "\t\t\tTime Velo", tone.tvaEnv.timeVelo);
+	PrintProperty(out, "\t\t\tTime Key Follow", tone.tvaEnv.timeKF);
+	PrintProperty(out, "\t\t\tTime 1", tone.tvaEnv.time1);
+	PrintProperty(out, "\t\t\tLevel 1", tone.tvaEnv.level1);
+	PrintProperty(out, "\t\t\tTime 2", tone.tvaEnv.time2);
+	PrintProperty(out, "\t\t\tLevel 2", tone.tvaEnv.level2);
+	PrintProperty(out, "\t\t\tTime 3", tone.tvaEnv.time3);
+	PrintProperty(out, "\t\t\tSustain Level", tone.tvaEnv.sustainLevel);
+	PrintProperty(out, "\t\t\tTime 4", tone.tvaEnv.time4);
 }
 
-void PrintPatch(const PatchVST &patch)
+void PrintPatch(std::ostream &out, const PatchVST &patch)
 {
-	std::cout << "\tCommon" << std::endl;
-	PrintProperty("\t\tPatch Level", patch.common.patchLevel);
-	PrintProperty("\t\tBender Range Down", patch.common.benderRangeDown);
-	PrintProperty("\t\tBender Range Up", patch.common.benderRangeUp);
-	PrintProperty("\t\tAftertouch Bend Amount", ATouchBendSens(patch.common.aTouchBend));
-	PrintProperty("\t\tSolo Switch", patch.common.soloSW != 0);
-	PrintProperty("\t\tSolo Legato", patch.common.soloLegato != 0);
-	PrintProperty("\t\tPortamento Switch", patch.common.portamentoSW != 0);
-	PrintProperty("\t\tPortamento Mode", patch.common.portamentoMode ? "LEGATO" : "NORMAL");
-	PrintProperty("\t\tPortamento Time", patch.common.portamentoTime);
-	PrintProperty("\t\tUnison", patch.unison != 0);
-	std::cout << "\tEQ" << std::endl;
-	PrintProperty("\t\tEnabled", patch.eq.eqEnabled);
-	PrintProperty("\t\tLow Frequency", patch.eq.lowFreq);
-	PrintProperty("\t\tLow Gain", static_cast<int16_t>(patch.eq.lowGain) * 0.1);
-	PrintProperty("\t\tMid Frequency", patch.eq.midFreq);
-	PrintProperty("\t\tMid Q", patch.eq.midQ * 0.1);
-	PrintProperty("\t\tMid Gain", static_cast<int16_t>(patch.eq.midGain) * 0.1);
-	PrintProperty("\t\tHigh Frequency", patch.eq.highFreq);
-	PrintProperty("\t\tHigh Gain", static_cast<int16_t>(patch.eq.highGain) * 0.1);
-	std::cout << "\tEffects" << std::endl;
-	PrintProperty("\t\tMFX Type", patch.effectsGroupA.mfxType);
-	PrintProperty("\t\tGroup A Enabled", patch.effectsGroupA.groupAenabled);
-	PrintProperty("\t\tGroup A Sequence", SafeTable(FXGroupASequence, static_cast<uint8_t>(patch.effectsGroupA.groupAsequence)));
-	PrintProperty("\t\tGroup A Panning", patch.effectsGroupA.panningGroupA);
-	PrintProperty("\t\tGroup A Level", patch.effectsGroupA.effectsLevelGroupA);
-	PrintProperty("\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effectsGroupB.groupBsequence));
-	PrintProperty("\t\tGroup B Effects Balance", patch.effectsGroupB.effectsBalanceGroupB);
-	PrintProperty("\t\tGroup B Effects Level", patch.effectsGroupB.effectsLevelGroupB);
-	PrintProperty("\t\tDistortion Enabled", patch.effectsGroupA.distortionEnabled);
-	PrintProperty("\t\tDistortion Type", SafeTable(DistortionType, static_cast<uint8_t>(patch.effectsGroupA.distortionType)));
-	PrintProperty("\t\tDistortion Drive", patch.effectsGroupA.distortionDrive);
-	PrintProperty("\t\tDistortion Level", patch.effectsGroupA.distortionLevel);
-	PrintProperty("\t\tPhaser Enabled", patch.effectsGroupA.phaserEnabled);
-	PrintProperty("\t\tPhaser Manual", PhaserManual(patch.effectsGroupA.phaserManual));
-	PrintProperty("\t\tPhaser Rate (Hz)", patch.effectsGroupA.phaserRate * 0.1);
-	PrintProperty("\t\tPhaser Depth", patch.effectsGroupA.phaserDepth);
-	PrintProperty("\t\tPhaser Resonance", patch.effectsGroupA.phaserResonance);
-	PrintProperty("\t\tPhaser Mix", patch.effectsGroupA.phaserMix);
-	PrintProperty("\t\tSpectrum Enabled", patch.effectsGroupA.spectrumEnabled);
-	PrintProperty("\t\tSpectrum Band 1", patch.effectsGroupA.spectrumBand1);
-	PrintProperty("\t\tSpectrum Band 2", patch.effectsGroupA.spectrumBand2);
-	PrintProperty("\t\tSpectrum Band 3", patch.effectsGroupA.spectrumBand3);
-	PrintProperty("\t\tSpectrum Band 4", patch.effectsGroupA.spectrumBand4);
-	PrintProperty("\t\tSpectrum Band 5", patch.effectsGroupA.spectrumBand5);
-	PrintProperty("\t\tSpectrum Band 6", patch.effectsGroupA.spectrumBand6);
-	PrintProperty("\t\tSpectrum Bandwidth", patch.effectsGroupA.spectrumBandwidth);
-	PrintProperty("\t\tEnhancer Enabled", patch.effectsGroupA.enhancerEnabled);
-	PrintProperty("\t\tEnhancer Sensitivity", patch.effectsGroupA.enhancerSens);
-	PrintProperty("\t\tEnhancer Mix", patch.effectsGroupA.enhancerMix);
-	PrintProperty("\t\tDelay Enabled", patch.effectsGroupB.delayEnabled);
-	PrintProperty("\t\tDelay Center Tempo Sync", patch.effectsGroupB.delayCenterTempoSync != 0);
+	out << "\tCommon" << std::endl;
+	PrintProperty(out, "\t\tPatch Level", patch.common.patchLevel);
+	PrintProperty(out, "\t\tBender Range Down", patch.common.benderRangeDown);
+	PrintProperty(out, "\t\tBender Range Up", patch.common.benderRangeUp);
+	PrintProperty(out, "\t\tAftertouch Bend Amount", ATouchBendSens(patch.common.aTouchBend));
+	PrintProperty(out, "\t\tSolo Switch", patch.common.soloSW != 0);
+	PrintProperty(out, "\t\tSolo Legato", patch.common.soloLegato != 0);
+	PrintProperty(out, "\t\tPortamento Switch", patch.common.portamentoSW != 0);
+	PrintProperty(out, "\t\tPortamento Mode", patch.common.portamentoMode ? "LEGATO" : "NORMAL");
+	PrintProperty(out, "\t\tPortamento Time", patch.common.portamentoTime);
+	PrintProperty(out, "\t\tUnison", patch.unison != 0);
+	out << "\tEQ" << std::endl;
+	PrintProperty(out, "\t\tEnabled", patch.eq.eqEnabled);
+	PrintProperty(out, "\t\tLow Frequency", patch.eq.lowFreq);
+	PrintProperty(out, "\t\tLow Gain", static_cast<int16_t>(patch.eq.lowGain) * 0.1);
+	PrintProperty(out, "\t\tMid Frequency", patch.eq.midFreq);
+	PrintProperty(out, "\t\tMid Q", patch.eq.midQ * 0.1);
+	PrintProperty(out, "\t\tMid Gain", static_cast<int16_t>(patch.eq.midGain) * 0.1);
+	PrintProperty(out, "\t\tHigh Frequency", patch.eq.highFreq);
+	PrintProperty(out, "\t\tHigh Gain", static_cast<int16_t>(patch.eq.highGain) * 0.1);
+	out << "\tEffects" << std::endl;
+	PrintProperty(out, "\t\tMFX Type", patch.effectsGroupA.mfxType);
+	PrintProperty(out, "\t\tGroup A Enabled", patch.effectsGroupA.groupAenabled);
+	PrintProperty(out, "\t\tGroup A Sequence", SafeTable(FXGroupASequence, static_cast<uint8_t>(patch.effectsGroupA.groupAsequence)));
+	PrintProperty(out, "\t\tGroup A Panning", patch.effectsGroupA.panningGroupA);
+	PrintProperty(out, "\t\tGroup A Level", patch.effectsGroupA.effectsLevelGroupA);
+	PrintProperty(out, "\t\tGroup B Sequence", SafeTable(FXGroupBSequence, patch.effectsGroupB.groupBsequence));
+	PrintProperty(out, "\t\tGroup B Effects Balance", patch.effectsGroupB.effectsBalanceGroupB);
+	PrintProperty(out, "\t\tGroup B Effects Level", patch.effectsGroupB.effectsLevelGroupB);
+	PrintProperty(out, "\t\tDistortion Enabled", patch.effectsGroupA.distortionEnabled);
+	PrintProperty(out, "\t\tDistortion Type", SafeTable(DistortionType, static_cast<uint8_t>(patch.effectsGroupA.distortionType)));
+	PrintProperty(out, "\t\tDistortion Drive", patch.effectsGroupA.distortionDrive);
+	PrintProperty(out, "\t\tDistortion Level", patch.effectsGroupA.distortionLevel);
+	PrintProperty(out, "\t\tPhaser Enabled", patch.effectsGroupA.phaserEnabled);
+	PrintProperty(out, "\t\tPhaser Manual", PhaserManual(patch.effectsGroupA.phaserManual));
+	PrintProperty(out, "\t\tPhaser Rate (Hz)", patch.effectsGroupA.phaserRate * 0.1);
+	PrintProperty(out, "\t\tPhaser Depth", patch.effectsGroupA.phaserDepth);
+	PrintProperty(out, "\t\tPhaser Resonance", patch.effectsGroupA.phaserResonance);
+	PrintProperty(out, "\t\tPhaser Mix", patch.effectsGroupA.phaserMix);
+	PrintProperty(out, "\t\tSpectrum Enabled", patch.effectsGroupA.spectrumEnabled);
+	PrintProperty(out, "\t\tSpectrum Band 1", patch.effectsGroupA.spectrumBand1);
+	PrintProperty(out, "\t\tSpectrum Band 2", patch.effectsGroupA.spectrumBand2);
+	PrintProperty(out, "\t\tSpectrum Band 3", patch.effectsGroupA.spectrumBand3);
+	PrintProperty(out, "\t\tSpectrum Band 4", patch.effectsGroupA.spectrumBand4);
+	PrintProperty(out, "\t\tSpectrum Band 5", patch.effectsGroupA.spectrumBand5);
+	PrintProperty(out, "\t\tSpectrum Band 6", patch.effectsGroupA.spectrumBand6);
+	PrintProperty(out, "\t\tSpectrum Bandwidth", patch.effectsGroupA.spectrumBandwidth);
+	PrintProperty(out, "\t\tEnhancer Enabled", patch.effectsGroupA.enhancerEnabled);
+	PrintProperty(out, "\t\tEnhancer Sensitivity", patch.effectsGroupA.enhancerSens);
+	PrintProperty(out, "\t\tEnhancer Mix", patch.effectsGroupA.enhancerMix);
+	PrintProperty(out, "\t\tDelay Enabled", patch.effectsGroupB.delayEnabled);
+	PrintProperty(out, "\t\tDelay Center Tempo Sync", patch.effectsGroupB.delayCenterTempoSync != 0);
 	if (patch.effectsGroupB.delayCenterTempoSync)
-		PrintProperty("\t\tDelay Center Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayCenterTapWithSync));
+		PrintProperty(out, "\t\tDelay Center Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayCenterTapWithSync));
 	else
-		PrintProperty("\t\tDelay Center Tap (ms)", DelayTime(patch.effectsGroupB.delayCenterTap));
-	PrintProperty("\t\tDelay Center Level", patch.effectsGroupB.delayCenterLevel);
-	PrintProperty("\t\tDelay Left Tempo Sync", patch.effectsGroupB.delayLeftTempoSync != 0);
+		PrintProperty(out, "\t\tDelay Center Tap (ms)", DelayTime(patch.effectsGroupB.delayCenterTap));
+	PrintProperty(out, "\t\tDelay Center Level", patch.effectsGroupB.delayCenterLevel);
+	PrintProperty(out, "\t\tDelay Left Tempo Sync", patch.effectsGroupB.delayLeftTempoSync != 0);
 	if (patch.effectsGroupB.delayLeftTempoSync)
-		PrintProperty("\t\tDelay Left Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayLeftTapWithSync));
+		PrintProperty(out, "\t\tDelay Left Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayLeftTapWithSync));
 	else
-		PrintProperty("\t\tDelay Left Tap (ms)", DelayTime(patch.effectsGroupB.delayLeftTap));
-	PrintProperty("\t\tDelay Left Level", patch.effectsGroupB.delayLeftLevel);
-	PrintProperty("\t\tDelay Right Tempo Sync", patch.effectsGroupB.delayRightTempoSync != 0);
+		PrintProperty(out, "\t\tDelay Left Tap (ms)", DelayTime(patch.effectsGroupB.delayLeftTap));
+	PrintProperty(out, "\t\tDelay Left Level", patch.effectsGroupB.delayLeftLevel);
+	PrintProperty(out, "\t\tDelay Right Tempo Sync", patch.effectsGroupB.delayRightTempoSync != 0);
 	if (patch.effectsGroupB.delayRightTempoSync)
-		PrintProperty("\t\tDelay Right Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayRightTapWithSync));
+		PrintProperty(out, "\t\tDelay Right Tap", SafeTable(TempoSyncVST, patch.effectsGroupB.delayRightTapWithSync));
 	else
-		PrintProperty("\t\tDelay Right Tap (ms)", DelayTime(patch.effectsGroupB.delayRightTap));
-	PrintProperty("\t\tDelay Right Level", patch.effectsGroupB.delayRightLevel);
-	PrintProperty("\t\tDelay Feedback", patch.effectsGroupB.delayFeedback);
-	PrintProperty("\t\tChorus Enabled", patch.effectsGroupB.chorusEnabled);
-	PrintProperty("\t\tChorus Rate (Hz)", 0.1 + patch.effectsGroupB.chorusRate * 0.1);
-	PrintProperty("\t\tChorus Depth", patch.effectsGroupB.chorusDepth);
-	PrintProperty("\t\tChorus Delay Time (ms)", ChorusTime(patch.effectsGroupB.chorusDelayTime));
-	PrintProperty("\t\tChorus Feedback", -98 + patch.effectsGroupB.chorusFeedback * 2);
-	PrintProperty("\t\tChorus Level", patch.effectsGroupB.chorusLevel);
-	PrintProperty("\t\tReverb Enabled", patch.effectsGroupB.reverbEnabled);
-	PrintProperty("\t\tReverb Type", SafeTable(ReverbType, patch.effectsGroupB.reverbType));
-	PrintProperty("\t\tReverb Pre-Delay", patch.effectsGroupB.reverbPreDelay);
-	PrintProperty("\t\tReverb Early Reflections Level", patch.effectsGroupB.reverbEarlyRefLevel);
-	PrintProperty("\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effectsGroupB.reverbHFDamp));
-	PrintProperty("\t\tReverb Time (ms)", ReverbTime(patch.effectsGroupB.reverbTime, patch.effectsGroupB.reverbType));
-	PrintProperty("\t\tReverb Level", patch.effectsGroupB.reverbLevel);
-	std::cout << "\tTone A" << std::endl;
-	PrintTone(patch.tone[0], patch.common.keyRangeLowA, patch.common.keyRangeHighA);
-	std::cout << "\tTone B" << std::endl;
-	PrintTone(patch.tone[1], patch.common.keyRangeLowB, patch.common.keyRangeHighB);
-	std::cout << "\tTone C" << std::endl;
-	PrintTone(patch.tone[2], patch.common.keyRangeLowC, patch.common.keyRangeHighC);
-	std::cout << "\tTone D" << std::endl;
-	PrintTone(patch.tone[3], patch.common.keyRangeLowD, patch.common.keyRangeHighD);
+		PrintProperty(out, "\t\tDelay Right Tap (ms)", DelayTime(patch.effectsGroupB.delayRightTap));
+	PrintProperty(out, "\t\tDelay Right Level", patch.effectsGroupB.delayRightLevel);
+	PrintProperty(out, "\t\tDelay Feedback", patch.effectsGroupB.delayFeedback);
+	PrintProperty(out, "\t\tChorus Enabled", patch.effectsGroupB.chorusEnabled);
+	PrintProperty(out, "\t\tChorus Rate (Hz)", 0.1 + patch.effectsGroupB.chorusRate * 0.1);
+	PrintProperty(out, "\t\tChorus Depth", patch.effectsGroupB.chorusDepth);
+	PrintProperty(out, "\t\tChorus Delay Time (ms)", ChorusTime(patch.effectsGroupB.chorusDelayTime));
+	PrintProperty(out, "\t\tChorus Feedback", -98 + patch.effectsGroupB.chorusFeedback * 2);
+	PrintProperty(out, "\t\tChorus Level", patch.effectsGroupB.chorusLevel);
+	PrintProperty(out, "\t\tReverb Enabled", patch.effectsGroupB.reverbEnabled);
+	PrintProperty(out, "\t\tReverb Type", SafeTable(ReverbType, patch.effectsGroupB.reverbType));
+	PrintProperty(out, "\t\tReverb Pre-Delay", patch.effectsGroupB.reverbPreDelay);
+	PrintProperty(out, "\t\tReverb Early Reflections Level", patch.effectsGroupB.reverbEarlyRefLevel);
+	PrintProperty(out, "\t\tReverb HF Damp", SafeTable(ReverbHFDamp, patch.effectsGroupB.reverbHFDamp));
+	PrintProperty(out, "\t\tReverb Time (ms)", ReverbTime(patch.effectsGroupB.reverbTime, patch.effectsGroupB.reverbType));
+	PrintProperty(out, "\t\tReverb Level", patch.effectsGroupB.reverbLevel);
+	out << "\tTone A" << std::endl;
+	PrintTone(out, patch.tone[0], patch.common.keyRangeLowA, patch.common.keyRangeHighA);
+	out << "\tTone B" << std::endl;
+	PrintTone(out, patch.tone[1], patch.common.keyRangeLowB, patch.common.keyRangeHighB);
+	out << "\tTone C" << std::endl;
+	PrintTone(out, patch.tone[2], patch.common.keyRangeLowC, patch.common.keyRangeHighC);
+	out << "\tTone D" << std::endl;
+	PrintTone(out, patch.tone[3], patch.common.keyRangeLowD, patch.common.keyRangeHighD);
 }
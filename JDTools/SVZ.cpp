@@ -164,7 +164,7 @@ namespace
 	};
 }
 
-std::vector<PatchVST> ReadSVZ(std::istream &inFile)
+std::vector<PatchVST> ReadSVZ(std::istream &inFile, std::ostream &warnings)
 {
 	SVZHeader fileHeader;
 	if (!Read(inFile, fileHeader))
@@ -172,7 +172,7 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 
 	if (!fileHeader.IsValid())
 	{
-		std::cerr << "Not a valid SVZ file!" << std::endl;
+		warnings << "Not a valid SVZ file!" << std::endl;
 		return {};
 	}
 
@@ -190,13 +190,13 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 
 			if (!chunkHeader.IsValid(entry))
 			{
-				std::cerr << "Not a valid SVZ file!" << std::endl;
+				warnings << "Not a valid SVZ file!" << std::endl;
 				return {};
 			}
 
 			if (entry.size != 16 + (sizeof(uint32le) + 2048) * chunkHeader.numPatches)
 			{
-				std::cerr << "SVZ file has unexpected length!" << std::endl;
+				warnings << "SVZ file has unexpected length!" << std::endl;
 				return {};
 			}
 
@@ -211,10 +211,10 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 				inFile.read(reinterpret_cast<char *>(&patch.name), 2048);
 				const auto patchCRC32 = mz_crc32(0, reinterpret_cast<unsigned char *>(&patch.name), 2048);
 				if (patchCRC32 != patchesCRC32[i])
-					std::cerr << "Warning, CRC32 mismatch for patch " << (i + 1) << std::endl;
+					warnings << "Warning, CRC32 mismatch for patch " << (i + 1) << std::endl;
 				if (patch.empty[29] != 1)
 				{
-					std::cerr << "Patches appear to be for different synth model!" << std::endl;
+					warnings << "Patches appear to be for different synth model!" << std::endl;
 					return {};
 				}
 				patch.zenHeader = PatchVST::DEFAULT_ZEN_HEADER;
@@ -231,13 +231,13 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 
 			if (!chunkHeader.IsValid(entry))
 			{
-				std::cerr << "Not a valid SVZ file!" << std::endl;
+				warnings << "Not a valid SVZ file!" << std::endl;
 				return {};
 			}
 
 			if (entry.size - 0x20 != chunkHeader.compressedSize)
 			{
-				std::cerr << "Compressed data has unexpected length!" << std::endl;
+				warnings << "Compressed data has unexpected length!" << std::endl;
 				return {};
 			}
 
@@ -245,12 +245,12 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 			std::vector<unsigned char> compressed;
 			if (!ReadVector(inFile, compressed, compressedSize))
 			{
-				std::cerr << "Can't read compressed data!" << std::endl;
+				warnings << "Can't read compressed data!" << std::endl;
 				return {};
 			}
 			if (mz_crc32(0, compressed.data(), compressedSize) != chunkHeader.compressedCRC32)
 			{
-				std::cerr << "Compressed data CRC32 mismatch!" << std::endl;
+				warnings << "Compressed data CRC32 mismatch!" << std::endl;
 				return {};
 			}
 
@@ -258,14 +258,14 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 			std::vector<unsigned char> uncompressed(uncompressedSize);
 			if (mz_uncompress(uncompressed.data(), &uncompressedSize, compressed.data(), compressedSize) != Z_OK)
 			{
-				std::cerr << "Error during decompression!" << std::endl;
+				warnings << "Error during decompression!" << std::endl;
 				return {};
 			}
 
 			const SVDxHeader &svdHeader = *reinterpret_cast<const SVDxHeader *>(uncompressed.data());
 			if (!svdHeader.IsValid())
 			{
-				std::cerr << "Unexpected header after decompression!" << std::endl;
+				warnings << "Unexpected header after decompression!" << std::endl;
 				return {};
 			}
 
@@ -277,7 +277,7 @@ std::vector<PatchVST> ReadSVZ(std::istream &inFile)
 	return {};
 }
 
-std::vector<PatchVST> ReadSVD(std::istream &inFile)
+SVDPatchChunk FindSVDPatchChunk(std::istream &inFile, std::ostream &warnings)
 {
 	static_assert(sizeof(SVDHeader) == 16);
 	static_assert(sizeof(SVDHeaderEntry) == 16);
@@ -288,7 +288,7 @@ std::vector<PatchVST> ReadSVD(std::istream &inFile)
 
 	if (fileHeader.magic != SVDHeader{}.magic || fileHeader.headerSize < 30)
 	{
-		std::cerr << "Not a valid SVD file!" << std::endl;
+		warnings << "Not a valid SVD file!" << std::endl;
 		return {};
 	}
 
@@ -309,7 +309,7 @@ std::vector<PatchVST> ReadSVD(std::istream &inFile)
 
 	if (patchOffset == 0 || patchSize < 16)
 	{
-		std::cerr << "SVD file does not contain any patches!" << std::endl;
+		warnings << "SVD file does not contain any patches!" << std::endl;
 		return {};
 	}
 
@@ -320,18 +320,31 @@ std::vector<PatchVST> ReadSVD(std::istream &inFile)
 
 	if (patchHeader.patchSize != 2048)
 	{
-		std::cerr << "SVD file has unexpected patch size!" << std::endl;
+		warnings << "SVD file has unexpected patch size!" << std::endl;
 		return {};
 	}
 
 	if (patchHeader.unknown1 != SVDPatchHeader{}.unknown1 || patchHeader.unknown2 != SVDPatchHeader{}.unknown2)
 	{
-		std::cerr << "SVD file has unexpected patch header!" << std::endl;
+		warnings << "SVD file has unexpected patch header!" << std::endl;
 		return {};
 	}
 
-	std::vector<PatchVST> vstPatches(patchHeader.numPatches);
-	for (uint32_t i = 0; i < patchHeader.numPatches; i++)
+	SVDPatchChunk chunk;
+	chunk.offset = patchOffset + sizeof(SVDPatchHeader);
+	chunk.size = patchSize - sizeof(SVDPatchHeader);
+	chunk.numPatches = patchHeader.numPatches;
+	return chunk;
+}
+
+std::vector<PatchVST> ReadSVD(std::istream &inFile, std::ostream &warnings)
+{
+	const SVDPatchChunk chunk = FindSVDPatchChunk(inFile, warnings);
+	if (chunk.numPatches == 0)
+		return {};
+
+	std::vector<PatchVST> vstPatches(chunk.numPatches);
+	for (uint32_t i = 0; i < chunk.numPatches; i++)
 	{
 		PatchVST &patch = vstPatches[i];
 		inFile.read(reinterpret_cast<char *>(&patch.zenHeader), 2048);
@@ -341,6 +354,18 @@ std::vector<PatchVST> ReadSVD(std::istream &inFile)
 	return vstPatches;
 }
 
+SVDPatchRecord MakeSVDPatchRecord(const PatchVST &patch)
+{
+	SVDPatchRecord patchData{};
+	patchData[4] = 1;
+	patchData[5] = 1;
+	patchData[6] = 5;
+	patchData[8] = 15;
+	std::memcpy(patchData.data() + 16, &patch.name, 2016);
+	patchData[2044] = 8;
+	return patchData;
+}
+
 void WriteSVZforPlugin(std::ostream &outFile, const std::vector<PatchVST> &vstPatches)
 {
 	std::vector<unsigned char> uncompressed(sizeof(SVDxHeader) + vstPatches.size() * sizeof(PatchVST));
@@ -424,7 +449,7 @@ void WriteSVZforHardware(std::ostream &outFile, const std::vector<PatchVST> &vst
 	WriteVector(outFile, patches);
 }
 
-void WriteSVD(std::ostream &outFile, const std::vector<PatchVST> &vstPatches, const std::vector<char> &originalSVDfile)
+void WriteSVD(std::ostream &outFile, const std::vector<const SVDPatchRecord *> &patchRecords, const std::vector<char> &originalSVDfile)
 {
 	// The JD-08 appears to reject SVD files that miss the PRFa, SYSa and/or DIFa chunks.
 	// Even if they only consist of the 16-byte header similar to the SVDPatchHeader struct and zeroing out the size fields in that header,
@@ -452,50 +477,64 @@ void WriteSVD(std::ostream &outFile, const std::vector<PatchVST> &vstPatches, co
 		fileHeader.headerSize = fileHeader.headerSize + sizeof(SVDHeaderEntry);
 	}
 
-	Write(outFile, fileHeader);
-	WriteVector(outFile, entries);  // Needs to be updated later
-
-	uint32_t offset = static_cast<uint32_t>(outFile.tellp());
-	for (SVDHeaderEntry &entry : entries)
+	// The output is written strictly sequentially (so that it can go to a pipe), hence the final chunk layout is computed first.
+	// Other chunks are copied from the original file.
+	std::vector<const char *> chunkSources(entries.size(), nullptr);
+	uint32_t offset = static_cast<uint32_t>(sizeof(fileHeader) + entries.size() * sizeof(SVDHeaderEntry));
+	for (size_t i = 0; i < entries.size(); i++)
 	{
+		SVDHeaderEntry &entry = entries[i];
 		if (entry.type == SVDHeaderEntry::PATCH_ENTRY)
 		{
-			entry.size = static_cast<uint32_t>(sizeof(SVDPatchHeader) + 2048 * vstPatches.size());
+			entry.size = static_cast<uint32_t>(sizeof(SVDPatchHeader) + sizeof(SVDPatchRecord) * patchRecords.size());
+		}
+		else if (entry.offset < originalSVDfile.size() && entry.size <= originalSVDfile.size() - entry.offset)
+		{
+			chunkSources[i] = originalSVDfile.data() + entry.offset;
+		}
+		else
+		{
+			entry.size = 0;
+			std::cerr << "Dropping an SVD chunk, it appears to be truncated!" << std::endl;
+		}
+		entry.offset = offset;
+		offset += entry.size;
+	}
 
+	Write(outFile, fileHeader);
+	WriteVector(outFile, entries);
+
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (entries[i].type == SVDHeaderEntry::PATCH_ENTRY)
+		{
 			SVDPatchHeader patchHeader{};
-			patchHeader.numPatches = static_cast<uint32_t>(vstPatches.size());
+			patchHeader.numPatches = static_cast<uint32_t>(patchRecords.size());
 			Write(outFile, patchHeader);
 
-			std::array<char, 2048> patchData{};
-			patchData[4] = 1;
-			patchData[5] = 1;
-			patchData[6] = 5;
-			patchData[8] = 15;
-			patchData[2044] = 8;
-			for (const auto &patch : vstPatches)
+			for (const SVDPatchRecord *record : patchRecords)
 			{
-				std::memcpy(patchData.data() + 16, &patch.name, 2016);
-				Write(outFile, patchData);
+				Write(outFile, *record);
 			}
 		}
-		else
+		else if (chunkSources[i])
 		{
-			// Just copy the original block
-			if(entry.offset < originalSVDfile.size() && entry.size <= originalSVDfile.size() - entry.offset)
-			{
-				outFile.write(originalSVDfile.data() + entry.offset, entry.size);
-			}
-			else
-			{
-				entry.size = 0;
-				std::cerr << "Dropping an SVD chunk, it appears to be truncated!" << std::endl;
-			}
+			outFile.write(chunkSources[i], entries[i].size);
 		}
-		entry.offset = offset;
-		offset += entry.size;
 	}
-
-	outFile.seekp(sizeof(fileHeader));
-	WriteVector(outFile, entries);
 }
 
+bool WriteSVDInPlace(std::ostream &outFile, const SVDPatchChunk &chunk, const std::vector<PatchVST> &vstPatches, const uint32_t firstPatch)
+{
+	// All patch records are 2048 bytes, so the patch slots can be overwritten without touching any other part of the file.
+	const uint64_t endPatch = uint64_t(firstPatch) + vstPatches.size();
+	if (endPatch > chunk.numPatches || endPatch * 2048 > chunk.size)
+		return false;
+
+	outFile.seekp(chunk.offset + uint64_t(firstPatch) * 2048);
+	for (const auto &patch : vstPatches)
+	{
+		Write(outFile, MakeSVDPatchRecord(patch));
+	}
+	return outFile.good();
+}
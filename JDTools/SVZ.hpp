@@ -4,13 +4,31 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iosfwd>
 #include <vector>
 
 struct PatchVST;
 
-std::vector<PatchVST> ReadSVZ(std::istream &inFile);
-std::vector<PatchVST> ReadSVD(std::istream &inFile);
+// Location of the patch records inside a JD-08 backup file
+struct SVDPatchChunk
+{
+	uint32_t offset = 0;  // File offset of the first patch record
+	uint32_t size = 0;  // Size of all patch records in bytes
+	uint32_t numPatches = 0;
+};
+
+// A single patch as stored in an SVD file
+using SVDPatchRecord = std::array<char, 2048>;
+
+// Problems with the file are reported on the warnings stream
+std::vector<PatchVST> ReadSVZ(std::istream &inFile, std::ostream &warnings);
+SVDPatchChunk FindSVDPatchChunk(std::istream &inFile, std::ostream &warnings);
+std::vector<PatchVST> ReadSVD(std::istream &inFile, std::ostream &warnings);
 void WriteSVZforPlugin(std::ostream &outFile, const std::vector<PatchVST> &vstPatches);
 void WriteSVZforHardware(std::ostream &outFile, const std::vector<PatchVST> &vstPatches);
-void WriteSVD(std::ostream &outFile, const std::vector<PatchVST> &vstPatches, const std::vector<char> &originalSVDfile);
+SVDPatchRecord MakeSVDPatchRecord(const PatchVST &patch);
+void WriteSVD(std::ostream &outFile, const std::vector<const SVDPatchRecord *> &patchRecords, const std::vector<char> &originalSVDfile);
+// Overwrites existing patch slots of an SVD file starting at firstPatch. Returns false if the file does not contain enough patch slots.
+bool WriteSVDInPlace(std::ostream &outFile, const SVDPatchChunk &chunk, const std::vector<PatchVST> &vstPatches, const uint32_t firstPatch);
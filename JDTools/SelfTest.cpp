@@ -0,0 +1,463 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "SelfTest.hpp"
+#include "ConversionContext.hpp"
+#include "JDTools.hpp"
+#include "PatchDiff.hpp"
+#include "PatchLibrary.hpp"
+#include "SVZ.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	using RNG = std::mt19937;
+
+	// Patches are pushed through the VST chains in bank-sized batches to keep memory usage low
+	constexpr size_t BATCH_SIZE = 64;
+
+	uint8_t RandomValue(RNG &rng, const uint8_t minValue, const uint8_t maxValue)
+	{
+		return static_cast<uint8_t>(std::uniform_int_distribution<int>{minValue, maxValue}(rng));
+	}
+
+	uint8_t RandomValue(RNG &rng, const uint8_t maxValue)
+	{
+		return RandomValue(rng, 0, maxValue);
+	}
+
+	void GenerateLFO(RNG &rng, Tone800::LFO &lfo)
+	{
+		lfo.rate = RandomValue(rng, 100);
+		lfo.delay = RandomValue(rng, 101);
+		lfo.fade = RandomValue(rng, 100);
+		lfo.waveform = RandomValue(rng, 4);
+		lfo.offset = RandomValue(rng, 2);
+		lfo.keyTrigger = RandomValue(rng, 1);
+	}
+
+	void GenerateTone(RNG &rng, Tone800 &tone)
+	{
+		tone.common.velocityCurve = RandomValue(rng, 3);
+		tone.common.holdControl = RandomValue(rng, 1);
+
+		GenerateLFO(rng, tone.lfo1);
+		GenerateLFO(rng, tone.lfo2);
+
+		// Only internal waveforms can be represented in all formats
+		tone.wg.waveSource = 0;
+		tone.wg.waveformMSB = 0;
+		tone.wg.waveformLSB = RandomValue(rng, 107);
+		tone.wg.pitchCoarse = RandomValue(rng, 96);
+		tone.wg.pitchFine = RandomValue(rng, 100);
+		tone.wg.pitchRandom = RandomValue(rng, 100);
+		tone.wg.keyFollow = RandomValue(rng, 16);
+		tone.wg.benderSwitch = RandomValue(rng, 1);
+		tone.wg.aTouchBend = RandomValue(rng, 1);
+		tone.wg.lfo1Sens = RandomValue(rng, 100);
+		tone.wg.lfo2Sens = RandomValue(rng, 100);
+		tone.wg.leverSens = RandomValue(rng, 100);
+		tone.wg.aTouchModSens = RandomValue(rng, 100);
+
+		tone.pitchEnv.velo = RandomValue(rng, 100);
+		tone.pitchEnv.timeVelo = RandomValue(rng, 100);
+		tone.pitchEnv.timeKF = RandomValue(rng, 20);
+		tone.pitchEnv.level0 = RandomValue(rng, 100);
+		tone.pitchEnv.time1 = RandomValue(rng, 100);
+		tone.pitchEnv.level1 = RandomValue(rng, 100);
+		tone.pitchEnv.time2 = RandomValue(rng, 100);
+		tone.pitchEnv.time3 = RandomValue(rng, 100);
+		tone.pitchEnv.level2 = RandomValue(rng, 100);
+
+		tone.tvf.filterMode = RandomValue(rng, 2);
+		tone.tvf.cutoffFreq = RandomValue(rng, 100);
+		tone.tvf.resonance = RandomValue(rng, 100);
+		tone.tvf.keyFollow = RandomValue(rng, 30);
+		tone.tvf.aTouchSens = RandomValue(rng, 100);
+		tone.tvf.lfoSelect = RandomValue(rng, 1);
+		tone.tvf.lfoDepth = RandomValue(rng, 100);
+		tone.tvf.envDepth = RandomValue(rng, 100);
+
+		tone.tvfEnv.velo = RandomValue(rng, 100);
+		tone.tvfEnv.timeVelo = RandomValue(rng, 100);
+		tone.tvfEnv.timeKF = RandomValue(rng, 20);
+		tone.tvfEnv.time1 = RandomValue(rng, 100);
+		tone.tvfEnv.level1 = RandomValue(rng, 100);
+		tone.tvfEnv.time2 = RandomValue(rng, 100);
+		tone.tvfEnv.level2 = RandomValue(rng, 100);
+		tone.tvfEnv.time3 = RandomValue(rng, 100);
+		tone.tvfEnv.sustainLevel = RandomValue(rng, 100);
+		tone.tvfEnv.time4 = RandomValue(rng, 100);
+		tone.tvfEnv.level4 = RandomValue(rng, 100);
+
+		tone.tva.biasDirection = RandomValue(rng, 2);
+		tone.tva.biasPoint = RandomValue(rng, 127);
+		tone.tva.biasLevel = RandomValue(rng, 20);
+		tone.tva.level = RandomValue(rng, 100);
+		tone.tva.aTouchSens = RandomValue(rng, 100);
+		tone.tva.lfoSelect = RandomValue(rng, 1);
+		tone.tva.lfoDepth = RandomValue(rng, 100);
+
+		tone.tvaEnv.velo = RandomValue(rng, 100);
+		tone.tvaEnv.timeVelo = RandomValue(rng, 100);
+		tone.tvaEnv.timeKF = RandomValue(rng, 20);
+		tone.tvaEnv.time1 = RandomValue(rng, 100);
+		tone.tvaEnv.level1 = RandomValue(rng, 100);
+		tone.tvaEnv.time2 = RandomValue(rng, 100);
+		tone.tvaEnv.level2 = RandomValue(rng, 100);
+		tone.tvaEnv.time3 = RandomValue(rng, 100);
+		tone.tvaEnv.sustainLevel = RandomValue(rng, 100);
+		tone.tvaEnv.time4 = RandomValue(rng, 100);
+	}
+
+	void GeneratePatch(RNG &rng, Patch800 &patch)
+	{
+		for (char &c : patch.common.name)
+			c = static_cast<char>(RandomValue(rng, 0x20, 0x7E));
+		patch.common.patchLevel = RandomValue(rng, 100);
+		patch.common.keyRangeLowA = RandomValue(rng, 127);
+		patch.common.keyRangeHighA = RandomValue(rng, patch.common.keyRangeLowA, 127);
+		patch.common.keyRangeLowB = RandomValue(rng, 127);
+		patch.common.keyRangeHighB = RandomValue(rng, patch.common.keyRangeLowB, 127);
+		patch.common.keyRangeLowC = RandomValue(rng, 127);
+		patch.common.keyRangeHighC = RandomValue(rng, patch.common.keyRangeLowC, 127);
+		patch.common.keyRangeLowD = RandomValue(rng, 127);
+		patch.common.keyRangeHighD = RandomValue(rng, patch.common.keyRangeLowD, 127);
+		patch.common.benderRangeDown = RandomValue(rng, 48);
+		patch.common.benderRangeUp = RandomValue(rng, 12);
+		patch.common.aTouchBend = RandomValue(rng, 26);
+		patch.common.soloSW = RandomValue(rng, 1);
+		patch.common.soloLegato = RandomValue(rng, 1);
+		patch.common.portamentoSW = RandomValue(rng, 1);
+		patch.common.portamentoMode = RandomValue(rng, 1);
+		patch.common.portamentoTime = RandomValue(rng, 100);
+		patch.common.layerTone = RandomValue(rng, 15);
+		patch.common.activeTone = RandomValue(rng, 15);
+
+		patch.eq.lowFreq = RandomValue(rng, 1);
+		patch.eq.lowGain = RandomValue(rng, 30);
+		patch.eq.midFreq = RandomValue(rng, 16);
+		patch.eq.midQ = RandomValue(rng, 4);
+		patch.eq.midGain = RandomValue(rng, 30);
+		patch.eq.highFreq = RandomValue(rng, 1);
+		patch.eq.highGain = RandomValue(rng, 30);
+
+		patch.midiTx.keyMode = 0;
+		patch.midiTx.splitPoint = 36;
+		patch.midiTx.lowerChannel = 1;
+		patch.midiTx.upperChannel = 0;
+		patch.midiTx.lowerProgramChange = 0;
+		patch.midiTx.upperProgramChange = 0;
+		patch.midiTx.holdMode = 2;
+		patch.midiTx.dummy = 0;
+
+		patch.effect.groupAsequence = RandomValue(rng, 23);
+		patch.effect.groupBsequence = RandomValue(rng, 5);
+		patch.effect.groupAblockSwitch1 = RandomValue(rng, 1);
+		patch.effect.groupAblockSwitch2 = RandomValue(rng, 1);
+		patch.effect.groupAblockSwitch3 = RandomValue(rng, 1);
+		patch.effect.groupAblockSwitch4 = RandomValue(rng, 1);
+		patch.effect.groupBblockSwitch1 = RandomValue(rng, 1);
+		patch.effect.groupBblockSwitch2 = RandomValue(rng, 1);
+		patch.effect.groupBblockSwitch3 = RandomValue(rng, 1);
+		patch.effect.effectsBalanceGroupB = RandomValue(rng, 100);
+		patch.effect.distortionType = RandomValue(rng, 6);
+		patch.effect.distortionDrive = RandomValue(rng, 100);
+		patch.effect.distortionLevel = RandomValue(rng, 100);
+		patch.effect.phaserManual = RandomValue(rng, 99);
+		patch.effect.phaserRate = RandomValue(rng, 99);
+		patch.effect.phaserDepth = RandomValue(rng, 100);
+		patch.effect.phaserResonance = RandomValue(rng, 100);
+		patch.effect.phaserMix = RandomValue(rng, 100);
+		patch.effect.spectrumBand1 = RandomValue(rng, 30);
+		patch.effect.spectrumBand2 = RandomValue(rng, 30);
+		patch.effect.spectrumBand3 = RandomValue(rng, 30);
+		patch.effect.spectrumBand4 = RandomValue(rng, 30);
+		patch.effect.spectrumBand5 = RandomValue(rng, 30);
+		patch.effect.spectrumBand6 = RandomValue(rng, 30);
+		patch.effect.spectrumBandwidth = RandomValue(rng, 4);
+		patch.effect.enhancerSens = RandomValue(rng, 100);
+		patch.effect.enhancerMix = RandomValue(rng, 100);
+		patch.effect.delayCenterTap = RandomValue(rng, 125);
+		patch.effect.delayCenterLevel = RandomValue(rng, 100);
+		patch.effect.delayLeftTap = RandomValue(rng, 125);
+		patch.effect.delayLeftLevel = RandomValue(rng, 100);
+		patch.effect.delayRightTap = RandomValue(rng, 125);
+		patch.effect.delayRightLevel = RandomValue(rng, 100);
+		patch.effect.delayFeedback = RandomValue(rng, 98);
+		patch.effect.chorusRate = RandomValue(rng, 99);
+		patch.effect.chorusDepth = RandomValue(rng, 100);
+		patch.effect.chorusDelayTime = RandomValue(rng, 99);
+		patch.effect.chorusFeedback = RandomValue(rng, 98);
+		patch.effect.chorusLevel = RandomValue(rng, 100);
+		patch.effect.reverbType = RandomValue(rng, 9);
+		patch.effect.reverbPreDelay = RandomValue(rng, 120);
+		patch.effect.reverbEarlyRefLevel = RandomValue(rng, 100);
+		patch.effect.reverbHFDamp = RandomValue(rng, 16);
+		patch.effect.reverbTime = RandomValue(rng, 100);
+		patch.effect.reverbLevel = RandomValue(rng, 100);
+		patch.effect.dummy = 0;
+
+		GenerateTone(rng, patch.toneA);
+		GenerateTone(rng, patch.toneB);
+		GenerateTone(rng, patch.toneC);
+		GenerateTone(rng, patch.toneD);
+	}
+
+	// Masks of all bytes that are expected to survive a round trip unmodified.
+	// Fields that are left out are either reset to defaults by the conversion or are known to be lossy.
+	Patch800 StableFieldsMask990()
+	{
+		Patch800 mask;
+		std::memset(&mask, 0xFF, sizeof(mask));
+		mask.midiTx = {};
+		mask.common.aTouchBend = 0;  // Only preserved if a tone uses aftertouch bend
+		for (Tone800 *tone : { &mask.toneA, &mask.toneB, &mask.toneC, &mask.toneD })
+		{
+			tone->wg.aTouchBend = 0;  // Not preserved if aftertouch bend depth is 0
+			tone->tvf.lfoSelect = 0;  // Not preserved if LFO depth is 0
+			tone->tva.lfoSelect = 0;  // Not preserved if LFO depth is 0
+		}
+		return mask;
+	}
+
+	Patch800 StableFieldsMaskVST()
+	{
+		Patch800 mask;
+		std::memset(&mask, 0xFF, sizeof(mask));
+		mask.midiTx = {};
+		for (Tone800 *tone : { &mask.toneA, &mask.toneB, &mask.toneC, &mask.toneD })
+		{
+			tone->wg.pitchCoarse = 0;  // Clamped for transposed waveforms
+			tone->wg.pitchFine = 0;    // Wraps around for detuned waveforms
+			tone->wg.pitchRandom = 0;  // Values 1-19 have no effect in ZenCore
+			tone->pitchEnv.level0 = 0;  // ZenCore has a smaller pitch envelope range
+			tone->pitchEnv.level1 = 0;
+			tone->pitchEnv.level2 = 0;
+		}
+		return mask;
+	}
+
+	bool CompareMasked(const Patch800 &expected, const Patch800 &actual, const Patch800 &mask, size_t &firstMismatch)
+	{
+		const auto *e = reinterpret_cast<const uint8_t *>(&expected);
+		const auto *a = reinterpret_cast<const uint8_t *>(&actual);
+		const auto *m = reinterpret_cast<const uint8_t *>(&mask);
+		for (size_t i = 0; i < sizeof(Patch800); i++)
+		{
+			if ((e[i] ^ a[i]) & m[i])
+			{
+				firstMismatch = i;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Chain800To990To800(const std::vector<Patch800> &source, std::vector<Patch800> &result, ConversionContext &context)
+	{
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			Patch990 p990{};
+			ConvertPatch800To990(source[i], p990, context);
+			ConvertPatch990To800(p990, result[i], context);
+		}
+	}
+
+	void Chain800ToVSTTo800(const std::vector<Patch800> &source, std::vector<Patch800> &result, ConversionContext &context)
+	{
+		std::vector<PatchVST> batch(BATCH_SIZE);
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			PatchVST &pVST = batch[i % BATCH_SIZE];
+			ConvertPatch800ToVST(source[i], pVST, context);
+			ConvertPatchVSTTo800(pVST, result[i], context);
+		}
+	}
+
+	void Chain800ToSVZTo800(const std::vector<Patch800> &source, std::vector<Patch800> &result, ConversionContext &context)
+	{
+		std::vector<PatchVST> batch;
+		for (size_t first = 0; first < source.size(); first += BATCH_SIZE)
+		{
+			const size_t count = std::min(BATCH_SIZE, source.size() - first);
+			batch.resize(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				ConvertPatch800ToVST(source[first + i], batch[i], context);
+			}
+
+			std::stringstream svz;
+			WriteSVZforHardware(svz, batch);
+			svz.seekg(0);
+			const std::vector<PatchVST> readBack = ReadSVZ(svz, std::cerr);
+			if (readBack.size() != count)
+			{
+				std::cerr << "SVZ container did not return the expected number of patches!" << std::endl;
+				return;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				ConvertPatchVSTTo800(readBack[i], result[first + i], context);
+			}
+		}
+	}
+
+	using ChainFunc = void (*)(const std::vector<Patch800> &source, std::vector<Patch800> &result, ConversionContext &context);
+
+	struct ChainResult
+	{
+		std::vector<Patch800> output;
+		uint32_t numMismatches = 0;
+		uint32_t numUnstable = 0;
+	};
+
+	ChainResult RunChain(const std::string_view name, const ChainFunc chain, const std::vector<Patch800> &source, const Patch800 &mask)
+	{
+		ChainResult result;
+		result.output.resize(source.size());
+		std::vector<Patch800> secondPass(source.size());
+
+		// Discard conversion warnings, the generated patches are meant to hit lossy cases
+		ConversionContext context;
+		const auto startTime = std::chrono::steady_clock::now();
+		chain(source, result.output, context);
+		const auto endTime = std::chrono::steady_clock::now();
+		chain(result.output, secondPass, context);
+
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			size_t offset = 0;
+			if (!CompareMasked(source[i], result.output[i], mask, offset))
+			{
+				if (!result.numMismatches)
+					std::cout << "  First mismatch: patch " << i << ", byte offset " << offset << std::endl;
+				result.numMismatches++;
+			}
+			// A converted patch must convert to itself again
+			if (std::memcmp(&result.output[i], &secondPass[i], sizeof(Patch800)))
+				result.numUnstable++;
+		}
+
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+		std::cout << name << ": " << result.numMismatches << " mismatches, " << result.numUnstable << " unstable, "
+			<< static_cast<uint64_t>(source.size() / std::max(seconds, 1e-9)) << " patches/s" << std::endl;
+		return result;
+	}
+
+	template<typename TPatch>
+	LibraryPatch MakeLibraryPatch(const PatchFormat format, const uint32_t slot, const TPatch &patch)
+	{
+		const auto *data = reinterpret_cast<const uint8_t *>(&patch);
+		return LibraryPatch{format, slot, std::vector<uint8_t>(data, data + sizeof(patch))};
+	}
+
+	// The patch in all formats
+	std::array<LibraryPatch, 3> MakeLibraryPatches(const Patch800 &p800, const uint32_t slot, ConversionContext &context)
+	{
+		Patch990 p990{};
+		ConvertPatch800To990(p800, p990, context);
+		std::vector<PatchVST> pVST(1);
+		ConvertPatch800ToVST(p800, pVST.front(), context);
+		return { MakeLibraryPatch(PatchFormat::JD800, slot, p800), MakeLibraryPatch(PatchFormat::JD990, slot, p990), MakeLibraryPatch(PatchFormat::VST, slot, pVST.front()) };
+	}
+
+	// The diff verb must not report a patch and its conversion to another format as different,
+	// and must come to the same result no matter in which order two patches of different formats are specified.
+	uint32_t CheckDiffSymmetry(const std::vector<Patch800> &source)
+	{
+		if (source.empty())
+			return 0;
+
+		ConversionContext context;
+		uint32_t numMismatches = 0;
+		const auto check = [&](const LibraryPatch &patchA, const LibraryPatch &patchB)
+		{
+			const bool differs = PatchesDiffer(patchA, patchB, context);
+			if (differs == PatchesDiffer(patchB, patchA, context) && (patchA.slot != patchB.slot || !differs))
+				return;
+			if (!numMismatches)
+				std::cout << "  First mismatch: patch " << patchA.slot << " (" << GetFormatName(patchA.format) << ") vs. patch " << patchB.slot << " (" << GetFormatName(patchB.format) << ")" << std::endl;
+			numMismatches++;
+		};
+
+		// Every patch is compared to its conversions and to the conversions of the next patch
+		std::array<LibraryPatch, 3> current = MakeLibraryPatches(source.front(), 0, context);
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			const uint32_t nextSlot = static_cast<uint32_t>((i + 1) % source.size());
+			std::array<LibraryPatch, 3> next = MakeLibraryPatches(source[nextSlot], nextSlot, context);
+			for (size_t a = 0; a < current.size(); a++)
+			{
+				for (size_t b = 0; b < next.size(); b++)
+				{
+					if (a < b)
+						check(current[a], current[b]);
+					if (a != b)
+						check(current[a], next[b]);
+				}
+			}
+			current = std::move(next);
+		}
+
+		std::cout << "diff symmetry: " << numMismatches << " mismatches" << std::endl;
+		return numMismatches;
+	}
+}
+
+int RunSelfTest(const uint32_t numPatches, const uint32_t seed)
+{
+	static_assert(sizeof(Patch800) == 384);
+
+	std::cout << "Generating " << numPatches << " JD-800 patches (seed " << seed << ")..." << std::endl;
+	RNG rng{seed};
+	std::vector<Patch800> source(numPatches);
+	for (Patch800 &patch : source)
+	{
+		GeneratePatch(rng, patch);
+	}
+
+	const Patch800 mask990 = StableFieldsMask990(), maskVST = StableFieldsMaskVST();
+	const ChainResult result990 = RunChain("800 -> 990 -> 800", Chain800To990To800, source, mask990);
+	const ChainResult resultVST = RunChain("800 -> VST -> 800", Chain800ToVSTTo800, source, maskVST);
+	const ChainResult resultSVZ = RunChain("800 -> VST -> SVZ -> VST -> 800", Chain800ToSVZTo800, source, maskVST);
+
+	// The SVZ container must not alter the patch data in any way
+	uint32_t containerMismatches = 0;
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		if (std::memcmp(&resultVST.output[i], &resultSVZ.output[i], sizeof(Patch800)))
+			containerMismatches++;
+	}
+	if (containerMismatches)
+		std::cout << containerMismatches << " patches differ after passing through SVZ container!" << std::endl;
+
+	const uint32_t diffMismatches = CheckDiffSymmetry(source);
+
+	const bool failed = result990.numMismatches || result990.numUnstable
+		|| resultVST.numMismatches || resultVST.numUnstable
+		|| resultSVZ.numMismatches || resultSVZ.numUnstable
+		|| containerMismatches || diffMismatches;
+	if (failed)
+	{
+		std::cout << "Self-test FAILED!" << std::endl;
+		return 3;
+	}
+	std::cout << "Self-test passed." << std::endl;
+	return 0;
+}
@@ -0,0 +1,12 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstdint>
+
+// Pushes a generated corpus of JD-800 patches through all converter chains, checks that the
+// stable parameters survive the round trip and reports the throughput of each chain.
+// Returns the process exit code.
+int RunSelfTest(uint32_t numPatches, uint32_t seed);
@@ -0,0 +1,126 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "StandardStreams.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+	class BufferedInput : public std::streambuf
+	{
+	public:
+		explicit BufferedInput(std::streambuf *source)
+			: m_source{source}
+		{
+		}
+
+	protected:
+		int_type underflow() override
+		{
+			const size_t position = gptr() - eback();
+			if (position >= m_data.size() && !ReadMore())
+				return traits_type::eof();
+			setg(m_data.data(), m_data.data() + position, m_data.data() + m_data.size());
+			return traits_type::to_int_type(*gptr());
+		}
+
+		pos_type seekoff(off_type offset, std::ios::seekdir dir, std::ios::openmode which) override
+		{
+			if (dir == std::ios::cur)
+				offset += gptr() - eback();
+			else if (dir == std::ios::end)
+			{
+				while (ReadMore())
+				{
+				}
+				offset += m_data.size();
+			}
+			return seekpos(offset, which);
+		}
+
+		pos_type seekpos(pos_type position, std::ios::openmode which) override
+		{
+			if (!(which & std::ios::in) || position < 0)
+				return pos_type(off_type(-1));
+			while (static_cast<size_t>(position) > m_data.size() && ReadMore())
+			{
+			}
+			if (static_cast<size_t>(position) > m_data.size())
+				return pos_type(off_type(-1));
+			setg(m_data.data(), m_data.data() + static_cast<size_t>(position), m_data.data() + m_data.size());
+			return position;
+		}
+
+	private:
+		// Invalidates the get area, callers have to set it up again
+		bool ReadMore()
+		{
+			static constexpr size_t CHUNK_SIZE = 0x10000;
+			const size_t oldSize = m_data.size();
+			m_data.resize(oldSize + CHUNK_SIZE);
+			const auto numRead = m_source->sgetn(m_data.data() + oldSize, CHUNK_SIZE);
+			m_data.resize(oldSize + static_cast<size_t>(std::max(numRead, std::streamsize(0))));
+			setg(m_data.data(), m_data.data(), m_data.data() + m_data.size());
+			return numRead > 0;
+		}
+
+		std::streambuf *m_source;
+		std::vector<char> m_data;
+	};
+
+	class StandardInputStream : public std::istream
+	{
+	public:
+		StandardInputStream()
+			: std::istream{nullptr}
+			, m_buffer{std::cin.rdbuf()}
+		{
+			rdbuf(&m_buffer);
+		}
+
+	private:
+		BufferedInput m_buffer;
+	};
+}
+
+std::unique_ptr<std::istream> OpenStandardInput()
+{
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	return std::make_unique<StandardInputStream>();
+}
+
+std::istream &GetStandardInputStream()
+{
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	return std::cin;
+}
+
+std::ostream &OpenStandardOutput()
+{
+	static std::ostream output = []()
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		std::streambuf *stdoutBuffer = std::cout.rdbuf();
+		std::cout.flush();
+		std::cout.rdbuf(std::cerr.rdbuf());
+		return std::ostream{stdoutBuffer};
+	}();
+	return output;
+}
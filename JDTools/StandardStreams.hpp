@@ -0,0 +1,29 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+// "-" can be specified instead of a filename to read from standard input or write to standard output
+constexpr bool IsStandardStream(const std::string_view filename) noexcept
+{
+	return filename == "-";
+}
+
+// Returns a stream reading from standard input.
+// Standard input may be a pipe, so everything that has been read is kept in memory, which allows the file readers to seek back to data they have already seen.
+// Seeking forward reads and buffers the data in between.
+std::unique_ptr<std::istream> OpenStandardInput();
+
+// Returns standard input without any additional buffering, so that data can be processed as soon as it arrives.
+// Unlike the stream returned by OpenStandardInput, it is not seekable.
+std::istream &GetStandardInputStream();
+
+// Returns a stream writing binary data to standard output.
+// From the first call on, all messages printed to std::cout go to standard error instead, so that they do not end up in the output data.
+// Hence this should be called before anything is printed if the output is going to be written to standard output.
+std::ostream &OpenStandardOutput();
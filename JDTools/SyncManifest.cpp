@@ -0,0 +1,319 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "SyncManifest.hpp"
+#include "BatchConverter.hpp"
+#include "Codecs.hpp"
+#include "MappedFile.hpp"
+#include "resource.h"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <unordered_map>
+
+namespace
+{
+	constexpr uint32_t TOOL_VERSION = (VER_MAJORMAJOR << 24) | (VER_MAJOR << 16) | (VER_MINOR << 8) | VER_MINORMINOR;
+
+	struct SyncedFile
+	{
+		uint64_t modificationTime = 0;
+		uint64_t fileSize = 0;
+		const SyncManifestFile *previous = nullptr;  // Entry in the previous manifest
+		bool upToDate = false;
+	};
+
+	std::string ToGenericString(const std::filesystem::path &path)
+	{
+		const std::u8string str = path.generic_u8string();
+		return std::string{str.begin(), str.end()};
+	}
+
+	std::filesystem::path ToPath(const std::string_view str)
+	{
+		return std::filesystem::path{std::u8string{str.begin(), str.end()}};
+	}
+
+	uint32_t AddString(SyncManifest &manifest, const std::string_view str)
+	{
+		const uint32_t offset = static_cast<uint32_t>(manifest.strings.size());
+		manifest.strings.insert(manifest.strings.end(), str.begin(), str.end());
+		return offset;
+	}
+
+	// A file whose size, tool version, targets and output files match the previous run is only converted again if its contents changed.
+	// Its modification time alone is not trusted, since e.g. copying a library or checking it out from version control touches all files.
+	bool IsUpToDate(const SyncedFile &file, const BatchFile &batchFile, const SyncManifest &manifest, std::span<const FileCodec *const> codecs, const std::string_view targets, const std::filesystem::path &outputDirectory)
+	{
+		const SyncManifestFile *previous = file.previous;
+		if (!previous || previous->toolVersion != TOOL_VERSION || manifest.GetTargets(*previous) != targets || previous->fileSize != file.fileSize)
+			return false;
+
+		// Output filenames depend on the other files in the directory, e.g. Bank.syx is written to Bank.syx.bin instead of Bank.bin once Bank.mid is added
+		const auto outputs = manifest.GetOutputs(*previous);
+		const size_t numBanks = outputs.size() / codecs.size();
+		if (numBanks * codecs.size() != outputs.size())
+			return false;
+		std::set<std::filesystem::path> expectedOutputs;
+		for (size_t bank = 0; bank < numBanks; bank++)
+		{
+			for (const FileCodec *codec : codecs)
+				expectedOutputs.insert(GetBatchOutputPath(batchFile, *codec, bank, numBanks));
+		}
+
+		std::error_code ec;
+		for (const SyncManifestOutput &output : outputs)
+		{
+			const std::filesystem::path path = (outputDirectory / ToPath(manifest.GetPath(output))).lexically_normal();
+			if (!expectedOutputs.count(path) || !std::filesystem::is_regular_file(path, ec))
+				return false;
+		}
+		if (previous->modificationTime == file.modificationTime)
+			return true;
+
+		const MappedFile inFile{batchFile.path.string()};
+		return inFile.IsValid() && HashFNV1a(inFile.GetData(), inFile.GetSize()) == previous->contentHash;
+	}
+
+	// Removes a file that no longer belongs to any input file, as well as the directories that are empty afterwards
+	bool DeleteOutput(const std::filesystem::path &outputDirectory, const std::filesystem::path &relativePath)
+	{
+		std::error_code ec;
+		if (!std::filesystem::remove(outputDirectory / relativePath, ec) || ec)
+			return false;
+		for (std::filesystem::path directory = relativePath.parent_path(); !directory.empty(); directory = directory.parent_path())
+		{
+			if (!std::filesystem::is_empty(outputDirectory / directory, ec) || ec || !std::filesystem::remove(outputDirectory / directory, ec))
+				break;
+		}
+		return true;
+	}
+}
+
+bool ReadSyncManifest(std::istream &inFile, SyncManifest &manifest)
+{
+	SyncManifestHeader header;
+	if (!Read(inFile, header) || !header.IsValid())
+		return false;
+
+	if (!ReadVector(inFile, manifest.files, header.numFiles)
+		|| !ReadVector(inFile, manifest.outputs, header.numOutputs)
+		|| !ReadVector(inFile, manifest.strings, header.stringTableSize))
+		return false;
+
+	const auto isValidString = [&manifest](const uint32_t offset, const uint32_t length)
+	{
+		return uint64_t(offset) + length <= manifest.strings.size();
+	};
+	for (const auto &file : manifest.files)
+	{
+		if (!isValidString(file.pathOffset, file.pathLength)
+			|| !isValidString(file.targetsOffset, file.targetsLength)
+			|| uint64_t(file.firstOutput) + file.numOutputs > manifest.outputs.size())
+			return false;
+	}
+	for (const auto &output : manifest.outputs)
+	{
+		if (!isValidString(output.pathOffset, output.pathLength))
+			return false;
+	}
+	return true;
+}
+
+void WriteSyncManifest(std::ostream &outFile, const SyncManifest &manifest)
+{
+	SyncManifestHeader header;
+	header.numFiles = static_cast<uint32_t>(manifest.files.size());
+	header.numOutputs = static_cast<uint32_t>(manifest.outputs.size());
+	header.stringTableSize = static_cast<uint32_t>(manifest.strings.size());
+	Write(outFile, header);
+	WriteVector(outFile, manifest.files);
+	WriteVector(outFile, manifest.outputs);
+	WriteVector(outFile, manifest.strings);
+}
+
+bool SyncDirectory(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats, SyncResult &result)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(sourceDirectory, ec))
+	{
+		std::cout << "Could not read directory " << sourceDirectory.string() << "!" << std::endl;
+		return false;
+	}
+	std::filesystem::create_directories(outputDirectory, ec);
+	if (!std::filesystem::is_directory(outputDirectory, ec))
+	{
+		std::cout << "Could not create output directory " << outputDirectory.string() << "!" << std::endl;
+		return false;
+	}
+	// Otherwise, the output files would be converted again on the next run
+	if (std::filesystem::equivalent(sourceDirectory, outputDirectory, ec))
+	{
+		std::cout << "The output directory must be different from the source directory!" << std::endl;
+		return false;
+	}
+
+	const std::string manifestFilename = (outputDirectory / "JDTools.sync").string();
+	SyncManifest previousManifest;
+	std::unordered_map<std::string_view, const SyncManifestFile *> previousFiles;
+	if (std::ifstream inFile{manifestFilename, std::ios::binary}; inFile && ReadSyncManifest(inFile, previousManifest))
+	{
+		for (const auto &file : previousManifest.files)
+		{
+			previousFiles[previousManifest.GetPath(file)] = &file;
+		}
+	}
+
+	std::string targets;
+	for (const FileCodec *codec : codecs)
+	{
+		if (!targets.empty())
+			targets += ',';
+		targets += codec->id;
+	}
+
+	std::vector<BatchFile> files = FindBatchFiles({sourceDirectory.string()}, outputDirectory);
+	std::vector<SyncedFile> syncedFiles(files.size());
+	std::vector<BatchFile> filesToConvert;
+	std::vector<size_t> convertedFileIndices;  // Index into files for each file in filesToConvert
+	std::set<std::filesystem::path> claimedOutputs;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		SyncedFile &file = syncedFiles[i];
+		file.fileSize = std::filesystem::file_size(files[i].path, ec);
+		file.modificationTime = static_cast<uint64_t>(std::filesystem::last_write_time(files[i].path, ec).time_since_epoch().count());
+		if (const auto previous = previousFiles.find(files[i].relativePath); previous != previousFiles.end())
+			file.previous = previous->second;
+
+		file.upToDate = IsUpToDate(file, files[i], previousManifest, codecs, targets, outputDirectory);
+		if (!file.upToDate)
+		{
+			filesToConvert.push_back(files[i]);
+			convertedFileIndices.push_back(i);
+		}
+		else
+		{
+			for (const SyncManifestOutput &output : previousManifest.GetOutputs(*file.previous))
+				claimedOutputs.insert((outputDirectory / ToPath(previousManifest.GetPath(output))).lexically_normal());
+		}
+	}
+
+	// Files that are up to date keep their outputs, even if a new file would be written to the same place
+	result.numFailedFiles = ConvertBatch(filesToConvert, codecs, printStats, std::move(claimedOutputs));
+	for (size_t i = 0; i < filesToConvert.size(); i++)
+	{
+		if (filesToConvert[i].converted)
+			result.convertedFiles.push_back(filesToConvert[i].relativePath);
+		files[convertedFileIndices[i]] = std::move(filesToConvert[i]);
+	}
+
+	SyncManifest manifest;
+	std::set<std::string, std::less<>> outputs;
+	const uint32_t targetsOffset = AddString(manifest, targets);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		const BatchFile &file = files[i];
+		const SyncedFile &syncedFile = syncedFiles[i];
+
+		SyncManifestFile entry{};
+		if (syncedFile.upToDate)
+		{
+			entry = *syncedFile.previous;
+		}
+		else
+		{
+			entry.fileSize = syncedFile.fileSize;
+			entry.contentHash = file.contentHash;
+			// Files that could not be read or written keep all their previous outputs, and are tried again next time.
+			// Files without any patches are only tried again once they have been modified.
+			entry.toolVersion = (file.converted || file.noPatches) ? TOOL_VERSION : 0;
+		}
+		entry.modificationTime = syncedFile.modificationTime;
+		entry.pathOffset = AddString(manifest, file.relativePath);
+		entry.pathLength = static_cast<uint32_t>(file.relativePath.size());
+		entry.targetsOffset = targetsOffset;
+		entry.targetsLength = static_cast<uint32_t>(targets.size());
+		entry.firstOutput = static_cast<uint32_t>(manifest.outputs.size());
+
+		std::vector<std::string> fileOutputs;
+		if (syncedFile.previous && !file.converted && !file.noPatches)
+		{
+			for (const SyncManifestOutput &output : previousManifest.GetOutputs(*syncedFile.previous))
+			{
+				fileOutputs.emplace_back(previousManifest.GetPath(output));
+			}
+		}
+		for (const std::filesystem::path &output : file.outputs)
+		{
+			fileOutputs.push_back(ToGenericString(output.lexically_relative(outputDirectory)));
+		}
+		for (const std::string &output : fileOutputs)
+		{
+			if (!outputs.insert(output).second)
+				continue;
+			SyncManifestOutput &outputEntry = manifest.outputs.emplace_back();
+			outputEntry.pathOffset = AddString(manifest, output);
+			outputEntry.pathLength = static_cast<uint32_t>(output.size());
+		}
+		entry.numOutputs = static_cast<uint32_t>(manifest.outputs.size() - entry.firstOutput);
+
+		if (entry.toolVersion || entry.numOutputs)
+			manifest.files.push_back(entry);
+	}
+
+	// Outputs of removed input files, and outputs that a file no longer produces (e.g. because it contains fewer banks than before) are deleted
+	size_t numDeletedFiles = 0;
+	for (const SyncManifestOutput &output : previousManifest.outputs)
+	{
+		const std::string_view path = previousManifest.GetPath(output);
+		if (outputs.find(path) != outputs.end())
+			continue;
+		if (DeleteOutput(outputDirectory, ToPath(path)))
+		{
+			std::cout << "Deleted " << path << std::endl;
+			numDeletedFiles++;
+		}
+	}
+
+	// Write to a temporary file first so that an interrupted run does not destroy the previous manifest
+	const std::string tempFilename = manifestFilename + ".tmp";
+	{
+		std::ofstream outFile{tempFilename, std::ios::trunc | std::ios::binary};
+		WriteSyncManifest(outFile, manifest);
+		if (!outFile)
+		{
+			std::cout << "Could not write " << tempFilename << "!" << std::endl;
+			return false;
+		}
+	}
+	std::filesystem::rename(tempFilename, manifestFilename, ec);
+	if (ec)
+	{
+		std::cout << "Could not write " << manifestFilename << ": " << ec.message() << std::endl;
+		return false;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Synchronized " << files.size() << " files (" << result.convertedFiles.size() << " converted, " << (files.size() - filesToConvert.size()) << " up to date, "
+		<< numDeletedFiles << " outputs deleted";
+	if (result.numFailedFiles)
+		std::cout << ", " << result.numFailedFiles << " failed";
+	std::cout << ") in " << std::fixed << std::setprecision(2) << seconds << " seconds." << std::endl;
+	return true;
+}
+
+int RunSync(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats)
+{
+	SyncResult result;
+	if (!SyncDirectory(codecs, sourceDirectory, outputDirectory, printStats, result))
+		return 2;
+	return result.numFailedFiles ? 2 : 0;
+}
@@ -0,0 +1,93 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "Utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct FileCodec;
+
+// The manifest file consists of the header, followed by all file entries, all output entries and finally the string table containing the paths.
+// It is stored in the output directory and remembers which input files were converted into which output files.
+struct SyncManifestHeader
+{
+	static constexpr uint32_t CURRENT_VERSION = 1;
+
+	std::array<char, 4> magic = { 'J', 'D', 'S', 'Y' };
+	uint32le version = CURRENT_VERSION;
+	uint32le numFiles = 0;
+	uint32le numOutputs = 0;
+	uint32le stringTableSize = 0;
+
+	bool IsValid() const noexcept
+	{
+		static_assert(sizeof(SyncManifestHeader) == 20);
+
+		const SyncManifestHeader expected{};
+		return magic == expected.magic && version == expected.version;
+	}
+};
+
+struct SyncManifestFile
+{
+	uint64le modificationTime;
+	uint64le fileSize;
+	uint64le contentHash;  // FNV-1a hash of the whole input file
+	uint32le toolVersion;  // Version of JDTools that wrote the output files, 0 if the file has to be converted again
+	uint32le pathOffset;   // Offset into string table, path is relative to the source directory
+	uint32le pathLength;
+	uint32le targetsOffset;  // Offset into string table, comma-separated list of target formats, e.g. "bin,svz"
+	uint32le targetsLength;
+	uint32le firstOutput;
+	uint32le numOutputs;
+};
+
+struct SyncManifestOutput
+{
+	uint32le pathOffset;  // Offset into string table, path is relative to the output directory
+	uint32le pathLength;
+};
+
+struct SyncManifest
+{
+	std::vector<SyncManifestFile> files;
+	std::vector<SyncManifestOutput> outputs;
+	std::vector<char> strings;
+
+	std::string_view GetString(const uint32_t offset, const uint32_t length) const
+	{
+		return std::string_view{strings.data() + offset, length};
+	}
+	std::string_view GetPath(const SyncManifestFile &file) const { return GetString(file.pathOffset, file.pathLength); }
+	std::string_view GetTargets(const SyncManifestFile &file) const { return GetString(file.targetsOffset, file.targetsLength); }
+	std::string_view GetPath(const SyncManifestOutput &output) const { return GetString(output.pathOffset, output.pathLength); }
+	std::span<const SyncManifestOutput> GetOutputs(const SyncManifestFile &file) const
+	{
+		return std::span<const SyncManifestOutput>{outputs}.subspan(file.firstOutput, file.numOutputs);
+	}
+};
+
+bool ReadSyncManifest(std::istream &inFile, SyncManifest &manifest);
+void WriteSyncManifest(std::ostream &outFile, const SyncManifest &manifest);
+
+struct SyncResult
+{
+	std::vector<std::string> convertedFiles;  // Paths relative to the source directory
+	size_t numFailedFiles = 0;
+};
+
+// Converts all new and modified patch files in the source directory into the output directory, and deletes the output files of input files that have been removed.
+// Returns false if the directories or the manifest could not be accessed.
+bool SyncDirectory(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats, SyncResult &result);
+// Returns the process exit code.
+int RunSync(std::span<const FileCodec *const> codecs, const std::filesystem::path &sourceDirectory, const std::filesystem::path &outputDirectory, const bool printStats);
@@ -0,0 +1,32 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstdint>
+
+// Memory that has not been written by any SysEx message
+constexpr uint8_t UNDEFINED_MEMORY = 0xFE;
+
+// Base addresses of the JD-800 and JD-990 SysEx address maps
+constexpr uint32_t BASE_ADDR_800_PATCH_TEMPORARY = (0x00 << 14);
+constexpr uint32_t BASE_ADDR_800_SETUP_TEMPORARY = (0x01 << 14);
+constexpr uint32_t BASE_ADDR_800_SYSTEM = (0x02 << 14);
+constexpr uint32_t BASE_ADDR_800_PART = (0x03 << 14);
+constexpr uint32_t BASE_ADDR_800_SETUP_INTERNAL = (0x04 << 14);
+constexpr uint32_t BASE_ADDR_800_PATCH_INTERNAL = (0x05 << 14);
+constexpr uint32_t BASE_ADDR_800_DISPLAY = (0x07 << 14);
+
+constexpr uint32_t BASE_ADDR_990_SYSTEM = (0x00 << 21);
+constexpr uint32_t BASE_ADDR_990_PERFORMANCE_TEMPORARY = (0x01 << 21);
+constexpr uint32_t BASE_ADDR_990_PERFORMANCE_PATCHES_TEMPORARY = (0x02 << 21);
+constexpr uint32_t BASE_ADDR_990_PATCH_TEMPORARY = (0x03 << 21);
+constexpr uint32_t BASE_ADDR_990_SETUP_TEMPORARY = (0x04 << 21);
+constexpr uint32_t BASE_ADDR_990_PERFORMANCE_INTERNAL = (0x05 << 21);
+constexpr uint32_t BASE_ADDR_990_PATCH_INTERNAL = (0x06 << 21);
+constexpr uint32_t BASE_ADDR_990_SETUP_INTERNAL = (0x07 << 21);
+constexpr uint32_t BASE_ADDR_990_SYSTEM_CARD = (0x08 << 21);
+constexpr uint32_t BASE_ADDR_990_PERFORMANCE_CARD = (0x09 << 21);
+constexpr uint32_t BASE_ADDR_990_PATCH_CARD = (0x0A << 21);
+constexpr uint32_t BASE_ADDR_990_SETUP_CARD = (0x0B << 21);
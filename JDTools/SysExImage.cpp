@@ -0,0 +1,159 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "SysExImage.hpp"
+#include "InputFile.hpp"
+#include "PatchLibrary.hpp"
+#include "SysExAddresses.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr uint8_t SYSEX_DEVICE_ID = 0x10;
+}
+
+void SysExImage::Write(uint32_t address, const uint8_t *data, size_t size)
+{
+	while (size)
+	{
+		auto &page = m_pages[address / PAGE_SIZE];
+		if (page.empty())
+			page.assign(PAGE_SIZE, UNDEFINED_MEMORY);
+		const uint32_t offset = address % PAGE_SIZE;
+		const size_t amountToCopy = std::min(size, size_t(PAGE_SIZE - offset));
+		std::copy(data, data + amountToCopy, page.begin() + offset);
+		address += static_cast<uint32_t>(amountToCopy);
+		data += amountToCopy;
+		size -= amountToCopy;
+	}
+}
+
+const uint8_t *SysExImage::Get(const uint32_t address, const size_t size) const
+{
+	const auto page = m_pages.find(address / PAGE_SIZE);
+	const uint32_t offset = address % PAGE_SIZE;
+	if (page == m_pages.end() || offset + size > PAGE_SIZE || page->second[offset] == UNDEFINED_MEMORY)
+		return nullptr;
+	return page->second.data() + offset;
+}
+
+uint8_t SysExImage::Get(const uint32_t address) const
+{
+	const auto page = m_pages.find(address / PAGE_SIZE);
+	if (page == m_pages.end())
+		return UNDEFINED_MEMORY;
+	return page->second[address % PAGE_SIZE];
+}
+
+void SysExImage::Read(uint32_t address, uint8_t *data, size_t size) const
+{
+	while (size)
+	{
+		const auto page = m_pages.find(address / PAGE_SIZE);
+		const uint32_t offset = address % PAGE_SIZE;
+		const size_t amountToCopy = std::min(size, size_t(PAGE_SIZE - offset));
+		if (page != m_pages.end())
+			std::copy(page->second.begin() + offset, page->second.begin() + offset + amountToCopy, data);
+		else
+			std::fill(data, data + amountToCopy, UNDEFINED_MEMORY);
+		address += static_cast<uint32_t>(amountToCopy);
+		data += amountToCopy;
+		size -= amountToCopy;
+	}
+}
+
+std::vector<SysExImage::Range> SysExImage::GetRanges() const
+{
+	std::vector<Range> ranges;
+	for (const auto &[pageNumber, page] : m_pages)
+	{
+		const uint32_t pageAddress = pageNumber * PAGE_SIZE;
+		for (auto start = std::find_if(page.begin(), page.end(), [](const uint8_t b) { return b != UNDEFINED_MEMORY; }); start != page.end(); )
+		{
+			const auto end = std::find(start, page.end(), UNDEFINED_MEMORY);
+			const uint32_t address = pageAddress + static_cast<uint32_t>(start - page.begin());
+			// Ranges continue across page boundaries
+			if (!ranges.empty() && ranges.back().address + ranges.back().size == address)
+				ranges.back().size += static_cast<uint32_t>(end - start);
+			else
+				ranges.push_back({address, static_cast<uint32_t>(end - start)});
+			start = std::find_if(end, page.end(), [](const uint8_t b) { return b != UNDEFINED_MEMORY; });
+		}
+	}
+	return ranges;
+}
+
+bool LoadSysExDump(std::istream &inFile, SysExDump &dump)
+{
+	InputFile inputFile{inFile, std::cerr};
+	if (inputFile.GetType() != InputFile::Type::SYX && inputFile.GetType() != InputFile::Type::MID)
+		return false;
+
+	bool hasDeviceType = false;
+	std::vector<uint8_t> message;
+	while (!(message = inputFile.NextSysExMessage()).empty())
+	{
+		DataSetMessage dataSet;
+		if (!ParseDataSetMessage(message, dataSet) || (hasDeviceType && dump.isJD990 != dataSet.isJD990))
+			continue;
+		dump.isJD990 = dataSet.isJD990;
+		hasDeviceType = true;
+
+		const uint32_t temporaryAddress = dataSet.isJD990 ? BASE_ADDR_990_PATCH_TEMPORARY : BASE_ADDR_800_PATCH_TEMPORARY;
+		const uint32_t temporarySize = static_cast<uint32_t>(GetPatchSize(dataSet.isJD990 ? PatchFormat::JD990 : PatchFormat::JD800));
+		for (uint32_t i = 0; i < dataSet.data.size(); i++)
+		{
+			const uint32_t address = dataSet.address + i;
+			if (address < temporaryAddress || address >= temporaryAddress + temporarySize)
+				continue;
+			if (const uint8_t previous = dump.image.Get(address); previous != UNDEFINED_MEMORY && previous != dataSet.data[i])
+				dump.numOverwrittenTemporaryBytes++;
+		}
+
+		dump.image.Write(dataSet.address, dataSet.data.data(), dataSet.data.size());
+		dump.numMessages++;
+		dump.messages.push_back(0xF0);
+		dump.messages.insert(dump.messages.end(), message.begin(), message.end());
+	}
+	return hasDeviceType;
+}
+
+void WriteSysEx(std::ostream &f, uint32_t address, const bool isJD990, const uint8_t *data, size_t size)
+{
+	// debug stuff
+	for (size_t i = 0; i < size; i++)
+	{
+		if (data[i] >= 0x80)
+		{
+			std::cerr << "invalid byte in SysEx data block at " << i << " - either broken parameter conversion or broken SysEx source!" << std::endl;
+		}
+	}
+
+	std::vector<uint8_t> outMessage;
+	size_t offset = 0;
+	while (size)
+	{
+		const size_t amountToCopy = std::min(size, size_t(256));
+		if (isJD990)
+			outMessage.assign({ 0xF0, 0x41, SYSEX_DEVICE_ID, 0x57, 0x12, static_cast<uint8_t>((address >> 21) & 0x7F), static_cast<uint8_t>((address >> 14) & 0x7F), static_cast<uint8_t>((address >> 7) & 0x7F), static_cast<uint8_t>(address & 0x7F) });
+		else
+			outMessage.assign({ 0xF0, 0x41, SYSEX_DEVICE_ID, 0x3D, 0x12, static_cast<uint8_t>((address >> 14) & 0x7F), static_cast<uint8_t>((address >> 7) & 0x7F), static_cast<uint8_t>(address & 0x7F) });
+		outMessage.insert(outMessage.end(), data + offset, data + offset + amountToCopy);
+		uint8_t checksum = 0;
+		for (size_t i = 5; i < outMessage.size(); i++)
+		{
+			checksum += outMessage[i];
+		}
+		checksum = (~checksum + 1) & 0x7F;
+		outMessage.push_back(checksum);
+		outMessage.push_back(0xF7);
+		WriteVector(f, outMessage);
+
+		address += static_cast<uint32_t>(amountToCopy);
+		size -= amountToCopy;
+		offset += amountToCopy;
+	}
+}
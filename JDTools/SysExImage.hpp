@@ -0,0 +1,56 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+// Contents of the JD-800 or JD-990 SysEx address space, as written by Data Set messages.
+// Addresses are linear, i.e. the 7-bit address bytes are concatenated. Memory that was never written to reads as UNDEFINED_MEMORY.
+// Only the few pages of the address space that are actually written to are allocated.
+class SysExImage
+{
+public:
+	static constexpr uint32_t PAGE_SIZE = 0x10000;
+
+	// Contiguous memory that has been written to
+	struct Range
+	{
+		uint32_t address;
+		uint32_t size;
+	};
+
+	void Write(uint32_t address, const uint8_t *data, size_t size);
+
+	// Returns nullptr if the address was never written to or the data crosses a page boundary
+	const uint8_t *Get(const uint32_t address, const size_t size) const;
+	uint8_t Get(const uint32_t address) const;
+	void Read(uint32_t address, uint8_t *data, size_t size) const;
+
+	// All ranges in ascending address order
+	std::vector<Range> GetRanges() const;
+
+private:
+	std::map<uint32_t, std::vector<uint8_t>> m_pages;
+};
+
+// A SysEx dump (SYX or MID file) of a single device
+struct SysExDump
+{
+	SysExImage image;
+	bool isJD990 = false;
+	size_t numMessages = 0;         // Number of Data Set messages in the file
+	size_t numOverwrittenTemporaryBytes = 0;  // Bytes of the temporary patch that a later message changed again, e.g. because the file contains several temporary patches
+	std::vector<uint8_t> messages;  // These messages including F0 and F7, in the same order as in the file
+};
+
+// Only the first device type found in the file is read, like when converting the file.
+// Returns false if the file does not contain any JD-800 or JD-990 Data Set messages.
+bool LoadSysExDump(std::istream &inFile, SysExDump &dump);
+
+// Writes the data as Data Set messages with up to 256 bytes each
+void WriteSysEx(std::ostream &f, uint32_t address, const bool isJD990, const uint8_t *data, size_t size);
@@ -0,0 +1,229 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "SysExReceiver.hpp"
+#include "Codecs.hpp"
+#include "ConversionContext.hpp"
+#include "StandardStreams.hpp"
+#include "SysExAddresses.hpp"
+#include "Utils.hpp"
+
+#include "JD-800.hpp"
+#include "JD-990.hpp"
+#include "JD-08.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <span>
+
+namespace
+{
+	// Longer messages cannot be JD-800 / JD-990 Data Set messages, so there is no need to keep collecting them
+	constexpr size_t MAX_MESSAGE_SIZE = 0x1000;
+
+	// A consecutive range of patch slots in the SysEx address map
+	struct PatchRegion
+	{
+		uint32_t address;
+		uint32_t stride;
+		uint32_t count;
+		uint32_t firstSlot;
+	};
+
+	constexpr std::array<PatchRegion, 2> PATCH_REGIONS_800 =
+	{{
+		{ BASE_ADDR_800_PATCH_INTERNAL, sizeof(Patch800), 64, 0 },
+		{ BASE_ADDR_800_PATCH_TEMPORARY, sizeof(Patch800), 1, LIBRARY_SLOT_TEMPORARY },
+	}};
+
+	constexpr std::array<PatchRegion, 3> PATCH_REGIONS_990 =
+	{{
+		{ BASE_ADDR_990_PATCH_INTERNAL, 1 << 14, 64, 0 },
+		{ BASE_ADDR_990_PATCH_CARD, 1 << 14, 64, LIBRARY_SLOT_CARD },
+		{ BASE_ADDR_990_PATCH_TEMPORARY, 1 << 14, 1, LIBRARY_SLOT_TEMPORARY },
+	}};
+}
+
+SysExReceiver::SysExReceiver(PatchCallback callback)
+	: m_callback{std::move(callback)}
+{
+}
+
+void SysExReceiver::Feed(const uint8_t byte)
+{
+	if (byte == 0xF0)
+	{
+		m_inSysEx = true;
+		m_message.clear();
+	}
+	else if (byte >= 0xF8 || !m_inSysEx)
+	{
+		// Real-time messages may appear in the middle of a SysEx message, everything else outside of SysEx messages is of no interest
+	}
+	else if (byte == 0xF7)
+	{
+		m_inSysEx = false;
+		m_message.push_back(byte);
+		ProcessMessage(Clock::now());
+	}
+	else if ((byte & 0x80) || m_message.size() >= MAX_MESSAGE_SIZE)
+	{
+		// Any other status byte terminates the SysEx message prematurely
+		m_inSysEx = false;
+		m_numMessages++;
+		m_numIgnoredMessages++;
+	}
+	else
+	{
+		m_message.push_back(byte);
+	}
+}
+
+void SysExReceiver::ProcessMessage(const Clock::time_point received)
+{
+	m_numMessages++;
+	DataSetMessage dataSet;
+	if (!ParseDataSetMessage(m_message, dataSet) || (m_isJD990.has_value() && *m_isJD990 != dataSet.isJD990))
+	{
+		m_numIgnoredMessages++;
+		return;
+	}
+	// Only the first device type found in the stream is processed
+	m_isJD990 = dataSet.isJD990;
+
+	const PatchFormat format = dataSet.isJD990 ? PatchFormat::JD990 : PatchFormat::JD800;
+	const uint32_t patchSize = dataSet.isJD990 ? sizeof(Patch990) : sizeof(Patch800);
+	const std::span<const PatchRegion> regions = dataSet.isJD990 ? std::span<const PatchRegion>{PATCH_REGIONS_990} : std::span<const PatchRegion>{PATCH_REGIONS_800};
+	const uint32_t messageStart = dataSet.address;
+	const uint32_t messageEnd = dataSet.address + static_cast<uint32_t>(dataSet.data.size());
+	for (const PatchRegion &region : regions)
+	{
+		uint32_t patch = (messageStart > region.address) ? (messageStart - region.address) / region.stride : 0;
+		for (; patch < region.count; patch++)
+		{
+			const uint32_t patchStart = region.address + patch * region.stride;
+			if (patchStart >= messageEnd)
+				break;
+			const uint32_t start = std::max(messageStart, patchStart), end = std::min(messageEnd, patchStart + patchSize);
+			if (start < end)
+				WritePatchData(format, region.firstSlot + patch, start - patchStart, dataSet.data.data() + (start - messageStart), end - start, received);
+		}
+	}
+}
+
+void SysExReceiver::WritePatchData(const PatchFormat format, const uint32_t slot, const uint32_t offset, const uint8_t *data, const size_t size, const Clock::time_point received)
+{
+	const size_t patchSize = (format == PatchFormat::JD990) ? sizeof(Patch990) : sizeof(Patch800);
+	PendingPatch &pending = m_pending[slot];
+	if (pending.data.empty())
+	{
+		pending.data.resize(patchSize);
+		pending.received.resize(patchSize, false);
+	}
+
+	std::copy(data, data + size, pending.data.begin() + offset);
+	for (size_t i = offset; i < offset + size; i++)
+	{
+		if (!pending.received[i])
+		{
+			pending.received[i] = true;
+			pending.numReceived++;
+		}
+	}
+	if (pending.numReceived < patchSize)
+		return;
+
+	// If the same slot is sent again later, it is reported again
+	LibraryPatch patch;
+	patch.format = format;
+	patch.slot = slot;
+	patch.data = std::move(pending.data);
+	m_pending.erase(slot);
+	m_callback(patch, received);
+}
+
+int RunReceive(const FileCodec &codec, const std::string &inputFilename, const std::string &outputFilename)
+{
+	if (IsStandardStream(outputFilename))
+	{
+		std::cout << "The output bank is rewritten every time a patch is received, so it cannot be written to standard output!" << std::endl;
+		return 2;
+	}
+
+	std::ifstream inFile;
+	std::istream *input = &GetStandardInputStream();
+	if (!IsStandardStream(inputFilename))
+	{
+		// Opening a FIFO blocks until the other end is opened as well
+		inFile.open(inputFilename, std::ios::binary);
+		if (!inFile)
+		{
+			std::cout << "Could not open " << inputFilename << " for reading!" << std::endl;
+			return 2;
+		}
+		input = &inFile;
+	}
+
+	std::vector<PatchVST> bank(64);
+	std::unique_ptr<ConversionPlan> plan;
+	ConversionContext context{std::cerr};
+	uint32_t numPatches = 0;
+	std::chrono::duration<double, std::milli> totalLatency{}, maxLatency{};
+	bool writeFailed = false;
+
+	SysExReceiver receiver{[&](const LibraryPatch &patch, const SysExReceiver::Clock::time_point received)
+	{
+		const std::string slotName = GetLibrarySlotName(patch.format, patch.slot, 64);
+		if (patch.slot >= 64)
+		{
+			std::cout << "Received " << slotName << ": " << patch.GetName() << " (ignored, only internal patches are written to the bank)" << std::endl;
+			return;
+		}
+
+		if (!plan || plan->GetSource() != patch.format)
+			plan = std::make_unique<ConversionPlan>(patch.format, PatchFormat::VST);
+		plan->Convert(patch.data.data(), &bank[patch.slot], context);
+
+		// Write to a temporary file first so that other applications never see a partially written bank
+		const std::string tempFilename = outputFilename + ".tmp";
+		{
+			std::ofstream outFile{tempFilename, std::ios::trunc | std::ios::binary};
+			codec.writeBank(outFile, bank);
+			writeFailed = !outFile;
+		}
+		std::error_code ec;
+		if (!writeFailed)
+			std::filesystem::rename(tempFilename, outputFilename, ec);
+		if (writeFailed || ec)
+		{
+			writeFailed = true;
+			std::cout << "Could not write " << outputFilename << "!" << std::endl;
+			return;
+		}
+
+		const std::chrono::duration<double, std::milli> latency = SysExReceiver::Clock::now() - received;
+		numPatches++;
+		totalLatency += latency;
+		maxLatency = std::max(maxLatency, latency);
+		std::cout << "Received " << slotName << ": " << patch.GetName() << " (written after " << latency.count() << " ms)" << std::endl;
+	}};
+
+	std::cout << "Waiting for SysEx data..." << std::endl;
+	std::streambuf &buffer = *input->rdbuf();
+	for (auto c = buffer.sbumpc(); c != std::char_traits<char>::eof() && !writeFailed; c = buffer.sbumpc())
+	{
+		receiver.Feed(static_cast<uint8_t>(c));
+	}
+	if (writeFailed)
+		return 2;
+
+	std::cout << "Received " << numPatches << " patches in " << receiver.GetNumMessages() << " SysEx messages (" << receiver.GetNumIgnoredMessages() << " ignored)." << std::endl;
+	if (numPatches)
+		std::cout << "Time from last byte to written output: " << (totalLatency.count() / numPatches) << " ms on average, " << maxLatency.count() << " ms at most." << std::endl;
+	return 0;
+}
@@ -0,0 +1,57 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "PatchLibrary.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Parses a live stream of raw MIDI bytes, e.g. coming from a MIDI interface, and reports every patch as soon as all of its data has been received.
+// Patch data can be spread across any number of Data Set messages, in any order.
+class SysExReceiver
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	// Called with the completed patch (see LibraryPatch for slot numbering) and the time at which its last byte was received
+	using PatchCallback = std::function<void(const LibraryPatch &patch, Clock::time_point received)>;
+
+	explicit SysExReceiver(PatchCallback callback);
+
+	void Feed(const uint8_t byte);
+
+	uint32_t GetNumMessages() const { return m_numMessages; }
+	uint32_t GetNumIgnoredMessages() const { return m_numIgnoredMessages; }
+
+private:
+	// Address range of one patch slot and the parts of it that have been received so far
+	struct PendingPatch
+	{
+		std::vector<uint8_t> data;
+		std::vector<bool> received;
+		size_t numReceived = 0;
+	};
+
+	void ProcessMessage(const Clock::time_point received);
+	void WritePatchData(const PatchFormat format, const uint32_t slot, const uint32_t offset, const uint8_t *data, const size_t size, const Clock::time_point received);
+
+	PatchCallback m_callback;
+	std::vector<uint8_t> m_message;
+	bool m_inSysEx = false;
+	std::optional<bool> m_isJD990;
+	std::map<uint32_t, PendingPatch> m_pending;  // Indexed by slot
+	uint32_t m_numMessages = 0, m_numIgnoredMessages = 0;
+};
+
+struct FileCodec;
+
+// Reads MIDI data from the input (a file, FIFO or "-" for standard input) until it ends,
+// and rewrites the output bank each time a patch has been received. Returns the process exit code.
+int RunReceive(const FileCodec &codec, const std::string &inputFilename, const std::string &outputFilename);
@@ -0,0 +1,226 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#include "SysExTransfer.hpp"
+#include "InputArchive.hpp"
+#include "StandardStreams.hpp"
+#include "SysExAddresses.hpp"
+#include "SysExImage.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	// Data Set messages carry at most this many bytes of data
+	constexpr uint32_t MAX_MESSAGE_DATA = 256;
+
+	// Bytes of a Data Set message besides its data: F0, manufacturer, device ID, model ID, command, address, checksum and F7
+	constexpr size_t GetMessageOverhead(const bool isJD990) noexcept
+	{
+		return isJD990 ? 11 : 10;
+	}
+
+	// Cost of sending a range of data with as few messages as possible
+	double GetRangeCost(const uint32_t size, const bool isJD990, const SysExTiming &timing)
+	{
+		const size_t overhead = GetMessageOverhead(isJD990);
+		const uint32_t numFullMessages = size / MAX_MESSAGE_DATA, remainder = size % MAX_MESSAGE_DATA;
+		return numFullMessages * timing.GetMessageCost(MAX_MESSAGE_DATA + overhead) + (remainder ? timing.GetMessageCost(remainder + overhead) : 0.0);
+	}
+
+	uint32_t GetNumMessages(const uint32_t size)
+	{
+		return (size + MAX_MESSAGE_DATA - 1) / MAX_MESSAGE_DATA;
+	}
+
+	bool LoadDump(const std::string &filename, SysExDump &dump)
+	{
+		const std::vector<InputSource> sources = OpenInputSources(filename);
+		if (sources.empty())
+			return false;
+		if (sources.size() > 1)
+		{
+			std::cout << filename << " contains several files, please specify one of them as " << filename << ":<file>" << std::endl;
+			return false;
+		}
+		if (!LoadSysExDump(*sources.front().stream, dump))
+		{
+			std::cout << "No JD-800 or JD-990 SysEx data found in " << filename << "!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool WriteOutput(const std::string &outFilename, std::span<const uint8_t> sysExData, const SysExTiming &timing)
+	{
+		std::ofstream outFileStream;
+		std::ostream &outFile = IsStandardStream(outFilename) ? OpenStandardOutput() : outFileStream;
+		if (!IsStandardStream(outFilename))
+			outFileStream.open(outFilename, std::ios::trunc | std::ios::binary);
+
+		std::string extension = std::filesystem::path{outFilename}.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (extension == ".mid")
+			WriteMidiFile(outFile, sysExData, timing);
+		else
+			outFile.write(reinterpret_cast<const char *>(sysExData.data()), sysExData.size());
+
+		if (!outFile.flush())
+		{
+			std::cout << "Could not write " << outFilename << "!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	// Writes the given ranges of the image as Data Set messages and returns the number of messages
+	uint32_t WriteRanges(std::ostream &f, const SysExImage &image, std::span<const SysExImage::Range> ranges, const bool isJD990)
+	{
+		uint32_t numMessages = 0;
+		std::vector<uint8_t> data;
+		for (const SysExImage::Range &range : ranges)
+		{
+			data.resize(range.size);
+			image.Read(range.address, data.data(), range.size);
+			WriteSysEx(f, range.address, isJD990, data.data(), range.size);
+			numMessages += GetNumMessages(range.size);
+		}
+		return numMessages;
+	}
+
+	// e.g. "1 message" or "3 messages"
+	std::string FormatCount(const size_t count, const std::string_view noun)
+	{
+		std::string text = std::to_string(count) + " ";
+		text += noun;
+		if (count != 1)
+			text += 's';
+		return text;
+	}
+
+	void PrintTransferTimes(std::span<const uint8_t> sysExData, std::span<const uint8_t> originalData, const SysExTiming &timing)
+	{
+		std::cout << "Transferring the messages to the device takes " << (GetSysExTransferTime(sysExData, timing) / 1000.0) << " seconds instead of "
+			<< (GetSysExTransferTime(originalData, timing) / 1000.0) << " seconds." << std::endl;
+	}
+}
+
+int RunDelta(const std::string &currentFilename, const std::string &desiredFilename, const std::string &outFilename, const std::optional<SysExTiming> &timingOverride)
+{
+	// Messages must not end up in the output data if it is written to standard output
+	if (IsStandardStream(outFilename))
+		OpenStandardOutput();
+
+	SysExDump current, desired;
+	if (!LoadDump(currentFilename, current) || !LoadDump(desiredFilename, desired))
+		return 2;
+	if (current.isJD990 != desired.isJD990)
+	{
+		std::cout << currentFilename << " and " << desiredFilename << " contain SysEx data for different devices!" << std::endl;
+		return 2;
+	}
+
+	const bool isJD990 = desired.isJD990;
+	const SysExTiming timing = timingOverride.value_or(SysExTiming::ForDevice(isJD990 ? PatchFormat::JD990 : PatchFormat::JD800));
+
+	// Every byte that is defined in the desired dump but has a different or unknown value on the device has to be sent.
+	// Unchanged bytes between two changes are sent as well if that is faster than starting a new message, which costs not only
+	// the message header on the wire, but also the time the device needs to process every message.
+	// Changes are never joined across memory that is not part of the desired dump, since its contents on the device are not known.
+	std::vector<SysExImage::Range> changes;
+	uint32_t numChangedBytes = 0;
+	std::vector<uint8_t> desiredData, currentData;
+	for (const SysExImage::Range &range : desired.image.GetRanges())
+	{
+		desiredData.resize(range.size);
+		currentData.resize(range.size);
+		desired.image.Read(range.address, desiredData.data(), range.size);
+		current.image.Read(range.address, currentData.data(), range.size);
+
+		std::optional<SysExImage::Range> pending;
+		for (uint32_t offset = 0; offset < range.size; )
+		{
+			const auto changeStart = std::mismatch(desiredData.begin() + offset, desiredData.end(), currentData.begin() + offset).first;
+			if (changeStart == desiredData.end())
+				break;
+			const uint32_t start = static_cast<uint32_t>(changeStart - desiredData.begin());
+			uint32_t end = start + 1;
+			while (end < range.size && desiredData[end] != currentData[end])
+			{
+				end++;
+			}
+			numChangedBytes += end - start;
+			offset = end;
+
+			const SysExImage::Range change{range.address + start, end - start};
+			if (pending)
+			{
+				const uint32_t joinedSize = change.address + change.size - pending->address;
+				if (GetRangeCost(joinedSize, isJD990, timing) <= GetRangeCost(pending->size, isJD990, timing) + GetRangeCost(change.size, isJD990, timing))
+				{
+					pending->size = joinedSize;
+					continue;
+				}
+				changes.push_back(*pending);
+			}
+			pending = change;
+		}
+		if (pending)
+			changes.push_back(*pending);
+	}
+
+	std::ostringstream sysEx;
+	const uint32_t numMessages = WriteRanges(sysEx, desired.image, changes, isJD990);
+	const std::string sysExData = std::move(sysEx).str();
+	const std::span<const uint8_t> sysExSpan{reinterpret_cast<const uint8_t *>(sysExData.data()), sysExData.size()};
+	if (!WriteOutput(outFilename, sysExSpan, timing))
+		return 2;
+
+	std::cout << FormatCount(numChangedBytes, "byte") << ((numChangedBytes == 1) ? " differs" : " differ") << " from the current state, sending "
+		<< FormatCount(sysExData.size(), "byte") << " in " << FormatCount(numMessages, "message") << " instead of "
+		<< FormatCount(desired.messages.size(), "byte") << " in " << FormatCount(desired.numMessages, "message") << "." << std::endl;
+	PrintTransferTimes(sysExSpan, desired.messages, timing);
+	return 0;
+}
+
+int RunCompact(const std::string &inFilename, const std::string &outFilename, const std::optional<SysExTiming> &timingOverride)
+{
+	if (IsStandardStream(outFilename))
+		OpenStandardOutput();
+
+	SysExDump dump;
+	if (!LoadDump(inFilename, dump))
+		return 2;
+
+	const SysExTiming timing = timingOverride.value_or(SysExTiming::ForDevice(dump.isJD990 ? PatchFormat::JD990 : PatchFormat::JD800));
+
+	// The image already merged all messages into contiguous ranges, with later messages overwriting earlier ones.
+	// Unlike with the merge verb, several temporary patches in the input therefore end up as just the last of them.
+	if (dump.numOverwrittenTemporaryBytes)
+	{
+		std::cerr << "Warning: " << FormatCount(dump.numOverwrittenTemporaryBytes, "byte") << " of the temporary patch " << ((dump.numOverwrittenTemporaryBytes == 1) ? "is" : "are")
+			<< " sent several times with different values, only the last values are kept. If the input contains several temporary patches, use the merge verb to keep all of them." << std::endl;
+	}
+	std::ostringstream sysEx;
+	const std::vector<SysExImage::Range> ranges = dump.image.GetRanges();
+	const uint32_t numMessages = WriteRanges(sysEx, dump.image, ranges, dump.isJD990);
+	const std::string sysExData = std::move(sysEx).str();
+	const std::span<const uint8_t> sysExSpan{reinterpret_cast<const uint8_t *>(sysExData.data()), sysExData.size()};
+	if (!WriteOutput(outFilename, sysExSpan, timing))
+		return 2;
+
+	std::cout << "Compacted " << FormatCount(dump.numMessages, "message") << " (" << FormatCount(dump.messages.size(), "byte") << ") into " << FormatCount(numMessages, "message")
+		<< " (" << FormatCount(sysExData.size(), "byte") << ") in " << FormatCount(ranges.size(), "contiguous range") << "." << std::endl;
+	PrintTransferTimes(sysExSpan, dump.messages, timing);
+	return 0;
+}
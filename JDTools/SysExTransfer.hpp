@@ -0,0 +1,18 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "MidiFileWriter.hpp"
+
+#include <optional>
+#include <string>
+
+// Writes only the Data Set messages that are needed to turn a device whose memory contains the current dump into one that contains the desired dump.
+// The output is written as a Standard MIDI File if its extension is .mid. Returns the process exit code.
+int RunDelta(const std::string &currentFilename, const std::string &desiredFilename, const std::string &outFilename, const std::optional<SysExTiming> &timing);
+
+// Rewrites a SysEx dump with as few Data Set messages as possible, in ascending address order.
+// The output is written as a Standard MIDI File if its extension is .mid. Returns the process exit code.
+int RunCompact(const std::string &inFilename, const std::string &outFilename, const std::optional<SysExTiming> &timing);
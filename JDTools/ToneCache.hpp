@@ -0,0 +1,45 @@
+// JDTools - Patch conversion utility for Roland JD-800 / JD-990
+// 2022 - 2024 by Johannes Schultz
+// License: BSD 3-clause
+
+#pragma once
+
+#include "ConversionContext.hpp"
+#include "JD-800.hpp"
+#include "JD-08.hpp"
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Identical tones are very common (layered unison tones, blank tones, drum keys of special setups),
+// so the results of converting a tone are cached. Apart from the tone itself, they only depend on a few patch parameters.
+using ToneCacheKey = std::array<uint8_t, sizeof(Tone800) + 5>;
+
+struct ToneCacheEntry
+{
+	bool valid = false;
+	ToneCacheKey key;
+	ToneVST tone;
+	ToneVSTPrecomputed::Layer layer;
+	ToneVSTPrecomputed::Common common;
+	ToneVSTPrecomputed::PitchEnv pitchEnv;
+	ToneVSTPrecomputed::TVFEnv tvfEnv;
+	ToneVSTPrecomputed::TVAEnv tvaEnv;
+	ToneVSTPrecomputed::LFOs lfo;
+	std::string warnings;  // Reported again each time the entry is used
+	uint64_t numWarnings = 0;
+};
+
+// The cache is direct-mapped: every key can only be stored in one slot, and replaces whatever was stored there before.
+// This keeps lookups cheap and the memory used by each context's cache constant. A bank has at most 256 different tones.
+constexpr size_t TONE_CACHE_SIZE = 1024;
+
+struct ConversionContext::ToneCache
+{
+	std::vector<ToneCacheEntry> entries = std::vector<ToneCacheEntry>(TONE_CACHE_SIZE);
+	std::ostringstream warnings;  // Collects the warnings of the tone that is currently being converted
+	ToneCacheStats stats;
+};
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
 
 struct uint16le
@@ -46,6 +47,22 @@ struct uint32le
 	}
 };
 
+struct uint64le
+{
+	uint32le lo, hi;
+
+	constexpr uint64le(const uint64_t value = 0) noexcept
+		: lo{static_cast<uint32_t>(value)}
+		, hi{static_cast<uint32_t>(value >> 32)}
+	{
+	}
+
+	constexpr operator uint64_t() const noexcept
+	{
+		return uint64_t(lo) | (uint64_t(hi) << 32);
+	}
+};
+
 template<typename T>
 static bool Read(std::istream &f, T &value)
 {
@@ -76,7 +93,7 @@ static void WriteVector(std::ostream &f, const std::vector<T> &value)
 }
 
 template<typename T, size_t N>
-static T SafeTable(const T (&table)[N], uint8_t offset)
+static constexpr T SafeTable(const T (&table)[N], uint8_t offset)
 {
 	if (offset < N)
 		return table[offset];
@@ -102,3 +119,29 @@ void Reconstruct(T &x, Targs &&... args)
 	x.~T();
 	new (&x) T{ std::forward<Targs>(args)... };
 }
+
+inline std::string GetPatchIndex(const uint32_t patch, const uint32_t numPatches, const bool isCard = false)
+{
+	std::string patchIndex;
+	if (isCard)
+		patchIndex = 'C';
+	else if (numPatches <= 64)
+		patchIndex = 'I';
+	else
+		patchIndex = 'A' + static_cast<char>(patch / 64u);
+	patchIndex += '1' + ((patch / 8u) % 8u);
+	patchIndex += '1' + (patch % 8u);
+	return patchIndex;
+}
+
+// 64-bit FNV-1a hash
+inline uint64_t HashFNV1a(const void *data, const size_t size, uint64_t hash = 0xCBF29CE484222325ull)
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}